@@ -18,10 +18,10 @@ LUT预览生成器模块
 import os
 import time
 from pathlib import Path
-from typing import Optional, Tuple
+from typing import Dict, List, Optional, Tuple
 import numpy as np
 from PySide6.QtGui import QPixmap, QImage
-from PySide6.QtCore import Qt
+from PySide6.QtCore import Qt, QRect
 
 # 导入日志模块
 from freeassetfilter.utils.app_logger import debug, warning, error
@@ -33,9 +33,13 @@ except ImportError:
     PIL_AVAILABLE = False
     warning("PIL/Pillow未安装，LUT预览功能将受限")
 
-from freeassetfilter.utils.lut_utils import CubeLUTParser, get_lut_preview_dir
+from freeassetfilter.utils.lut_utils import CubeLUTParser, get_lut_preview_dir, get_lut_preview_path, enable_lut_binary_cache, enable_lut_preview_cache
 
-from freeassetfilter.core.native.src.cpp_lut_preview import warmup as cpp_warmup, generate_preview as cpp_generate_preview, is_cpp_available as _cpp_available
+from freeassetfilter.core.native.src.cpp_lut_preview import warmup as cpp_warmup, generate_preview as cpp_generate_preview, generate_preview_pixels as cpp_generate_preview_pixels, generate_previews_batch as cpp_generate_previews_batch, generate_preview_atlas as cpp_generate_preview_atlas, generate_preview_scopes as cpp_generate_preview_scopes, generate_preview_cached as cpp_generate_preview_cached, lookup_preview as cpp_lookup_preview, image_content_key as cpp_image_content_key, clear_preview_cache as cpp_clear_preview_cache, load_lut as cpp_load_lut, create_preview_session as cpp_create_preview_session, generate_preview_mips as cpp_generate_preview_mips, submit_preview as cpp_submit_preview, PRIORITY_VISIBLE, PRIORITY_PREFETCH, is_cpp_available as _cpp_available, has_cpp_api
+
+# 预览缓存依赖的原生接口；仓库中预编译的旧版模块缺少这些接口时，预览图按 LUT id 保存为 PNG 文件
+_NATIVE_CACHE_API = ("load_lut", "generate_preview_cached", "lookup_preview", "generate_previews_batch",
+                     "image_content_key")
 
 
 class LUTPreviewGenerator:
@@ -58,7 +62,13 @@ class LUTPreviewGenerator:
         
         self.reference_image_path = str(reference_image_path)
         self._reference_image = None
-        self._reference_image_scaled = {}
+        self._reference_array = None
+        self._reference_key = 0
+
+        # 加载 LUT 时优先内存映射二进制缓存，避免每次解析 .cube 文本
+        enable_lut_binary_cache()
+        # 预览按 LUT 内容、参考图像、尺寸与插值方式缓存在 C++ 端（内存 + 预览图目录）
+        enable_lut_preview_cache()
     
     def preload(self):
         """预加载参考图像和相关资源"""
@@ -66,11 +76,9 @@ class LUTPreviewGenerator:
         debug("预加载参考图像")
         self.load_reference_image()
         if self._reference_image is not None:
-            for size in [(256, 256), (512, 512)]:
-                self._reference_image_scaled[size] = np.array(
-                    self._reference_image.resize(size, Image.Resampling.LANCZOS)
-                )
-            debug(f"参考图像预缩放完成，尺寸: {list(self._reference_image_scaled.keys())}")
+            # 缩放由 C++ 端完成，这里只保留一份全分辨率像素
+            self._reference_array = np.asarray(self._reference_image)
+            debug(f"参考图像预加载完成，尺寸: {self._reference_image.size}")
     
     def load_reference_image(self) -> bool:
         """
@@ -92,6 +100,8 @@ class LUTPreviewGenerator:
                         self._reference_image = _ref_img.convert('RGB')
                     else:
                         self._reference_image = _ref_img
+                self._reference_array = None
+                self._reference_key = 0
             return True
         except (IOError, OSError) as e:
             error(f"加载参考图像失败: {e}")
@@ -100,16 +110,29 @@ class LUTPreviewGenerator:
             error(f"加载参考图像失败: {e}")
             return False
     
+    def _reference_pixels(self):
+        """返回全分辨率参考图像的 numpy 数组（首次调用时转换并缓存）"""
+        if self._reference_array is None:
+            self._reference_array = np.asarray(self._reference_image)
+        return self._reference_array
+
+    def _reference_cache_key(self) -> int:
+        """返回参考图像的预览缓存键（首次调用时计算并缓存），查缓存时不必每次哈希全部像素"""
+        if not self._reference_key:
+            self._reference_key = cpp_image_content_key(self._reference_pixels())
+        return self._reference_key
+
     def generate_preview(self, lut_file_path: str,
-                        output_size: Tuple[int, int] = (256, 256),
-                        cache_path: Optional[str] = None) -> Optional[QPixmap]:
+                        output_size: Tuple[int, int] = (256, 256)) -> Optional[QPixmap]:
         """
         生成LUT预览图
 
+        C++ 可用时结果经过原生预览缓存：LUT 内容、参考图像、尺寸或插值方式任一变化都会重新生成，
+        命中时直接从内存或磁盘取出像素。
+
         Args:
             lut_file_path: LUT文件路径
             output_size: 输出图像尺寸 (宽, 高)
-            cache_path: 缓存文件路径，如提供则保存到该路径
 
         Returns:
             Optional[QPixmap]: 预览图像，失败返回None
@@ -118,23 +141,112 @@ class LUTPreviewGenerator:
             warning("PIL不可用，无法生成LUT预览")
             return None
         
-        # 检查缓存
-        if cache_path and os.path.exists(cache_path):
-            pixmap = QPixmap(cache_path)
-            if not pixmap.isNull():
-                return pixmap.scaled(output_size[0], output_size[1], 
-                                   Qt.KeepAspectRatio, Qt.SmoothTransformation)
-        
         # 优先使用 C++ 实现
-        if _cpp_available():
-            return self._generate_preview_cpp(lut_file_path, output_size, cache_path)
+        if has_cpp_api(*_NATIVE_CACHE_API):
+            return self._generate_preview_cpp(lut_file_path, output_size)
         
-        # 回退到 Python 实现
-        return self._generate_preview_python(lut_file_path, output_size, cache_path)
+        # 原生预览缓存不可用：读取或生成按 LUT id 保存的预览图文件
+        cache_path = get_lut_preview_path(lut_file_path)
+        pixmap = self._load_preview_file(cache_path, output_size)
+        if pixmap is not None:
+            return pixmap
+        if self._render_preview_file(lut_file_path, output_size, cache_path):
+            return self._load_preview_file(cache_path, output_size)
+        return None
     
+    @staticmethod
+    def _load_preview_file(cache_path: str, output_size: Tuple[int, int]) -> Optional[QPixmap]:
+        """读取按 LUT id 保存的预览图文件，不存在或无法读取时返回None"""
+        if not os.path.exists(cache_path):
+            return None
+        pixmap = QPixmap(cache_path)
+        if pixmap.isNull():
+            return None
+        return pixmap.scaled(output_size[0], output_size[1],
+                             Qt.KeepAspectRatio, Qt.SmoothTransformation)
+
+    def _render_preview_file(self, lut_file_path: str, output_size: Tuple[int, int],
+                             cache_path: str) -> bool:
+        """
+        生成预览并保存为预览图文件（原生预览缓存不可用时使用）
+
+        旧版 C++ 模块只接受预先缩放好的图像并返回 PNG 数据，失败时回退 Python 实现；
+        不创建 QPixmap，可在工作线程中调用。
+        """
+        if not PIL_AVAILABLE:
+            return False
+        if self._reference_image is None and not self.load_reference_image():
+            return False
+
+        png_data = None
+        if _cpp_available():
+            try:
+                with open(lut_file_path, 'r', encoding='utf-8') as f:
+                    lut_content = f.read()
+                scaled = np.asarray(self._reference_image.resize(output_size, Image.Resampling.LANCZOS))
+                png_data = cpp_generate_preview(lut_content, scaled, output_size[0], output_size[1])
+            except Exception as e:
+                warning(f"C++预览生成失败，回退Python: {e}")
+
+        temp_path = f"{cache_path}.{os.getpid()}.tmp"
+        try:
+            if png_data is not None:
+                with open(temp_path, 'wb') as f:
+                    f.write(png_data)
+            else:
+                preview_image = self._render_preview_python(lut_file_path, output_size)
+                if preview_image is None:
+                    return False
+                preview_image.save(temp_path, 'PNG')
+            os.replace(temp_path, cache_path)
+            return True
+        except (IOError, OSError) as e:
+            warning(f"保存LUT预览图失败: {e}")
+            try:
+                os.remove(temp_path)
+            except OSError:
+                pass
+            return False
+    
+    def cached_preview(self, lut_file_path: str,
+                       output_size: Tuple[int, int] = (256, 256)) -> Optional[QPixmap]:
+        """
+        只从预览缓存取LUT预览图，不生成
+
+        Args:
+            lut_file_path: LUT文件路径
+            output_size: 输出图像尺寸 (宽, 高)
+
+        Returns:
+            Optional[QPixmap]: 预览图像，未缓存时返回None
+        """
+        if not has_cpp_api(*_NATIVE_CACHE_API):
+            return self._load_preview_file(get_lut_preview_path(lut_file_path), output_size)
+        if not PIL_AVAILABLE:
+            return None
+        try:
+            if self._reference_image is None and not self.load_reference_image():
+                return None
+            pixels = cpp_lookup_preview(
+                lut_file_path,
+                self._reference_pixels(),
+                output_size[0],
+                output_size[1],
+                interpolation="tetrahedral",
+                resample="lanczos3",
+                image_key=self._reference_cache_key()
+            )
+        except Exception as e:
+            debug(f"查询LUT预览缓存失败: {e}")
+            return None
+        if pixels is None:
+            return None
+        height, width = pixels.shape[:2]
+        qimage = QImage(pixels.data, width, height, pixels.strides[0], QImage.Format_RGB888)
+        return QPixmap.fromImage(qimage)
+
     def _generate_preview_cpp(self, lut_file_path: str,
-                             output_size: Tuple[int, int],
-                             cache_path: Optional[str]) -> Optional[QPixmap]:
+                             output_size: Tuple[int, int]) -> Optional[QPixmap]:
         """使用 C++ 实现生成预览"""
         # _t0 = time.perf_counter()
 
@@ -148,42 +260,35 @@ class LUTPreviewGenerator:
                 # _t2 = time.perf_counter()
                 # debug(f"[LUT生成] {(_t2-_t1)*1000:.1f}ms - 参考图像加载完成")
 
-            # 使用预缩放的图像缓存
-            size_key = output_size
-            if size_key not in self._reference_image_scaled:
-                # _t1 = time.perf_counter()
-                # debug(f"[LUT生成] {(_t1-_t0)*1000:.1f}ms - 创建缩放缓存 {size_key}")
-                self._reference_image_scaled[size_key] = np.array(
-                    self._reference_image.resize(size_key, Image.Resampling.LANCZOS)
-                )
-            img_array = self._reference_image_scaled[size_key]
+            # 全分辨率参考像素，缩放在 C++ 端与 LUT 应用一起分块完成
+            img_array = self._reference_pixels()
             # _t1 = time.perf_counter()
             # debug(f"[LUT生成] {(_t1-_t0)*1000:.1f}ms - 图像准备完成")
 
-            # 读取 LUT 文件内容（解决中文路径问题）
-            with open(lut_file_path, 'r', encoding='utf-8') as f:
-                lut_content = f.read()
+            # 加载 LUT（C++ 端按路径+修改时间+大小缓存解析结果，中文路径按 UTF-8 处理）
+            lut = cpp_load_lut(lut_file_path)
             # _t2 = time.perf_counter()
-            # debug(f"[LUT生成] {(_t2-_t0)*1000:.1f}ms - LUT文件读取完成，大小={len(lut_content)}")
+            # debug(f"[LUT生成] {(_t2-_t0)*1000:.1f}ms - LUT加载完成，{lut}")
 
-            # 调用 C++ 模块生成预览
-            png_data = cpp_generate_preview(
-                lut_content,
+            # 调用 C++ 模块生成预览像素（跳过 PNG 编码/解码往返），命中预览缓存时不再生成
+            # 使用四面体插值，与调色软件和 mpv 播放时的 LUT 效果一致
+            pixels = cpp_generate_preview_cached(
+                lut,
                 img_array,
                 output_size[0],
-                output_size[1]
+                output_size[1],
+                interpolation="tetrahedral",
+                resample="lanczos3",
+                image_key=self._reference_cache_key()
             )
             # _t3 = time.perf_counter()
-            # debug(f"[LUT生成] {(_t3-_t0)*1000:.1f}ms - C++ 处理完成，PNG大小={len(png_data)}")
+            # debug(f"[LUT生成] {(_t3-_t0)*1000:.1f}ms - C++ 处理完成，像素={pixels.shape}")
 
-            # 将 PNG 数据转换为 QPixmap
-            qimage = QImage.fromData(png_data)
+            # 直接由像素构造 QImage，fromImage 会复制数据，pixels 只需在此期间存活
+            height, width = pixels.shape[:2]
+            qimage = QImage(pixels.data, width, height, pixels.strides[0], QImage.Format_RGB888)
             pixmap = QPixmap.fromImage(qimage)
 
-            # 保存缓存
-            if cache_path and not pixmap.isNull():
-                pixmap.save(cache_path, 'PNG')
-
             # _t4 = time.perf_counter()
             # debug(f"[LUT生成] {(_t4-_t0)*1000:.1f}ms - 全部完成")
 
@@ -191,18 +296,312 @@ class LUTPreviewGenerator:
 
         except (IOError, OSError) as e:
             warning(f"C++预览生成失败，回退Python: {e}")
-            return self._generate_preview_python(lut_file_path, output_size, cache_path)
+            return self._generate_preview_python(lut_file_path, output_size)
         except ValueError as e:
             warning(f"C++预览生成失败，回退Python: {e}")
-            return self._generate_preview_python(lut_file_path, output_size, cache_path)
+            return self._generate_preview_python(lut_file_path, output_size)
         except Exception as e:
             warning(f"C++预览生成失败，回退Python: {e}")
-            return self._generate_preview_python(lut_file_path, output_size, cache_path)
+            return self._generate_preview_python(lut_file_path, output_size)
     
+    def generate_previews(self, lut_file_paths: List[str],
+                          output_size: Tuple[int, int] = (256, 256)) -> List[bool]:
+        """
+        批量生成LUT预览图并写入预览缓存
+
+        已缓存的 LUT 直接跳过，其余 LUT 共用一次参考图像缩放，在一次调用中并行处理。
+        不创建 QPixmap，可在工作线程中调用。原生预览缓存不可用时逐个生成按 LUT id 保存的预览图文件。
+
+        Args:
+            lut_file_paths: LUT文件路径列表
+            output_size: 输出图像尺寸 (宽, 高)
+
+        Returns:
+            List[bool]: 每个LUT的预览是否已在缓存中
+        """
+        if not lut_file_paths:
+            return []
+
+        if not has_cpp_api(*_NATIVE_CACHE_API):
+            results = []
+            for lut_file_path in lut_file_paths:
+                cache_path = get_lut_preview_path(lut_file_path)
+                results.append(os.path.exists(cache_path)
+                               or self._render_preview_file(lut_file_path, output_size, cache_path))
+            return results
+
+        if PIL_AVAILABLE:
+            try:
+                if self._reference_image is None and not self.load_reference_image():
+                    return [False] * len(lut_file_paths)
+                img_array = self._reference_pixels()
+
+                previews = cpp_generate_previews_batch(
+                    lut_file_paths,
+                    img_array,
+                    output_size[0],
+                    output_size[1],
+                    interpolation="tetrahedral",
+                    resample="lanczos3",
+                    use_cache=True,
+                    image_key=self._reference_cache_key()
+                )
+
+                results = []
+                for lut_file_path, pixels in zip(lut_file_paths, previews):
+                    if pixels is None:
+                        warning(f"LUT文件解析失败: {lut_file_path}")
+                    results.append(pixels is not None)
+                return results
+            except Exception as e:
+                # 不在此回退逐个生成：调用方多在工作线程中，且生成的 QPixmap 不会进入预览缓存
+                warning(f"C++批量预览生成失败: {e}")
+                return [False] * len(lut_file_paths)
+
+        return [False] * len(lut_file_paths)
+
+    def generate_preview_atlas(self, lut_file_paths: List[str],
+                               output_size: Tuple[int, int] = (256, 256),
+                               columns: int = 0,
+                               spacing: int = 0) -> Tuple[Optional[QPixmap], List[Optional[QRect]]]:
+        """
+        为一页LUT生成预览图集
+
+        所有预览在一次原生调用中写入同一张图像，界面从同一个 QPixmap 按矩形绘制各卡片；
+        整张图集作为一个预览缓存条目，任一LUT变化时整页重新生成。
+
+        Args:
+            lut_file_paths: LUT文件路径列表
+            output_size: 每个预览的尺寸 (宽, 高)
+            columns: 图集列数，<= 0 时排成接近正方形
+            spacing: 预览之间的间距（像素）
+
+        Returns:
+            Tuple[Optional[QPixmap], List[Optional[QRect]]]: 图集与各LUT在图集中的矩形，
+                解析失败的LUT对应None；C++ 模块不可用或失败时图集为None
+        """
+        if not _cpp_available() or not lut_file_paths:
+            return None, [None] * len(lut_file_paths)
+        try:
+            if self._reference_image is None and not self.load_reference_image():
+                return None, [None] * len(lut_file_paths)
+            pixels, rects = cpp_generate_preview_atlas(
+                lut_file_paths,
+                self._reference_pixels(),
+                output_size[0],
+                output_size[1],
+                columns=columns,
+                spacing=spacing,
+                interpolation="tetrahedral",
+                resample="lanczos3",
+                use_cache=True,
+                image_key=self._reference_cache_key()
+            )
+            height, width = pixels.shape[:2]
+            qimage = QImage(pixels.data, width, height, pixels.strides[0], QImage.Format_RGB888)
+            return QPixmap.fromImage(qimage), [QRect(*rect) if rect else None for rect in rects]
+        except Exception as e:
+            warning(f"生成LUT预览图集失败: {e}")
+            return None, [None] * len(lut_file_paths)
+
+    def generate_preview_scopes(self, lut_file_path: str,
+                                output_size: Tuple[int, int] = (256, 256),
+                                scope_width: int = 256,
+                                vectorscope_size: int = 128) -> Tuple[Optional[QPixmap], Optional[Dict[str, Dict[str, np.ndarray]]]]:
+        """
+        生成LUT预览，并返回应用前后的直方图、波形、分量波形与矢量示波器
+
+        示波器在 C++ 端与LUT应用同一轮完成，选中LUT时无需再用numpy统计；
+        结果是小尺寸的 uint32 计数数组，可直接交给示波器控件绘制。
+
+        Args:
+            lut_file_path: LUT文件路径
+            output_size: 预览尺寸 (宽, 高)
+            scope_width: 波形列数
+            vectorscope_size: 矢量示波器边长
+
+        Returns:
+            Tuple[Optional[QPixmap], Optional[Dict]]: 预览图与 {"source": ..., "graded": ...}，
+                C++ 模块不可用或失败时均为None
+        """
+        if not _cpp_available():
+            return None, None
+        try:
+            if self._reference_image is None and not self.load_reference_image():
+                return None, None
+            pixels, scopes = cpp_generate_preview_scopes(
+                lut_file_path,
+                self._reference_pixels(),
+                output_size[0],
+                output_size[1],
+                interpolation="tetrahedral",
+                resample="lanczos3",
+                scope_width=scope_width,
+                vectorscope_size=vectorscope_size
+            )
+            height, width = pixels.shape[:2]
+            qimage = QImage(pixels.data, width, height, pixels.strides[0], QImage.Format_RGB888)
+            return QPixmap.fromImage(qimage), scopes
+        except Exception as e:
+            warning(f"生成LUT示波器失败: {e}")
+            return None, None
+
+    def generate_preview_scales(self, lut_file_path: str,
+                                output_size: Tuple[int, int] = (256, 256),
+                                scales: Tuple[int, ...] = (1, 2, 3)) -> Dict[int, QPixmap]:
+        """
+        一次生成多个DPI缩放比例的LUT预览
+
+        LUT 只在最大比例上应用一次，较小比例由 C++ 端的 mip 链缩小得到，切换显示器或缩放时无需重新生成。
+
+        Args:
+            lut_file_path: LUT文件路径
+            output_size: 1x 时的输出尺寸 (宽, 高)
+            scales: 缩放比例列表
+
+        Returns:
+            Dict[int, QPixmap]: 缩放比例到预览图像的映射，失败时为空
+        """
+        if not _cpp_available() or not scales:
+            return {}
+        try:
+            if self._reference_image is None and not self.load_reference_image():
+                return {}
+            sizes = [(output_size[0] * scale, output_size[1] * scale) for scale in scales]
+            levels = cpp_generate_preview_mips(
+                cpp_load_lut(lut_file_path),
+                self._reference_pixels(),
+                sizes,
+                interpolation="tetrahedral",
+                resample="lanczos3"
+            )
+            pixmaps = {}
+            for scale, pixels in zip(scales, levels):
+                height, width = pixels.shape[:2]
+                qimage = QImage(pixels.data, width, height, pixels.strides[0], QImage.Format_RGB888)
+                pixmap = QPixmap.fromImage(qimage)
+                pixmap.setDevicePixelRatio(scale)
+                pixmaps[scale] = pixmap
+            return pixmaps
+        except Exception as e:
+            warning(f"生成多DPI LUT预览失败: {e}")
+            return {}
+
+    def create_strength_preview(self, lut_file_path: str,
+                                output_size: Tuple[int, int] = (256, 256)) -> Optional["LutStrengthPreview"]:
+        """
+        创建可调节强度的LUT预览
+
+        Args:
+            lut_file_path: LUT文件路径
+            output_size: 输出图像尺寸 (宽, 高)
+
+        Returns:
+            Optional[LutStrengthPreview]: 强度预览，C++ 模块不可用或失败时返回 None
+        """
+        if not _cpp_available():
+            return None
+        try:
+            if self._reference_image is None and not self.load_reference_image():
+                return None
+            session = cpp_create_preview_session(
+                cpp_load_lut(lut_file_path),
+                self._reference_pixels(),
+                output_size[0],
+                output_size[1],
+                interpolation="tetrahedral",
+                resample="lanczos3"
+            )
+            return LutStrengthPreview(session)
+        except Exception as e:
+            warning(f"创建LUT强度预览失败: {e}")
+            return None
+
+    def submit_preview(self, lut_file_path: str,
+                       output_size: Tuple[int, int] = (256, 256),
+                       visible: bool = True,
+                       progressive: bool = False):
+        """
+        异步提交LUT预览生成任务
+
+        可见卡片以高优先级排在预取任务之前；卡片滚出视野时应对返回的任务调用 cancel()
+        或把 priority 降为 PRIORITY_PREFETCH。结果由 preview_task_pixmap 转换为 QPixmap。
+        progressive 时先生成 1/4 分辨率的草稿，大尺寸预览在正式结果完成前即可显示。
+
+        Args:
+            lut_file_path: LUT文件路径
+            output_size: 输出图像尺寸 (宽, 高)
+            visible: 是否为当前可见的卡片
+            progressive: 是否先生成低分辨率草稿
+
+        Returns:
+            PreviewTask 句柄，C++ 模块不可用或提交失败时返回 None
+        """
+        if not _cpp_available():
+            return None
+        try:
+            if self._reference_image is None and not self.load_reference_image():
+                return None
+            return cpp_submit_preview(
+                lut_file_path,
+                self._reference_pixels(),
+                output_size[0],
+                output_size[1],
+                interpolation="tetrahedral",
+                resample="lanczos3",
+                priority=PRIORITY_VISIBLE if visible else PRIORITY_PREFETCH,
+                progressive=progressive
+            )
+        except Exception as e:
+            warning(f"提交LUT预览任务失败: {e}")
+            return None
+
+    @staticmethod
+    def preview_task_pixmap(task, timeout_ms: float = 0.0, draft: bool = False,
+                            output_size: Optional[Tuple[int, int]] = None) -> Optional[QPixmap]:
+        """
+        取出异步预览任务的结果
+
+        Args:
+            task: submit_preview 返回的任务句柄
+            timeout_ms: 最长等待时间（毫秒），0 表示只检查不等待，负数表示一直等待
+            draft: 正式结果未完成时是否返回草稿（task.done() 为 False 时即为草稿）
+            output_size: 提供时草稿按最近邻放大到该尺寸
+
+        Returns:
+            Optional[QPixmap]: 预览图像，任务未完成、被取消或失败时返回 None
+        """
+        try:
+            pixels = task.result(timeout_ms, draft=draft)
+        except Exception as e:
+            debug(f"LUT预览任务未完成: {e}")
+            return None
+        if pixels is None:
+            return None
+        height, width = pixels.shape[:2]
+        qimage = QImage(pixels.data, width, height, pixels.strides[0], QImage.Format_RGB888)
+        pixmap = QPixmap.fromImage(qimage)
+        if output_size and (width, height) != tuple(output_size):
+            pixmap = pixmap.scaled(output_size[0], output_size[1], Qt.IgnoreAspectRatio, Qt.FastTransformation)
+        return pixmap
+
     def _generate_preview_python(self, lut_file_path: str,
                                 output_size: Tuple[int, int],
-                                cache_path: Optional[str]) -> Optional[QPixmap]:
-        """使用 Python 实现生成预览"""
+                                cache_path: Optional[str] = None) -> Optional[QPixmap]:
+        """使用 Python 实现生成预览，提供 cache_path 时同时保存为预览图文件"""
+        preview_image = self._render_preview_python(lut_file_path, output_size)
+        if preview_image is None:
+            return None
+        if cache_path:
+            try:
+                preview_image.save(cache_path, 'PNG')
+            except (IOError, OSError) as e:
+                warning(f"保存LUT预览图失败: {e}")
+        return self._pil_image_to_qpixmap(preview_image)
+
+    def _render_preview_python(self, lut_file_path: str,
+                               output_size: Tuple[int, int]):
+        """使用 Python 实现生成预览，返回 PIL 图像（不创建 QPixmap，可在工作线程中调用）"""
         debug("使用Python生成LUT预览")
 
         # 加载参考图像
@@ -231,14 +630,7 @@ class LUTPreviewGenerator:
             
             # 转换回 PIL，确保像素值合法
             result = np.clip(result, 0.0, 1.0)
-            preview_image = Image.fromarray((result * 255).astype(np.uint8), mode="RGB")
-            
-            # 保存缓存
-            if cache_path:
-                preview_image.save(cache_path, 'PNG')
-            
-            # 转换为QPixmap
-            return self._pil_image_to_qpixmap(preview_image)
+            return Image.fromarray((result * 255).astype(np.uint8), mode="RGB")
             
         except (IOError, OSError) as e:
             error(f"生成LUT预览失败: {e}")
@@ -383,51 +775,52 @@ class LUTPreviewGenerator:
         # 转换为QPixmap
         return QPixmap.fromImage(qimage)
     
-    def get_preview_path(self, lut_id: str) -> str:
+    def clear_cache(self):
+        """清除预览缓存（C++ 端内存与磁盘条目，以及旧版按 LUT id 保存的预览图）"""
+        if _cpp_available():
+            try:
+                cpp_clear_preview_cache(disk=True)
+            except Exception as e:
+                error(f"清除预览缓存失败: {e}")
+
+        try:
+            for file in Path(get_lut_preview_dir()).glob("*_preview.png"):
+                file.unlink()
+        except (IOError, OSError) as e:
+            error(f"清除所有缓存失败: {e}")
+        except Exception as e:
+            error(f"清除所有缓存失败: {e}")
+
+
+class LutStrengthPreview:
+    """
+    LUT强度预览
+    缩放后的参考图与完整效果帧常驻 C++ 端，拖动强度滑块时只做一次两帧混合
+    """
+
+    def __init__(self, session):
+        self._session = session
+        self._buffer = None
+
+    def set_lut(self, lut_file_path: str):
+        """换用另一个LUT（参考图不重新缩放）"""
+        self._session.set_lut(cpp_load_lut(lut_file_path))
+
+    def pixmap(self, strength: float) -> QPixmap:
         """
-        获取预览图缓存路径
-        
+        生成指定强度的预览
+
         Args:
-            lut_id: LUT唯一标识
-            
+            strength: LUT强度，0.0 为原图，1.0 为完整效果
+
         Returns:
-            str: 预览图路径
-        """
-        preview_dir = get_lut_preview_dir()
-        return os.path.join(preview_dir, f"{lut_id}_preview.png")
-    
-    def clear_cache(self, lut_id: Optional[str] = None):
+            QPixmap: 预览图像
         """
-        清除预览图缓存
-        
-        Args:
-            lut_id: LUT唯一标识，如不提供则清除所有缓存
-        """
-        preview_dir = get_lut_preview_dir()
-        
-        if lut_id:
-            # 清除指定LUT的缓存
-            cache_path = self.get_preview_path(lut_id)
-            if os.path.exists(cache_path):
-                try:
-                    os.remove(cache_path)
-                except (IOError, OSError) as e:
-                    error(f"清除缓存失败: {e}")
-                except PermissionError as e:
-                    error(f"清除缓存失败: {e}")
-                except Exception as e:
-                    error(f"清除缓存失败: {e}")
-        else:
-            # 清除所有缓存
-            try:
-                for file in Path(preview_dir).glob("*_preview.png"):
-                    file.unlink()
-            except (IOError, OSError) as e:
-                error(f"清除所有缓存失败: {e}")
-            except PermissionError as e:
-                error(f"清除所有缓存失败: {e}")
-            except Exception as e:
-                error(f"清除所有缓存失败: {e}")
+        # 复用同一块像素缓冲，fromImage 会复制数据
+        self._buffer = self._session.render(strength, out=self._buffer)
+        height, width = self._buffer.shape[:2]
+        qimage = QImage(self._buffer.data, width, height, self._buffer.strides[0], QImage.Format_RGB888)
+        return QPixmap.fromImage(qimage)
 
 
 # 全局预览生成器实例
@@ -444,22 +837,83 @@ def get_preview_generator() -> LUTPreviewGenerator:
     return _preview_generator
 
 
-def generate_lut_preview(lut_file_path: str, lut_id: str,
+def generate_lut_preview(lut_file_path: str,
                         output_size: Tuple[int, int] = (256, 256)) -> Optional[QPixmap]:
     """
-    生成LUT预览图的便捷函数
+    生成LUT预览图的便捷函数（结果写入预览缓存）
     
     Args:
         lut_file_path: LUT文件路径
-        lut_id: LUT唯一标识
         output_size: 输出图像尺寸
         
     Returns:
         Optional[QPixmap]: 预览图像
     """
-    generator = get_preview_generator()
-    cache_path = generator.get_preview_path(lut_id)
-    return generator.generate_preview(lut_file_path, output_size, cache_path)
+    return get_preview_generator().generate_preview(lut_file_path, output_size)
+
+
+def generate_lut_preview_atlas(lut_file_paths: List[str],
+                               output_size: Tuple[int, int] = (256, 256),
+                               columns: int = 0,
+                               spacing: int = 0) -> Tuple[Optional[QPixmap], List[Optional[QRect]]]:
+    """
+    为一页LUT生成预览图集的便捷函数
+
+    Args:
+        lut_file_paths: LUT文件路径列表
+        output_size: 每个预览的尺寸 (宽, 高)
+        columns: 图集列数，<= 0 时排成接近正方形
+        spacing: 预览之间的间距（像素）
+
+    Returns:
+        Tuple[Optional[QPixmap], List[Optional[QRect]]]: 图集与各LUT在图集中的矩形
+    """
+    return get_preview_generator().generate_preview_atlas(lut_file_paths, output_size, columns, spacing)
+
+
+def get_cached_lut_preview(lut_file_path: str,
+                           output_size: Tuple[int, int] = (256, 256)) -> Optional[QPixmap]:
+    """
+    从预览缓存取LUT预览图的便捷函数，不生成
+
+    Args:
+        lut_file_path: LUT文件路径
+        output_size: 输出图像尺寸
+
+    Returns:
+        Optional[QPixmap]: 预览图像，未缓存时返回None
+    """
+    return get_preview_generator().cached_preview(lut_file_path, output_size)
+
+
+def generate_lut_previews(lut_file_paths: List[str],
+                          output_size: Tuple[int, int] = (256, 256)) -> List[bool]:
+    """
+    批量生成LUT预览图的便捷函数（已缓存的LUT直接跳过）
+
+    Args:
+        lut_file_paths: LUT文件路径列表
+        output_size: 输出图像尺寸
+
+    Returns:
+        List[bool]: 每个LUT的预览是否可用
+    """
+    return get_preview_generator().generate_previews(lut_file_paths, output_size)
+
+
+def create_lut_strength_preview(lut_file_path: str,
+                                output_size: Tuple[int, int] = (256, 256)) -> Optional[LutStrengthPreview]:
+    """
+    创建可调节强度的LUT预览的便捷函数
+
+    Args:
+        lut_file_path: LUT文件路径
+        output_size: 输出图像尺寸
+
+    Returns:
+        Optional[LutStrengthPreview]: 强度预览，不可用时返回 None
+    """
+    return get_preview_generator().create_strength_preview(lut_file_path, output_size)
 
 
 def create_default_reference_image(output_path: Optional[str] = None) -> bool:
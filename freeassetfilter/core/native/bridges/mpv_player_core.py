@@ -30,6 +30,7 @@ from PySide6.QtCore import QObject, Signal, QTimer, Slot
 from freeassetfilter.utils.app_logger import info, debug, warning, error, exception_details, sanitize_path
 from freeassetfilter.core.managers.heartbeat_manager import HeartbeatManager
 from freeassetfilter.utils.path_utils import validate_dll_path, get_safe_dll_paths
+from freeassetfilter.utils.lut_utils import get_lut_playback_path
 
 # 导入 mpv DLL 路径解析（定位到 core/native/bin/）
 from ..._paths import native_bin_dir
@@ -1530,7 +1531,8 @@ class MPVPlayerCore(QObject):
         if not mpv_handle:
             return False
         try:
-            abs_path = os.path.abspath(lut_path).replace("\\", "/")
+            # 存在降采样的播放副本时优先加载，缩短切换 LUT 的耗时
+            abs_path = os.path.abspath(get_lut_playback_path(lut_path)).replace("\\", "/")
             # 初始化后必须使用 mpv_set_property_string，而非 mpv_set_option_string
             result = self._dll_loader.dll.mpv_set_property_string(
                 mpv_handle,
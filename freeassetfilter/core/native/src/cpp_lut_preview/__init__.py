@@ -10,16 +10,17 @@ from __future__ import annotations
 
 import threading
 from pathlib import Path
-from typing import Optional, Tuple
+from typing import Dict, Optional, Tuple
 from freeassetfilter.utils.app_logger import info, warning
 
 CPP_LUT_PREVIEW_AVAILABLE = False
 _cpp_module = None
+_cpp_lib = None
 _CACHE_LOCK = threading.Lock()
 
 def _try_import_cpp_module():
     """尝试导入 C++ 模块（线程安全）"""
-    global CPP_LUT_PREVIEW_AVAILABLE, _cpp_module
+    global CPP_LUT_PREVIEW_AVAILABLE, _cpp_module, _cpp_lib
     
     with _CACHE_LOCK:
         if _cpp_module is not None:
@@ -30,6 +31,7 @@ def _try_import_cpp_module():
         from . import lut_preview_cpp
         with _CACHE_LOCK:
             _cpp_module = lut_preview_cpp.generate_preview_from_data
+            _cpp_lib = lut_preview_cpp
             CPP_LUT_PREVIEW_AVAILABLE = True
         info("[LUTPreviewCPP] C++ 扩展模块加载成功（相对导入）")
         return True
@@ -41,9 +43,10 @@ def _try_import_cpp_module():
             if cpp_module_path not in sys.path:
                 sys.path.insert(0, cpp_module_path)
             
-            from lut_preview_cpp import generate_preview_from_data as _cpp_generate_preview
+            import lut_preview_cpp as _lib
             with _CACHE_LOCK:
-                _cpp_module = _cpp_generate_preview
+                _cpp_module = _lib.generate_preview_from_data
+                _cpp_lib = _lib
                 CPP_LUT_PREVIEW_AVAILABLE = True
             info("[LUTPreviewCPP] C++ 扩展模块加载成功（绝对导入）")
             return True
@@ -52,6 +55,38 @@ def _try_import_cpp_module():
             return False
 
 
+def _cpp_function(name: str):
+    """
+    取出 C++ 模块中的接口（线程安全）
+    
+    仓库中预编译的 lut_preview_cpp 可能早于当前源码，能导入但缺少后来新增的接口，
+    此时抛出 RuntimeError 而不是 AttributeError，调用方按“C++ 不可用”统一回退。
+    """
+    with _CACHE_LOCK:
+        if not CPP_LUT_PREVIEW_AVAILABLE or _cpp_lib is None:
+            raise RuntimeError("C++ 模块不可用")
+        function = getattr(_cpp_lib, name, None)
+    if function is None:
+        raise RuntimeError(f"C++ 模块缺少接口 {name}，需要重新编译 lut_preview_cpp")
+    return function
+
+
+def has_cpp_api(*names: str) -> bool:
+    """
+    检查 C++ 模块已加载且提供全部给定接口（线程安全）
+    
+    Args:
+        *names: 接口名，如 "lookup_preview"、"generate_preview_cached"
+    
+    Returns:
+        bool: 全部可用时为 True
+    """
+    with _CACHE_LOCK:
+        if not CPP_LUT_PREVIEW_AVAILABLE or _cpp_lib is None:
+            return False
+        return all(hasattr(_cpp_lib, name) for name in names)
+
+
 def warmup():
     """
     预热 C++ 模块（线程安全）
@@ -89,7 +124,11 @@ LUT_3D_SIZE 2
 
 
 def generate_preview(lut_content: str, image_array: np.ndarray, 
-                    output_width: int, output_height: int) -> bytes:
+                    output_width: int, output_height: int,
+                    compress_level: int = 6,
+                    interpolation: str = "trilinear",
+                    resample: str = "bilinear",
+                    input_format: str = "auto") -> bytes:
     """
     从 LUT 内容生成预览图像（线程安全）
     
@@ -98,6 +137,11 @@ def generate_preview(lut_content: str, image_array: np.ndarray,
         image_array: 图像 numpy 数组
         output_width: 输出宽度
         output_height: 输出高度
+        compress_level: PNG 压缩级别（0 为不压缩，1 最快，9 压缩率最高）
+        interpolation: 3D LUT 插值方式，"trilinear" 或 "tetrahedral"
+        resample: 缩放滤波器，"box"（面积平均）、"bilinear" 或 "lanczos3"
+        input_format: 输入通道顺序，"auto"（按通道数视为 RGB/RGBA）、"rgb"、"bgr"、"rgba"、"bgra"、"rgbx" 或 "bgrx"；
+            带 alpha 的输入生成 RGBA PNG
     
     Returns:
         PNG 格式的图像数据
@@ -106,7 +150,558 @@ def generate_preview(lut_content: str, image_array: np.ndarray,
         if not CPP_LUT_PREVIEW_AVAILABLE or _cpp_module is None:
             raise RuntimeError("C++ 模块不可用")
         cpp_module = _cpp_module
-    return cpp_module(lut_content, image_array, output_width, output_height)
+        legacy = not hasattr(_cpp_lib, "generate_preview_pixels")
+    if legacy:
+        # 旧版预编译模块只接受 (lut_content, image_array, width, height)
+        if (compress_level, interpolation, resample, input_format) != (6, "trilinear", "bilinear", "auto"):
+            raise RuntimeError("C++ 模块版本过旧，不支持压缩级别、插值、缩放与通道顺序参数，需要重新编译 lut_preview_cpp")
+        return cpp_module(lut_content, image_array, output_width, output_height)
+    return cpp_module(lut_content, image_array, output_width, output_height, compress_level,
+                      interpolation, resample, input_format)
+
+
+def load_lut(lut_file_path: str):
+    """
+    加载 LUT 文件为可复用的 Lut 对象（线程安全）
+    
+    C++ 端按路径、修改时间和文件大小缓存解析结果，重复加载同一文件不再解析。
+    
+    Args:
+        lut_file_path: LUT 文件路径
+    
+    Returns:
+        lut_preview_cpp.Lut 对象
+    """
+    return _cpp_function("load_lut")(lut_file_path)
+
+
+def evict_lut(lut_file_path: str) -> bool:
+    """
+    从 LUT 缓存中移除指定文件（线程安全）
+    
+    删除或替换 LUT 文件前调用，使缓存不再持有其 .lutc 映射（Windows 下被映射的文件无法删除）。
+    其他地方仍持有的 Lut 对象继续有效。
+    
+    Args:
+        lut_file_path: LUT 文件路径
+    
+    Returns:
+        缓存中是否存在该项
+    """
+    return _cpp_function("evict_lut")(lut_file_path)
+
+
+def parse_lut_file(lut_file_path: str):
+    """
+    解析 LUT 文件为 Lut 对象，不经过缓存（线程安全）
+    
+    适用于导入/校验等一次性场景；格式错误时抛出 RuntimeError，信息中包含出错行号。
+    
+    Args:
+        lut_file_path: LUT 文件路径
+    
+    Returns:
+        lut_preview_cpp.Lut 对象
+    """
+    return _cpp_function("Lut").from_file(lut_file_path)
+
+
+def set_lut_binary_cache_dir(cache_dir: str):
+    """
+    设置二进制 LUT 缓存目录（线程安全）
+    
+    启用后 load_lut 首次解析 .cube 时写出 .lutc 缓存，之后直接内存映射使用，无需解析；
+    源文件大小、修改时间或内容变化时自动重新解析并重写缓存。
+    
+    Args:
+        cache_dir: 缓存目录，为空字符串时禁用
+    """
+    _cpp_function("set_lut_binary_cache_dir")(cache_dir or "")
+
+
+def get_lut_binary_path(lut_file_path: str) -> str:
+    """
+    获取 LUT 文件对应的二进制缓存路径（线程安全）
+    
+    Args:
+        lut_file_path: LUT 文件路径
+    
+    Returns:
+        .lutc 缓存路径，未启用二进制缓存时为空字符串
+    """
+    return _cpp_function("get_lut_binary_path")(lut_file_path)
+
+
+def get_lut_cache_info() -> dict:
+    """
+    获取 LUT 缓存的统计信息（线程安全）
+    
+    Returns:
+        dict: entries、bytes、limit、hits、misses（内存层）、binary_hits、binary_writes（.lutc 缓存）、
+            source_hashes（读取并哈希 .cube 源文件的次数）
+    """
+    return _cpp_function("get_lut_cache_info")()
+
+
+def generate_preview_pixels(lut, image_array: np.ndarray,
+                            output_width: int, output_height: int,
+                            pixel_format: str = "rgb",
+                            interpolation: str = "trilinear",
+                            resample: str = "bilinear",
+                            input_format: str = "auto",
+                            out: Optional[np.ndarray] = None) -> np.ndarray:
+    """
+    从 LUT 生成预览像素，跳过 PNG 编码（线程安全）
+    
+    Args:
+        lut: Lut 对象、LUT 文件路径或 LUT 文件内容（字符串）
+        image_array: 图像 numpy 数组，dtype 为 uint8/uint16/float32/float16（浮点按 0~1 归一化）；
+            16 位与浮点输入以浮点精度缩放并应用 LUT，只在输出时量化为 8 位
+        output_width: 输出宽度
+        output_height: 输出高度
+        pixel_format: "rgb"（RGB888）或 "rgba"（RGBA8888）
+        interpolation: 3D LUT 插值方式，"trilinear" 或 "tetrahedral"（与调色软件/mpv 一致）
+        resample: 缩放滤波器，"box"（面积平均）、"bilinear" 或 "lanczos3"
+        input_format: 输入通道顺序，"auto"（按通道数视为 RGB/RGBA）、"rgb"、"bgr"、"rgba"、"bgra"、"rgbx" 或 "bgrx"；
+            支持任意行/像素步长的视图（如带行填充的 QImage 缓冲），RGBA 输入的 alpha 会传递到输出
+        out: 可选的输出缓冲，形状 (height, width, 3|4)、C 连续的 uint8 数组；
+            滚动列表时反复传入同一块缓冲，配合 Lut 对象可做到稳态下不分配堆内存
+    
+    Returns:
+        形状为 (height, width, 3|4) 的 uint8 数组（传入 out 时即 out），可直接构造 QImage
+    """
+    return _cpp_function("generate_preview_pixels")(lut, image_array, output_width, output_height,
+                                                    pixel_format, interpolation, resample, input_format, out)
+
+
+def generate_previews_batch(luts, image_array: np.ndarray,
+                            output_width: int, output_height: int,
+                            pixel_format: str = "rgb",
+                            interpolation: str = "trilinear",
+                            resample: str = "bilinear",
+                            input_format: str = "auto",
+                            use_cache: bool = False,
+                            image_key: int = 0) -> list:
+    """
+    用同一张参考图像为多个 LUT 生成预览像素（线程安全）
+    
+    参考图像只缩放一次，各 LUT 在 C++ 端并行应用，计算期间释放 GIL。
+    
+    Args:
+        luts: Lut 对象、LUT 文件路径或 LUT 文件内容组成的列表
+        image_array: 图像 numpy 数组
+        output_width: 输出宽度
+        output_height: 输出高度
+        pixel_format: "rgb"（RGB888）或 "rgba"（RGBA8888）
+        interpolation: 3D LUT 插值方式，"trilinear" 或 "tetrahedral"
+        resample: 缩放滤波器，"box"（面积平均）、"bilinear" 或 "lanczos3"
+        input_format: 输入通道顺序，"auto"（按通道数视为 RGB/RGBA）、"rgb"、"bgr"、"rgba"、"bgra"、"rgbx" 或 "bgrx"
+        use_cache: 是否经过预览缓存（见 generate_preview_cached），命中的条目不再生成
+        image_key: image_content_key(image_array) 的结果，为 0 时每次调用现算；必须与 image_array 对应
+    
+    Returns:
+        与 luts 等长的列表，元素为 (height, width, 3|4) 的 uint8 数组，解析失败的条目为 None
+    """
+    return _cpp_function("generate_previews_batch")(list(luts), image_array, output_width, output_height,
+                                                    pixel_format, interpolation, resample, input_format,
+                                                    use_cache, image_key)
+
+
+def generate_preview_atlas(luts, image_array: np.ndarray,
+                           cell_width: int, cell_height: int,
+                           columns: int = 0,
+                           spacing: int = 0,
+                           pixel_format: str = "rgb",
+                           interpolation: str = "trilinear",
+                           resample: str = "bilinear",
+                           input_format: str = "auto",
+                           use_cache: bool = False,
+                           image_key: int = 0) -> Tuple[np.ndarray, list]:
+    """
+    为多个 LUT 生成预览并拼成一张图集（线程安全）
+    
+    参考图像只缩放一次，各 LUT 的结果直接写入图集中对应的格子，界面可用一张 QPixmap
+    绘制整页卡片；use_cache 时整张图集作为一个缓存条目，冷启动只需读取一个文件。
+    
+    Args:
+        luts: Lut 对象、LUT 文件路径或 LUT 文件内容组成的列表
+        image_array: 参考图像 numpy 数组
+        cell_width: 每个格子的宽度
+        cell_height: 每个格子的高度
+        columns: 列数，<= 0 时排成接近正方形
+        spacing: 格子之间的间距（像素）
+        pixel_format: "rgb"（RGB888）或 "rgba"（RGBA8888）
+        interpolation: 3D LUT 插值方式，"trilinear" 或 "tetrahedral"
+        resample: 缩放滤波器，"box"（面积平均）、"bilinear" 或 "lanczos3"
+        input_format: 输入通道顺序，"auto"（按通道数视为 RGB/RGBA）、"rgb"、"bgr"、"rgba"、"bgra"、"rgbx" 或 "bgrx"
+        use_cache: 是否经过预览缓存
+        image_key: image_content_key(image_array) 的结果，为 0 时每次调用现算；必须与 image_array 对应
+    
+    Returns:
+        (图集数组, 矩形列表)：矩形为 (x, y, 宽, 高)，与 luts 一一对应，解析失败的条目为 None（格子留空）
+    """
+    return _cpp_function("generate_preview_atlas")(list(luts), image_array, cell_width, cell_height, columns, spacing,
+                                                   pixel_format, interpolation, resample, input_format, use_cache,
+                                                   image_key)
+
+
+def generate_preview_scopes(lut, image_array: np.ndarray,
+                            output_width: int, output_height: int,
+                            pixel_format: str = "rgb",
+                            interpolation: str = "trilinear",
+                            resample: str = "bilinear",
+                            input_format: str = "auto",
+                            scope_width: int = 256,
+                            vectorscope_size: int = 128) -> Tuple[np.ndarray, Dict[str, Dict[str, np.ndarray]]]:
+    """
+    生成预览像素，并统计源图与调色结果的示波器数据（线程安全）
+    
+    统计在应用 LUT 的同一轮行带中完成，各线程先累加到局部计数再合并，统计对象是预览尺寸的像素。
+    亮度与色差按 BT.709 计算；波形与矢量图的第 0 行对应最高电平 / 最大 Cr，可直接当作图像绘制。
+    
+    Args:
+        lut: Lut 对象、LUT 文件路径或 LUT 文件内容（字符串）
+        image_array: 参考图像 numpy 数组
+        output_width: 输出宽度
+        output_height: 输出高度
+        pixel_format: "rgb"（RGB888）或 "rgba"（RGBA8888）
+        interpolation: 3D LUT 插值方式，"trilinear" 或 "tetrahedral"
+        resample: 缩放滤波器，"box"（面积平均）、"bilinear" 或 "lanczos3"
+        input_format: 输入通道顺序，"auto"（按通道数视为 RGB/RGBA）、"rgb"、"bgr"、"rgba"、"bgra"、"rgbx" 或 "bgrx"
+        scope_width: 波形与分量波形的列数（1~4096）
+        vectorscope_size: 矢量示波器的边长（2~1024）
+    
+    Returns:
+        (像素数组, {"source": 示波器, "graded": 示波器})，每组示波器为 uint32 计数：
+        histogram (4, 256) 依次为 R/G/B/亮度，waveform (256, scope_width)，
+        parade (3, 256, scope_width)，vectorscope (vectorscope_size, vectorscope_size)，横轴 Cb、纵轴 Cr
+    """
+    return _cpp_function("generate_preview_scopes")(lut, image_array, output_width, output_height,
+                                                    pixel_format, interpolation, resample, input_format,
+                                                    scope_width, vectorscope_size)
+
+
+def generate_preview_cached(lut, image_array: np.ndarray,
+                            output_width: int, output_height: int,
+                            pixel_format: str = "rgb",
+                            interpolation: str = "trilinear",
+                            resample: str = "bilinear",
+                            input_format: str = "auto",
+                            image_key: int = 0,
+                            out: Optional[np.ndarray] = None) -> np.ndarray:
+    """
+    生成预览像素，结果经过 C++ 端的预览缓存（线程安全）
+    
+    缓存键是 LUT 格点、参考图像像素、输出尺寸/格式、插值与缩放方式的 XXH64，
+    任一输入变化都会重新生成；命中时从内存层或磁盘层直接复制像素，不经过 Python 文件接口。
+    LUT 的格点哈希在加载时已算好；同一参考图像反复查询时传入 image_key，免去每次哈希全部像素。
+    
+    Args:
+        lut: Lut 对象、LUT 文件路径或 LUT 文件内容（字符串）
+        image_array: 参考图像 numpy 数组
+        output_width: 输出宽度
+        output_height: 输出高度
+        pixel_format: "rgb"（RGB888）或 "rgba"（RGBA8888）
+        interpolation: 3D LUT 插值方式，"trilinear" 或 "tetrahedral"
+        resample: 缩放滤波器，"box"（面积平均）、"bilinear" 或 "lanczos3"
+        input_format: 输入通道顺序，"auto"（按通道数视为 RGB/RGBA）、"rgb"、"bgr"、"rgba"、"bgra"、"rgbx" 或 "bgrx"
+        image_key: image_content_key(image_array) 的结果，为 0 时每次调用现算；必须与 image_array 对应
+        out: 可选的输出缓冲，要求同 generate_preview_pixels
+    
+    Returns:
+        形状为 (height, width, 3|4) 的 uint8 数组（传入 out 时即 out）
+    """
+    return _cpp_function("generate_preview_cached")(lut, image_array, output_width, output_height,
+                                                    pixel_format, interpolation, resample, input_format,
+                                                    image_key, out)
+
+
+def lookup_preview(lut, image_array: np.ndarray,
+                   output_width: int, output_height: int,
+                   pixel_format: str = "rgb",
+                   interpolation: str = "trilinear",
+                   resample: str = "bilinear",
+                   input_format: str = "auto",
+                   image_key: int = 0,
+                   out: Optional[np.ndarray] = None) -> Optional[np.ndarray]:
+    """
+    只查预览缓存，不生成（线程安全）
+    
+    参数与 generate_preview_cached 相同；传入 out 时只在命中后写入，未命中不改动其内容。
+    
+    Returns:
+        命中时为 (height, width, 3|4) 的 uint8 数组（传入 out 时即 out），未命中时为 None
+    """
+    return _cpp_function("lookup_preview")(lut, image_array, output_width, output_height,
+                                           pixel_format, interpolation, resample, input_format, image_key, out)
+
+
+def image_content_key(image_array: np.ndarray, input_format: str = "auto") -> int:
+    """
+    计算参考图像的预览缓存键（线程安全）
+    
+    结果只取决于像素内容与布局；参考图像不变时算一次并作为 image_key 传给各缓存接口。
+    
+    Args:
+        image_array: 参考图像 numpy 数组
+        input_format: 输入通道顺序，与之后传给缓存接口的 input_format 一致
+    
+    Returns:
+        64 位整数键
+    """
+    return _cpp_function("image_content_key")(image_array, input_format)
+
+
+def set_preview_cache_dir(cache_dir: str):
+    """
+    设置预览缓存的磁盘目录（线程安全）
+    
+    条目以 <键>.fafp 保存按 PNG 方式逐行滤波并压缩的像素，先写临时文件再替换，不会留下写了一半的文件。
+    设置时统计目录用量，超出磁盘层上限则按修改时间从旧到新删除条目（见 set_preview_cache_disk_limit）。
+    
+    Args:
+        cache_dir: 缓存目录，为空字符串时只使用内存层
+    """
+    _cpp_function("set_preview_cache_dir")(cache_dir or "")
+
+
+def set_preview_cache_disk_limit(limit_bytes: int):
+    """
+    设置预览缓存磁盘层的字节上限（线程安全，默认 256MB）
+    
+    默认值按 256×256 预览卡片估算：照片类内容约两千张，像素完全不可压缩时也能容纳一千张。
+    
+    写入后用量超出上限时，按修改时间从旧到新删除 .fafp 条目，直到不超过上限的 3/4；
+    磁盘命中会刷新条目的修改时间，LUT 改动或删除后留下的孤立条目最先被清除。
+    
+    Args:
+        limit_bytes: 字节上限
+    """
+    _cpp_function("set_preview_cache_disk_limit")(limit_bytes)
+
+
+def clear_preview_cache(disk: bool = False):
+    """
+    清空预览缓存（线程安全）
+    
+    Args:
+        disk: 是否同时删除磁盘目录中的缓存条目
+    """
+    _cpp_function("clear_preview_cache")(disk)
+
+
+def get_preview_cache_info() -> dict:
+    """
+    获取预览缓存的统计信息（线程安全）
+    
+    Returns:
+        dict: entries、bytes、limit（内存层）、memory_hits、disk_hits、misses、disk_writes、
+            disk_bytes、disk_limit（磁盘层）、dir
+    """
+    return _cpp_function("get_preview_cache_info")()
+
+
+def generate_preview_mips(lut, image_array: np.ndarray, sizes,
+                          pixel_format: str = "rgb",
+                          interpolation: str = "trilinear",
+                          resample: str = "bilinear",
+                          input_format: str = "auto") -> list:
+    """
+    一次生成多个尺寸（如 1x/2x/3x）的预览像素（线程安全）
+    
+    只在面积最大的尺寸上缩放参考图像并应用 LUT，较小的尺寸由上一级经 Lanczos3 缩小得到，
+    切换显示器或缩放比例时无需重新对源图查表。
+    
+    Args:
+        lut: Lut 对象、LUT 文件路径或 LUT 文件内容（字符串）
+        image_array: 参考图像 numpy 数组，(height, width, 3/4)
+        sizes: 输出尺寸 (宽, 高) 列表
+        pixel_format: "rgb"（RGB888）或 "rgba"（RGBA8888）
+        interpolation: 3D LUT 插值方式，"trilinear" 或 "tetrahedral"
+        resample: 源图缩放滤波器，"box"（面积平均）、"bilinear" 或 "lanczos3"
+        input_format: 输入通道顺序，"auto"（按通道数视为 RGB/RGBA）、"rgb"、"bgr"、"rgba"、"bgra"、"rgbx" 或 "bgrx"
+    
+    Returns:
+        与 sizes 顺序一致的 numpy 数组列表，每个形状为 (height, width, channels)
+    """
+    return _cpp_function("generate_preview_mips")(lut, image_array, [tuple(size) for size in sizes],
+                                                  pixel_format, interpolation, resample, input_format)
+
+
+def create_preview_session(lut, image_array: np.ndarray,
+                           output_width: int, output_height: int,
+                           interpolation: str = "trilinear",
+                           resample: str = "bilinear",
+                           input_format: str = "auto"):
+    """
+    创建 LUT 强度预览会话（线程安全）
+    
+    缩放后的原始帧与完整应用 LUT 的效果帧常驻 C++ 端；之后每次 render(strength)
+    只在两帧之间做一次 SIMD 混合，不再重复缩放和查表，适合滑块实时调节。
+    
+    Args:
+        lut: Lut 对象、LUT 文件路径或 LUT 文件内容（字符串）
+        image_array: 参考图像 numpy 数组，(height, width, 3/4)
+        output_width: 输出宽度
+        output_height: 输出高度
+        interpolation: 3D LUT 插值方式，"trilinear" 或 "tetrahedral"
+        resample: 缩放滤波器，"box"（面积平均）、"bilinear" 或 "lanczos3"
+        input_format: 输入通道顺序，"auto"（按通道数视为 RGB/RGBA）、"rgb"、"bgr"、"rgba"、"bgra"、"rgbx" 或 "bgrx"
+    
+    Returns:
+        lut_preview_cpp.PreviewSession 对象，提供 render(strength, pixel_format, out) 与 set_lut(lut)
+    """
+    return _cpp_function("PreviewSession")(lut, image_array, output_width, output_height,
+                                           interpolation, resample, input_format)
+
+
+# 异步预览优先级：可见卡片优先于预取
+PRIORITY_PREFETCH = 0
+PRIORITY_VISIBLE = 1
+
+
+def submit_preview(lut, image_array: np.ndarray,
+                   output_width: int, output_height: int,
+                   pixel_format: str = "rgb",
+                   interpolation: str = "trilinear",
+                   resample: str = "bilinear",
+                   input_format: str = "auto",
+                   priority: int = PRIORITY_PREFETCH,
+                   progressive: bool = False):
+    """
+    提交异步预览任务（线程安全）
+    
+    任务由 C++ 端的调度线程按优先级执行（数值大者先执行，同级按提交顺序），
+    立即返回 PreviewTask 句柄：done() 轮询、result(timeout_ms) 等待结果、
+    cancel() 取消、priority 属性调整优先级。排队中的任务取消后立即出队，
+    运行中的任务在下一个行带前停止；句柄被回收时任务会被自动取消。
+    
+    progressive 时任务先用最近邻取样与最近格点生成 1/4 分辨率的草稿（通常只需几毫秒），
+    再生成正式结果；result(timeout_ms, draft=True) 在正式结果完成前返回草稿，可据 done() 区分。
+    
+    Args:
+        lut: Lut 对象、LUT 文件路径或 LUT 文件内容（字符串）
+        image_array: 参考图像 numpy 数组，(height, width, 3/4)，任务结束前不应修改
+        output_width: 输出宽度
+        output_height: 输出高度
+        pixel_format: "rgb"（RGB888）或 "rgba"（RGBA8888）
+        interpolation: 3D LUT 插值方式，"trilinear" 或 "tetrahedral"
+        resample: 源图缩放滤波器，"box"（面积平均）、"bilinear" 或 "lanczos3"
+        input_format: 输入通道顺序，"auto"（按通道数视为 RGB/RGBA）、"rgb"、"bgr"、"rgba"、"bgra"、"rgbx" 或 "bgrx"
+        priority: 优先级，PRIORITY_VISIBLE 或 PRIORITY_PREFETCH
+        progressive: 是否先生成低分辨率草稿
+    
+    Returns:
+        PreviewTask 句柄，result() 返回形状为 (height, width, channels) 的 numpy 数组
+    """
+    return _cpp_function("submit_preview")(lut, image_array, output_width, output_height,
+                                           pixel_format, interpolation, resample, input_format,
+                                           priority, progressive)
+
+
+def apply_lut(lut, image_array: np.ndarray,
+              interpolation: str = "trilinear",
+              input_format: str = "auto",
+              output_dtype: str = "") -> np.ndarray:
+    """
+    以原始分辨率对整幅图像应用 LUT（线程安全）
+    
+    Args:
+        lut: Lut 对象、LUT 文件路径或 LUT 文件内容（字符串）
+        image_array: 图像 numpy 数组，dtype 为 uint8/uint16/float32/float16（浮点按 0~1 归一化）
+        interpolation: 3D LUT 插值方式，"trilinear" 或 "tetrahedral"
+        input_format: 输入通道顺序，"auto"（按通道数视为 RGB/RGBA）、"rgb"、"bgr"、"rgba"、"bgra"、"rgbx" 或 "bgrx"
+        output_dtype: 输出 dtype，"uint8"、"uint16"、"float32" 或 "float16"，为空时与输入相同
+    
+    Returns:
+        与输入同形状、同通道顺序的数组，alpha 原样保留
+    """
+    return _cpp_function("apply_lut")(lut, image_array, interpolation, input_format, output_dtype)
+
+
+def compose_luts(luts, out_size: int = 33,
+                 interpolation: str = "trilinear",
+                 output_path: str = "",
+                 title: str = ""):
+    """
+    将多个 LUT 按顺序烘焙为一个 3D LUT（线程安全）
+    
+    链上每个 LUT 依次作用于格点，1D/3D 可混用；合成后预览和播放只需查一次表。
+    
+    Args:
+        luts: Lut 对象、LUT 文件路径或 LUT 文件内容组成的列表，按应用顺序排列
+        out_size: 输出 3D LUT 的格点数（2~256），常用 17/33/65
+        interpolation: 对链上 3D LUT 取值的插值方式，"trilinear" 或 "tetrahedral"
+        output_path: 非空时同时写出 .cube 文件
+        title: 输出 LUT 的标题，为空时由各 LUT 标题以 " + " 连接
+    
+    Returns:
+        合成后的 Lut 对象
+    """
+    return _cpp_function("compose_luts")(list(luts), out_size, interpolation, output_path or "", title)
+
+
+def resample_lut(lut, new_size: int,
+                 method: str = "tetrahedral",
+                 output_path: str = ""):
+    """
+    将 LUT 重采样到指定格点数（线程安全）
+    
+    Args:
+        lut: Lut 对象、LUT 文件路径或 LUT 文件内容（字符串）
+        new_size: 目标格点数，3D 为 2~256（常用 17/33/65），1D 为 2~65536
+        method: 插值方式，"trilinear" 或 "tetrahedral"
+        output_path: 非空时同时写出 .cube 文件
+    
+    Returns:
+        重采样后的 Lut 对象（1D LUT 仍为 1D）
+    """
+    return _cpp_function("resample_lut")(lut, new_size, method, output_path or "")
+
+
+def set_num_threads(num_threads: int = 0):
+    """
+    设置 C++ 端线程池的线程数（线程安全）
+    
+    线程池由所有入口共享，多个 Python 线程同时生成预览时分享这些线程，不会各自再创建一组。
+    
+    Args:
+        num_threads: 参与计算的线程总数（含调用线程），<= 0 时恢复为 CPU 核心数
+    """
+    _cpp_function("set_num_threads")(num_threads)
+
+
+def get_num_threads() -> int:
+    """获取 C++ 端线程池的线程数（线程安全）"""
+    return _cpp_function("get_num_threads")()
+
+
+def get_scratch_info() -> dict:
+    """
+    获取 C++ 端线程暂存区的统计信息（线程安全）
+    
+    每个线程的暂存区在调用间复用并停留在历史最高水位，同尺寸的重复预览不再为暂存区申请新块。
+    暂存区以外随调用发生的堆分配另计在 heap_allocations：新建的输出数组、预览缓存内存层写入的条目、
+    由内容字符串解析的 LUT。使用 Lut 对象并传入 out 缓冲时，稳态下两项都不再增长；
+    文件路径字符串、Python 参数转换等零散的小对象不在统计范围内。
+    
+    Returns:
+        dict: allocations（暂存区申请新内存块的累计次数）、heap_allocations（暂存区以外的堆分配次数）、
+            reserved_bytes（暂存区当前持有的字节数）
+    """
+    return _cpp_function("get_scratch_info")()
+
+
+def trim_scratch(keep_bytes: int = 0):
+    """
+    收缩 C++ 端的线程暂存区（线程安全）
+    
+    容量超过 keep_bytes 的暂存区整体释放，为 0 时全部释放；正在计算的线程在本次调用结束后再收缩。
+    
+    Args:
+        keep_bytes: 每个线程保留的最大字节数
+    """
+    _cpp_function("trim_scratch")(keep_bytes)
 
 
 def is_cpp_available() -> bool:
@@ -126,6 +721,36 @@ def get_version() -> str:
 __all__ = [
     'warmup',
     'generate_preview',
+    'generate_preview_pixels',
+    'generate_previews_batch',
+    'generate_preview_atlas',
+    'generate_preview_scopes',
+    'generate_preview_cached',
+    'lookup_preview',
+    'image_content_key',
+    'set_preview_cache_dir',
+    'set_preview_cache_disk_limit',
+    'clear_preview_cache',
+    'get_preview_cache_info',
+    'generate_preview_mips',
+    'create_preview_session',
+    'submit_preview',
+    'PRIORITY_VISIBLE',
+    'PRIORITY_PREFETCH',
+    'apply_lut',
+    'compose_luts',
+    'resample_lut',
+    'load_lut',
+    'evict_lut',
+    'parse_lut_file',
+    'set_lut_binary_cache_dir',
+    'get_lut_binary_path',
+    'get_lut_cache_info',
+    'set_num_threads',
+    'get_num_threads',
+    'get_scratch_info',
+    'trim_scratch',
     'is_cpp_available',
+    'has_cpp_api',
     'get_version',
 ]
\ No newline at end of file
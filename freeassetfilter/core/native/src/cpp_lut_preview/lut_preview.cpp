@@ -7,26 +7,68 @@
 #include <pybind11/numpy.h>
 
 #include <vector>
+#include <array>
 #include <cmath>
 #include <algorithm>
 #include <fstream>
-#include <sstream>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <new>
 #include <stdexcept>
+#include <exception>
+#include <type_traits>
 #include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <list>
+#include <set>
+#include <chrono>
+#include <unordered_map>
+#include <filesystem>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-#ifdef _OPENMP
-#include <omp.h>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LUT_HAS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define LUT_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define LUT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#else
+#define LUT_HAS_X86 0
 #endif
 
 #define VERSION "1.0.0"
 
 namespace py = pybind11;
+namespace fs = std::filesystem;
 
 // ============================================================================
 // CRC32 查找表
@@ -47,550 +89,6187 @@ void init_crc_table() {
     });
 }
 
-uint32_t calculate_crc32(const std::vector<uint8_t>& data) {
-    uint32_t crc = 0xFFFFFFFF;
-    for (size_t i = 0; i < data.size(); i++) {
+uint32_t update_crc32(uint32_t crc, const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
         crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
     }
-    return crc ^ 0xFFFFFFFF;
+    return crc;
+}
+
+uint32_t calculate_crc32(const std::vector<uint8_t>& data) {
+    return update_crc32(0xFFFFFFFF, data.data(), data.size()) ^ 0xFFFFFFFF;
 }
 
-// PNG 辅助函数 - 使用固定 CRC
-uint32_t get_chunk_crc(const char* type, const std::vector<uint8_t>& data) {
-    std::vector<uint8_t> crc_data;
-    crc_data.insert(crc_data.end(), type, type + 4);
-    crc_data.insert(crc_data.end(), data.begin(), data.end());
-    return calculate_crc32(crc_data);
+// PNG 辅助函数 - CRC 覆盖 type 和 data
+uint32_t get_chunk_crc(const char* type, const uint8_t* data, size_t size) {
+    uint32_t crc = update_crc32(0xFFFFFFFF, reinterpret_cast<const uint8_t*>(type), 4);
+    crc = update_crc32(crc, data, size);
+    return crc ^ 0xFFFFFFFF;
 }
 
 // ============================================================================
-// 数据结构定义
+// SIMD 支持
 // ============================================================================
 
-struct LUTData {
-    bool is_3d;
-    std::string title;
-    int size;
-    std::vector<float> data_3d;
-    std::vector<float> data_1d;
+// 运行时检测 AVX2 + FMA（同时确认操作系统保存了 YMM 寄存器状态）
+bool detect_avx2() {
+#if LUT_HAS_X86
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    if (!osxsave || !fma) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#else
+    return false;
+#endif
+}
 
-    LUTData() : is_3d(true), size(0) {}
+bool cpu_has_avx2() {
+    static const bool has_avx2 = detect_avx2();
+    return has_avx2;
+}
 
-    bool is_valid() const {
-        if (is_3d) {
-            return size > 0 && data_3d.size() == static_cast<size_t>(size * size * size) * 3;
-        } else {
-            return size > 0 && data_1d.size() == static_cast<size_t>(size) * 3;
-        }
+// 64 字节对齐分配器，保证 SIMD 加载与缓存行对齐
+template <typename T, size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+    template <typename U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t n) {
+        size_t bytes = (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+#ifdef _MSC_VER
+        void* p = _aligned_malloc(bytes, Alignment);
+#else
+        void* p = std::aligned_alloc(Alignment, bytes);
+#endif
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t) {
+#ifdef _MSC_VER
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
     }
+
+    template <typename U> bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
 };
 
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
 // ============================================================================
-// PNG 编码
+// 线程私有暂存区
 // ============================================================================
 
-void write_chunk(std::vector<uint8_t>& buffer, const char* type, const std::vector<uint8_t>& data) {
-    uint32_t length = data.size();
-
-    // 写入长度
-    buffer.push_back((length >> 24) & 0xFF);
-    buffer.push_back((length >> 16) & 0xFF);
-    buffer.push_back((length >> 8) & 0xFF);
-    buffer.push_back(length & 0xFF);
+// 单次调用内的临时缓冲（行带、中间行、缩放权重、PNG 编码缓冲、批量接口的逐项数组等）都从当前线程的暂存区分配：
+// 调用内只做指针递增，最外层 ScratchScope 结束时整体复位；容量不够时才向系统申请新块，
+// 复位时把多个块合并为一块，容量停留在历史最高水位，同尺寸的重复调用不再为这些临时缓冲申请内存。
+// 暂存区以外随调用发生的堆分配（返回给 Python 的数组、预览缓存内存层的条目、由内容字符串解析的 LUT）
+// 计入 g_heap_allocations；调用方传入 out 缓冲并使用 Lut 对象时，稳态下两个计数都不再增长
+std::atomic<uint64_t> g_scratch_allocations{0};  // 暂存区申请新内存块的累计次数
+std::atomic<uint64_t> g_heap_allocations{0};     // 暂存区以外随调用发生的堆分配次数
+std::atomic<int64_t> g_scratch_reserved{0};      // 所有线程的暂存区当前持有的字节数
+std::atomic<uint64_t> g_scratch_trim_epoch{0};   // trim_scratch 的请求序号，各线程在空闲时自行收缩
+std::atomic<size_t> g_scratch_trim_keep{0};
 
-    // 写入类型
-    buffer.insert(buffer.end(), type, type + 4);
+class ScratchArena {
+public:
+    static const size_t kAlignment = 64;
+    static const size_t kMinBlockSize = 256 * 1024;
 
-    // 写入数据
-    if (!data.empty()) {
-        buffer.insert(buffer.end(), data.begin(), data.end());
+    // 线程池的工作线程各自持有一个，线程退出时释放
+    static ScratchArena& local() {
+        thread_local ScratchArena arena;
+        return arena;
     }
 
-    // 计算并写入 CRC（包括 type 和 data）
-    uint32_t crc = get_chunk_crc(type, data);
-    buffer.push_back((crc >> 24) & 0xFF);
-    buffer.push_back((crc >> 16) & 0xFF);
-    buffer.push_back((crc >> 8) & 0xFF);
-    buffer.push_back(crc & 0xFF);
-}
+    ScratchArena() = default;
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+    ~ScratchArena() { free_blocks(); }
 
-void write_png_to_buffer(const uint8_t* image_data, int width, int height,
-                         std::vector<uint8_t>& buffer) {
-    const uint8_t png_signature[] = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
-    buffer.insert(buffer.end(), png_signature, png_signature + 8);
-
-    std::vector<uint8_t> ihdr_data(13);
-    ihdr_data[0] = (width >> 24) & 0xFF;
-    ihdr_data[1] = (width >> 16) & 0xFF;
-    ihdr_data[2] = (width >> 8) & 0xFF;
-    ihdr_data[3] = width & 0xFF;
-    ihdr_data[4] = (height >> 24) & 0xFF;
-    ihdr_data[5] = (height >> 16) & 0xFF;
-    ihdr_data[6] = (height >> 8) & 0xFF;
-    ihdr_data[7] = height & 0xFF;
-    ihdr_data[8] = 8;
-    ihdr_data[9] = 2;
-    ihdr_data[10] = 0;
-    ihdr_data[11] = 0;
-    ihdr_data[12] = 0;
-
-    write_chunk(buffer, "IHDR", ihdr_data);
-
-    std::vector<uint8_t> raw_data;
-    raw_data.reserve(height * (1 + width * 3));
-    for (int y = 0; y < height; y++) {
-        raw_data.push_back(0);
-        for (int x = 0; x < width; x++) {
-            int idx = (y * width + x) * 3;
-            raw_data.push_back(image_data[idx]);
-            raw_data.push_back(image_data[idx + 1]);
-            raw_data.push_back(image_data[idx + 2]);
+    struct Mark {
+        size_t block;
+        size_t used;
+        size_t in_use;
+    };
+
+    // 返回 64 字节对齐、未初始化的内存，只在所属 ScratchScope 内有效
+    void* allocate(size_t bytes) {
+        if (depth_ == 0) {
+            throw std::logic_error("Scratch allocation outside of ScratchScope");
+        }
+        bytes = round_up(std::max<size_t>(bytes, 1));
+        while (current_ < blocks_.size() && blocks_[current_].size - used_ < bytes) {
+            // 当前块放不下：后面已有的块复用，否则追加新块
+            current_++;
+            used_ = 0;
+        }
+        if (current_ == blocks_.size()) {
+            size_t last = blocks_.empty() ? 0 : blocks_.back().size;
+            add_block(std::max({bytes, kMinBlockSize, last * 2}));
         }
+        void* p = blocks_[current_].data + used_;
+        used_ += bytes;
+        in_use_ += bytes;
+        peak_ = std::max(peak_, in_use_);
+        return p;
     }
 
-    std::vector<uint8_t> compressed;
-    compressed.push_back(0x78);
-    compressed.push_back(0x01);
-
-    const size_t max_block_size = 65535;
-    size_t pos = 0;
-    while (pos < raw_data.size()) {
-        size_t block_size = std::min(raw_data.size() - pos, max_block_size);
-        bool is_last = (pos + block_size >= raw_data.size());
-
-        compressed.push_back(is_last ? 0x01 : 0x00);
-        compressed.push_back(block_size & 0xFF);
-        compressed.push_back((block_size >> 8) & 0xFF);
-        compressed.push_back((~block_size) & 0xFF);
-        compressed.push_back((~block_size >> 8) & 0xFF);
-
-        compressed.insert(compressed.end(), raw_data.begin() + pos, raw_data.begin() + pos + block_size);
-        pos += block_size;
+    // 只回收最近一次分配（std::vector 扩容时释放旧缓冲的常见情形），其余留到复位时统一回收
+    void deallocate(void* p, size_t bytes) {
+        bytes = round_up(std::max<size_t>(bytes, 1));
+        if (current_ < blocks_.size() && used_ >= bytes &&
+            static_cast<uint8_t*>(p) == blocks_[current_].data + used_ - bytes) {
+            used_ -= bytes;
+            in_use_ -= bytes;
+        }
     }
 
-    uint32_t a = 1, b = 0;
-    for (size_t i = 0; i < raw_data.size(); i++) {
-        a = (a + raw_data[i]) % 65521;
-        b = (b + a) % 65521;
+    template <typename T>
+    T* alloc(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T)));
     }
-    uint32_t adler = (b << 16) | a;
-    compressed.push_back((adler >> 24) & 0xFF);
-    compressed.push_back((adler >> 16) & 0xFF);
-    compressed.push_back((adler >> 8) & 0xFF);
-    compressed.push_back(adler & 0xFF);
-
-    write_chunk(buffer, "IDAT", compressed);
-
-    write_chunk(buffer, "IEND", std::vector<uint8_t>());
-}
 
-// ============================================================================
-// LUT 解析器
-// ============================================================================
+    Mark enter() {
+        depth_++;
+        return Mark{current_, used_, in_use_};
+    }
 
-bool parse_cube_data(const std::vector<std::string>& lines, LUTData& lut) {
-    lut.is_3d = true;
-    lut.size = 0;
-    int data_start = 0;
-
-    // 解析头部信息
-    for (int i = 0; i < (int)lines.size(); i++) {
-        std::string trimmed = lines[i];
-        
-        // 使用 find_first_not_of 来 trim
-        size_t start = trimmed.find_first_not_of(" \t\r\n");
-        if (start == std::string::npos) continue;
-        size_t end = trimmed.find_last_not_of(" \t\r\n");
-        trimmed = trimmed.substr(start, end - start + 1);
-        
-        if (trimmed.empty() || trimmed[0] == '#') {
-            continue;
-        }
-        
-        // 解析 TITLE
-        if (trimmed.rfind("TITLE", 0) == 0) {
-            size_t pos1 = trimmed.find('"');
-            size_t pos2 = trimmed.find('"', pos1 + 1);
-            if (pos1 != std::string::npos && pos2 != std::string::npos) {
-                lut.title = trimmed.substr(pos1 + 1, pos2 - pos1 - 1);
-            }
-            continue;
-        }
-        
-        // 解析 LUT_3D_SIZE
-        if (trimmed.rfind("LUT_3D_SIZE", 0) == 0) {
-            lut.is_3d = true;
-            std::istringstream iss(trimmed);
-            std::string word;
-            std::string last_word;
-            while (iss >> word) {
-                last_word = word;
-            }
-            lut.size = std::stoi(last_word);
-            continue;
-        }
-        
-        // 解析 LUT_1D_SIZE
-        if (trimmed.rfind("LUT_1D_SIZE", 0) == 0) {
-            lut.is_3d = false;
-            std::istringstream iss(trimmed);
-            std::string word;
-            std::string last_word;
-            while (iss >> word) {
-                last_word = word;
-            }
-            lut.size = std::stoi(last_word);
-            continue;
-        }
-        
-        // 检查是否是数据行
-        std::istringstream iss(trimmed);
-        float r, g, b;
-        if (iss >> r >> g >> b) {
-            data_start = i;
-            break;
-        }
-    }
-
-    // 解析数据
-    for (int i = data_start; i < (int)lines.size(); i++) {
-        std::string trimmed = lines[i];
-        
-        size_t start = trimmed.find_first_not_of(" \t\r\n");
-        if (start == std::string::npos) continue;
-        size_t end = trimmed.find_last_not_of(" \t\r\n");
-        trimmed = trimmed.substr(start, end - start + 1);
-        
-        if (trimmed.empty() || trimmed[0] == '#') {
-            continue;
+    void leave(const Mark& mark) {
+        current_ = mark.block;
+        used_ = mark.used;
+        in_use_ = mark.in_use;
+        if (--depth_ > 0) {
+            return;
         }
-        
-        std::istringstream iss(trimmed);
-        float r, g, b;
-        if (iss >> r >> g >> b) {
-            if (lut.is_3d) {
-                lut.data_3d.push_back(r);
-                lut.data_3d.push_back(g);
-                lut.data_3d.push_back(b);
-            } else {
-                lut.data_1d.push_back(r);
-                lut.data_1d.push_back(g);
-                lut.data_1d.push_back(b);
-            }
+        // 最外层结束：上一轮用到多个块或单块不够时，合并为一块容纳本轮峰值
+        if (blocks_.size() > 1 || (!blocks_.empty() && blocks_[0].size < peak_)) {
+            size_t peak = peak_;
+            free_blocks();
+            add_block(std::max(peak, kMinBlockSize));
         }
+        current_ = 0;
+        used_ = 0;
+        in_use_ = 0;
+        peak_ = 0;
+        apply_pending_trim();
     }
 
-    if (!lut.is_3d && lut.data_3d.size() > 0) {
-        lut.data_1d = lut.data_3d;
-        lut.data_3d.clear();
+    bool trim_pending() const {
+        return g_scratch_trim_epoch.load(std::memory_order_acquire) != trim_epoch_;
     }
 
-    return lut.is_valid();
-}
+    // 执行 trim_scratch 发出的、本线程尚未处理的收缩请求
+    void apply_pending_trim() {
+        if (trim_pending()) {
+            trim(g_scratch_trim_keep.load(std::memory_order_relaxed));
+        }
+    }
 
-bool parse_cube_file(const std::string& file_path, LUTData& lut) {
-    // 让 Python 端读取文件内容然后调用 parse_cube_data
-    // 这里我们用 ifstream 尝试打开
-    std::ifstream file(file_path);
-    if (!file.is_open()) {
-        return false;
+    // 容量超过 keep_bytes 时整体释放，下次使用重新按需增长；仅在线程空闲（不在 ScratchScope 内）时生效
+    void trim(size_t keep_bytes) {
+        if (depth_ > 0) return;
+        trim_epoch_ = g_scratch_trim_epoch.load(std::memory_order_acquire);
+        if (capacity() > keep_bytes) free_blocks();
     }
 
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(file, line)) {
-        lines.push_back(line);
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Block& block : blocks_) total += block.size;
+        return total;
     }
-    file.close();
-    
-    return parse_cube_data(lines, lut);
-}
 
-// ============================================================================
-// LUT 应用算法
-// ============================================================================
+private:
+    struct Block {
+        uint8_t* data;
+        size_t size;
+    };
 
-inline float clamp01(float v) {
-    return std::max(0.0f, std::min(1.0f, v));
-}
+    static size_t round_up(size_t bytes) {
+        return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    }
 
-inline void apply_3d_lut(const LUTData& lut, float r, float g, float b, float& out_r, float& out_g, float& out_b) {
-    if (!lut.is_valid()) {
-        out_r = r; out_g = g; out_b = b;
-        return;
+    void add_block(size_t size) {
+        size = round_up(size);
+        uint8_t* data = AlignedAllocator<uint8_t, kAlignment>().allocate(size);
+        blocks_.push_back(Block{data, size});
+        g_scratch_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_scratch_reserved.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
     }
 
-    int size = lut.size;
-    float rf = clamp01(r) * (size - 1);
-    float gf = clamp01(g) * (size - 1);
-    float bf = clamp01(b) * (size - 1);
+    void free_blocks() {
+        for (const Block& block : blocks_) {
+            AlignedAllocator<uint8_t, kAlignment>().deallocate(block.data, block.size);
+            g_scratch_reserved.fetch_sub(static_cast<int64_t>(block.size), std::memory_order_relaxed);
+        }
+        blocks_.clear();
+        current_ = 0;
+        used_ = 0;
+        in_use_ = 0;
+    }
 
-    int r0 = static_cast<int>(rf);
-    int g0 = static_cast<int>(gf);
-    int b0 = static_cast<int>(bf);
+    std::vector<Block> blocks_;
+    size_t current_ = 0;   // 正在使用的块
+    size_t used_ = 0;      // 当前块已用字节
+    size_t in_use_ = 0;    // 所有块合计的已用字节
+    size_t peak_ = 0;      // 本轮最外层作用域内的峰值
+    int depth_ = 0;
+    uint64_t trim_epoch_ = 0;
+};
 
-    int r1 = std::min(r0 + 1, size - 1);
-    int g1 = std::min(g0 + 1, size - 1);
-    int b1 = std::min(b0 + 1, size - 1);
+// 暂存区作用域：析构时回到进入时的位置，期间分配的内存全部失效
+// 只在入口函数和并行区域内打开；作用域内不能让外层作用域的 ScratchVector 扩容
+class ScratchScope {
+public:
+    ScratchScope() : arena_(ScratchArena::local()), mark_(arena_.enter()) {}
+    ~ScratchScope() { arena_.leave(mark_); }
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
 
-    float dr = rf - r0;
-    float dg = gf - g0;
-    float db = bf - b0;
+    template <typename T>
+    T* alloc(size_t count) {
+        return arena_.alloc<T>(count);
+    }
 
-    auto get_val = [&lut, size](int r, int g, int b, int channel) -> float {
-        int idx = (b * size + g) * size + r;
-        idx = idx * 3 + channel;
-        if (idx >= 0 && idx < static_cast<int>(lut.data_3d.size())) {
-            return lut.data_3d[idx];
-        }
-        return 0.0f;
-    };
+private:
+    ScratchArena& arena_;
+    ScratchArena::Mark mark_;
+};
+
+// 从构造线程的暂存区分配的 std::vector，用于大小事先未知、需要增长的缓冲
+template <typename T>
+struct ScratchAllocator {
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    template <typename U> struct rebind { using other = ScratchAllocator<U>; };
+
+    ScratchAllocator() : arena(&ScratchArena::local()) {}
+    template <typename U> ScratchAllocator(const ScratchAllocator<U>& other) : arena(other.arena) {}
 
-    float c000_r = get_val(r0, g0, b0, 0), c000_g = get_val(r0, g0, b0, 1), c000_b = get_val(r0, g0, b0, 2);
-    float c001_r = get_val(r0, g0, b1, 0), c001_g = get_val(r0, g0, b1, 1), c001_b = get_val(r0, g0, b1, 2);
-    float c010_r = get_val(r0, g1, b0, 0), c010_g = get_val(r0, g1, b0, 1), c010_b = get_val(r0, g1, b0, 2);
-    float c011_r = get_val(r0, g1, b1, 0), c011_g = get_val(r0, g1, b1, 1), c011_b = get_val(r0, g1, b1, 2);
-    float c100_r = get_val(r1, g0, b0, 0), c100_g = get_val(r1, g0, b0, 1), c100_b = get_val(r1, g0, b0, 2);
-    float c101_r = get_val(r1, g0, b1, 0), c101_g = get_val(r1, g0, b1, 1), c101_b = get_val(r1, g0, b1, 2);
-    float c110_r = get_val(r1, g1, b0, 0), c110_g = get_val(r1, g1, b0, 1), c110_b = get_val(r1, g1, b0, 2);
-    float c111_r = get_val(r1, g1, b1, 0), c111_g = get_val(r1, g1, b1, 1), c111_b = get_val(r1, g1, b1, 2);
+    T* allocate(size_t n) { return arena->alloc<T>(n); }
+    void deallocate(T* p, size_t n) { arena->deallocate(p, n * sizeof(T)); }
 
-    float one_dr = 1.0f - dr;
-    float one_dg = 1.0f - dg;
-    float one_db = 1.0f - db;
+    template <typename U> bool operator==(const ScratchAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U> bool operator!=(const ScratchAllocator<U>& other) const { return arena != other.arena; }
 
-    out_r = c000_r * one_dr * one_dg * one_db + c001_r * one_dr * one_dg * db +
-            c010_r * one_dr * dg * one_db + c011_r * one_dr * dg * db +
-            c100_r * dr * one_dg * one_db + c101_r * dr * one_dg * db +
-            c110_r * dr * dg * one_db + c111_r * dr * dg * db;
+    ScratchArena* arena;
+};
 
-    out_g = c000_g * one_dr * one_dg * one_db + c001_g * one_dr * one_dg * db +
-            c010_g * one_dr * dg * one_db + c011_g * one_dr * dg * db +
-            c100_g * dr * one_dg * one_db + c101_g * dr * one_dg * db +
-            c110_g * dr * dg * one_db + c111_g * dr * dg * db;
+template <typename T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
 
-    out_b = c000_b * one_dr * one_dg * one_db + c001_b * one_dr * one_dg * db +
-            c010_b * one_dr * dg * one_db + c011_b * one_dr * dg * db +
-            c100_b * dr * one_dg * one_db + c101_b * dr * one_dg * db +
-            c110_b * dr * dg * one_db + c111_b * dr * dg * db;
+inline void count_heap_allocation(uint64_t count = 1) {
+    g_heap_allocations.fetch_add(count, std::memory_order_relaxed);
 }
 
-inline void apply_1d_lut(const LUTData& lut, float r, float g, float b, float& out_r, float& out_g, float& out_b) {
-    if (!lut.is_valid()) {
-        out_r = r; out_g = g; out_b = b;
-        return;
-    }
+// 调用结束后仍需保留的缓冲（如预览缓存条目）：仍走普通堆，但每次申请计入 g_heap_allocations
+template <typename T>
+struct CountingAllocator : std::allocator<T> {
+    template <typename U> struct rebind { using other = CountingAllocator<U>; };
 
-    int size = lut.size;
+    CountingAllocator() = default;
+    template <typename U> CountingAllocator(const CountingAllocator<U>&) {}
 
-    auto interpolate = [&lut, size](float value, int offset) -> float {
-        float idx_f = clamp01(value) * (size - 1);
-        int idx0 = static_cast<int>(idx_f);
-        int idx1 = std::min(idx0 + 1, size - 1);
-        float t = idx_f - idx0;
+    T* allocate(size_t n) {
+        count_heap_allocation();
+        return std::allocator<T>::allocate(n);
+    }
+};
 
-        float v0 = lut.data_1d[idx0 * 3 + offset];
-        float v1 = lut.data_1d[idx1 * 3 + offset];
+template <typename T>
+using CountedVector = std::vector<T, CountingAllocator<T>>;
 
-        return v0 * (1.0f - t) + v1 * t;
-    };
+// ============================================================================
+// 线程池
+// ============================================================================
 
-    out_r = interpolate(r, 0);
-    out_g = interpolate(g, 1);
-    out_b = interpolate(b, 2);
-}
+// 模块级常驻线程池：所有入口共享同一组工作线程，多个 Python 线程同时调用时分享核心，
+// 而不是各自拉起一整组线程。parallel_for 把行带/图块作为一个任务组提交，提交线程自己也参与执行；
+// 组内任务用原子游标领取，空闲的工作线程轮流从仍有剩余任务的组中取任务。
+// 嵌套调用（批量预览中的单图并行）同样可行：提交者总能独自完成自己的任务组，不会互相等待
+class ThreadPool {
+public:
+    static ThreadPool& instance() {
+        // 故意不析构：进程退出时工作线程随进程结束，避免在模块卸载阶段 join
+        static ThreadPool* pool = new ThreadPool();
+        return *pool;
+    }
 
-inline void apply_lut_pixel(const LUTData& lut, float r, float g, float b, float& out_r, float& out_g, float& out_b) {
-    if (lut.is_3d) {
-        apply_3d_lut(lut, r, g, b, out_r, out_g, out_b);
-    } else {
-        apply_1d_lut(lut, r, g, b, out_r, out_g, out_b);
+    static int default_threads() {
+        return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
     }
-}
 
-// ============================================================================
-// 图像处理
-// ============================================================================
+    // 参与计算的线程总数（含提交线程）
+    int num_threads() const {
+        return num_threads_.load(std::memory_order_relaxed);
+    }
 
-void resize_image(const uint8_t* src, int src_width, int src_height,
-                  uint8_t* dst, int dst_width, int dst_height) {
-    if (src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0) {
-        if (dst && dst_width > 0 && dst_height > 0) {
-            std::fill(dst, dst + dst_width * dst_height * 3, 0);
+    // 重建工作线程；n <= 0 时恢复为 CPU 核心数。正在执行的任务组由提交线程继续完成
+    void set_num_threads(int n) {
+        n = n <= 0 ? default_threads() : n;
+        std::lock_guard<std::mutex> resize(resize_mutex_);
+        std::vector<std::thread> old_workers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            old_workers.swap(workers_);
         }
-        return;
+        work_cv_.notify_all();
+        for (std::thread& worker : old_workers) worker.join();
+        start_workers(n);
     }
-    float scale_x = static_cast<float>(src_width) / dst_width;
-    float scale_y = static_cast<float>(src_height) / dst_height;
 
-    #pragma omp parallel for schedule(dynamic)
-    for (int y = 0; y < dst_height; y++) {
-        float src_y = (y + 0.5f) * scale_y - 0.5f;
-        int y0 = static_cast<int>(src_y);
-        int y1 = std::min(y0 + 1, src_height - 1);
-        float ty = src_y - y0;
+    // 对 [0, count) 的每个任务调用 body(i)；任一任务抛出异常后跳过尚未开始的任务，全部结束后重新抛出
+    template <typename Body>
+    void parallel_for(int64_t count, Body&& body) {
+        if (count <= 0) {
+            return;
+        }
+        if (count == 1 || num_threads() <= 1) {
+            for (int64_t i = 0; i < count; i++) body(i);
+            return;
+        }
+
+        using Fn = std::remove_reference_t<Body>;
+        TaskGroup group;
+        group.invoke = [](const void* context, int64_t i) { (*static_cast<Fn*>(const_cast<void*>(context)))(i); };
+        group.context = static_cast<const void*>(std::addressof(body));
+        group.count = count;
+
+        size_t wake;
+        bool wake_all;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            groups_.push_back(&group);
+            group.listed = true;
+            wake = std::min(workers_.size(), static_cast<size_t>(count - 1));
+            wake_all = wake == workers_.size();
+        }
+        if (wake_all) {
+            work_cv_.notify_all();
+        } else {
+            for (size_t i = 0; i < wake; i++) work_cv_.notify_one();
+        }
 
-        for (int x = 0; x < dst_width; x++) {
-            float src_x = (x + 0.5f) * scale_x - 0.5f;
-            int x0 = static_cast<int>(src_x);
-            int x1 = std::min(x0 + 1, src_width - 1);
-            float tx = src_x - x0;
+        execute(group);
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            retire(group);
+            done_cv_.wait(lock, [&] { return group.helpers == 0; });
+        }
+        if (group.error) {
+            std::rethrow_exception(group.error);
+        }
+    }
 
-            int dst_idx = (y * dst_width + x) * 3;
+    // 在线程池锁内执行 fn 后唤醒所有空闲工作线程，用于向它们广播请求（如收缩暂存区）
+    template <typename Fn>
+    void notify_idle(Fn&& fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            fn();
+        }
+        work_cv_.notify_all();
+    }
 
-            for (int c = 0; c < 3; c++) {
-                float v00 = src[(y0 * src_width + x0) * 3 + c];
-                float v01 = src[(y0 * src_width + x1) * 3 + c];
-                float v10 = src[(y1 * src_width + x0) * 3 + c];
-                float v11 = src[(y1 * src_width + x1) * 3 + c];
+private:
+    struct TaskGroup {
+        void (*invoke)(const void*, int64_t) = nullptr;
+        const void* context = nullptr;
+        int64_t count = 0;
+        std::atomic<int64_t> next{0};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        int helpers = 0;      // 正在执行该组的工作线程数（受 mutex_ 保护）
+        bool listed = false;  // 是否仍在待领取列表中（受 mutex_ 保护）
+    };
+
+    ThreadPool() {
+        start_workers(default_threads());
+    }
 
-                float v0 = v00 * (1.0f - tx) + v01 * tx;
-                float v1 = v10 * (1.0f - tx) + v11 * tx;
-                float v = v0 * (1.0f - ty) + v1 * ty;
+    void start_workers(int n) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = false;
+        num_threads_.store(n, std::memory_order_relaxed);
+        for (int i = 1; i < n; i++) {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
 
-                dst[dst_idx + c] = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, v)));
+    static void execute(TaskGroup& group) {
+        for (;;) {
+            const int64_t i = group.next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= group.count) {
+                return;
+            }
+            if (group.failed.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            try {
+                group.invoke(group.context, i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(group.error_mutex);
+                if (!group.error) group.error = std::current_exception();
+                group.failed.store(true, std::memory_order_relaxed);
             }
         }
     }
-}
 
-void apply_lut_to_image(const LUTData& lut,
-                        const uint8_t* src, int width, int height,
-                        uint8_t* dst) {
-    #pragma omp parallel for schedule(dynamic)
-    for (int i = 0; i < width * height; i++) {
-        int src_idx = i * 3;
-        int dst_idx = i * 3;
+    // 任务已全部领出的组从待领取列表中移除（调用方持有 mutex_）
+    void retire(TaskGroup& group) {
+        if (!group.listed) return;
+        groups_.erase(std::find(groups_.begin(), groups_.end(), &group));
+        group.listed = false;
+    }
 
-        float r = src[src_idx] / 255.0f;
-        float g = src[src_idx + 1] / 255.0f;
-        float b = src[src_idx + 2] / 255.0f;
+    void worker_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            work_cv_.wait(lock, [&] {
+                return stop_ || !groups_.empty() || ScratchArena::local().trim_pending();
+            });
+            if (stop_) {
+                return;
+            }
+            if (groups_.empty()) {
+                lock.unlock();
+                ScratchArena::local().apply_pending_trim();
+                lock.lock();
+                continue;
+            }
+            TaskGroup& group = *groups_[next_group_++ % groups_.size()];
+            group.helpers++;
+            lock.unlock();
+            execute(group);
+            lock.lock();
+            retire(group);
+            if (--group.helpers == 0) done_cv_.notify_all();
+        }
+    }
 
-        float out_r, out_g, out_b;
-        apply_lut_pixel(lut, r, g, b, out_r, out_g, out_b);
+    std::mutex resize_mutex_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::vector<std::thread> workers_;
+    std::vector<TaskGroup*> groups_;
+    size_t next_group_ = 0;
+    bool stop_ = false;
+    std::atomic<int> num_threads_{1};
+};
 
-        dst[dst_idx] = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, out_r * 255.0f)));
-        dst[dst_idx + 1] = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, out_g * 255.0f)));
-        dst[dst_idx + 2] = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, out_b * 255.0f)));
-    }
+template <typename Body>
+void parallel_for(int64_t count, Body&& body) {
+    ThreadPool::instance().parallel_for(count, std::forward<Body>(body));
+}
+
+// 请求所有线程收缩暂存区：调用线程和空闲的工作线程立即执行，忙碌的线程在当前调用结束时执行
+void trim_scratch(size_t keep_bytes) {
+    g_scratch_trim_keep.store(keep_bytes, std::memory_order_relaxed);
+    ThreadPool::instance().notify_idle([] { g_scratch_trim_epoch.fetch_add(1, std::memory_order_release); });
+    ScratchArena::local().trim(keep_bytes);
 }
 
 // ============================================================================
-// 主生成函数
+// 内容哈希
 // ============================================================================
 
-py::bytes generate_preview_from_data_impl(const std::string& lut_content,
-                                         py::array_t<uint8_t> image_array,
-                                         int output_width,
-                                         int output_height) {
-    init_crc_table();
-
-    // 解析内容行为 lines
-    std::vector<std::string> lines;
-    std::string line;
-    size_t pos = 0, newline_pos;
-    while ((newline_pos = lut_content.find('\n', pos)) != std::string::npos) {
-        line = lut_content.substr(pos, newline_pos - pos);
-        lines.push_back(line);
-        pos = newline_pos + 1;
+// XXH64（与 xxHash 参考实现结果一致）的流式版本，用于 LUT 格点与预览缓存按内容寻址；
+// 每字节开销远低于 FNV-1a，对整张参考图像与 65³ LUT 做哈希也只需亚毫秒
+class XXH64 {
+public:
+    explicit XXH64(uint64_t seed = 0)
+        : total_(0), buffered_(0) {
+        acc_[0] = seed + kPrime1 + kPrime2;
+        acc_[1] = seed + kPrime2;
+        acc_[2] = seed;
+        acc_[3] = seed - kPrime1;
+        seed_ = seed;
     }
-    if (pos < lut_content.size()) {
-        lines.push_back(lut_content.substr(pos));
+
+    void update(const void* data, size_t size) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        total_ += size;
+        if (buffered_ + size < 32) {
+            std::memcpy(buffer_ + buffered_, p, size);
+            buffered_ += size;
+            return;
+        }
+        if (buffered_ > 0) {
+            const size_t fill = 32 - buffered_;
+            std::memcpy(buffer_ + buffered_, p, fill);
+            consume(buffer_);
+            p += fill;
+            size -= fill;
+            buffered_ = 0;
+        }
+        for (; size >= 32; p += 32, size -= 32) {
+            consume(p);
+        }
+        std::memcpy(buffer_, p, size);
+        buffered_ = size;
     }
 
-    LUTData lut;
-    if (!parse_cube_data(lines, lut)) {
-        throw std::runtime_error("Failed to parse LUT data");
+    template <typename T>
+    void update_value(const T& value) {
+        update(&value, sizeof(value));
     }
 
-    py::buffer_info buf = image_array.request();
-    if (buf.ndim != 3) {
-        throw std::runtime_error("Image array must be 3D (height, width, channels)");
+    uint64_t digest() const {
+        uint64_t h;
+        if (total_ >= 32) {
+            h = rotl(acc_[0], 1) + rotl(acc_[1], 7) + rotl(acc_[2], 12) + rotl(acc_[3], 18);
+            for (int i = 0; i < 4; i++) {
+                h ^= round(0, acc_[i]);
+                h = h * kPrime1 + kPrime4;
+            }
+        } else {
+            h = seed_ + kPrime5;
+        }
+        h += total_;
+
+        const uint8_t* p = buffer_;
+        size_t size = buffered_;
+        for (; size >= 8; p += 8, size -= 8) {
+            h ^= round(0, read64(p));
+            h = rotl(h, 27) * kPrime1 + kPrime4;
+        }
+        if (size >= 4) {
+            uint32_t k;
+            std::memcpy(&k, p, 4);
+            h ^= static_cast<uint64_t>(k) * kPrime1;
+            h = rotl(h, 23) * kPrime2 + kPrime3;
+            p += 4;
+            size -= 4;
+        }
+        for (; size > 0; p++, size--) {
+            h ^= *p * kPrime5;
+            h = rotl(h, 11) * kPrime1;
+        }
+
+        h ^= h >> 33;
+        h *= kPrime2;
+        h ^= h >> 29;
+        h *= kPrime3;
+        h ^= h >> 32;
+        return h;
     }
 
-    int height = buf.shape[0];
-    int width = buf.shape[1];
-    int channels = buf.shape[2];
+private:
+    static constexpr uint64_t kPrime1 = 11400714785074694791ull;
+    static constexpr uint64_t kPrime2 = 14029467366897019727ull;
+    static constexpr uint64_t kPrime3 = 1609587929392839161ull;
+    static constexpr uint64_t kPrime4 = 9650029242287828579ull;
+    static constexpr uint64_t kPrime5 = 2870177450012600261ull;
 
-    if (channels != 3 && channels != 4) {
-        throw std::runtime_error("Image must have 3 (RGB) or 4 (RGBA) channels");
+    static uint64_t rotl(uint64_t v, int r) { return (v << r) | (v >> (64 - r)); }
+
+    static uint64_t read64(const uint8_t* p) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        return v;
     }
 
-    const uint8_t* src_data = static_cast<const uint8_t*>(buf.ptr);
+    static uint64_t round(uint64_t acc, uint64_t input) {
+        acc += input * kPrime2;
+        return rotl(acc, 31) * kPrime1;
+    }
 
-    std::vector<uint8_t> rgb_data;
-    if (channels == 4) {
-        rgb_data.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 3);
-        #pragma omp parallel for schedule(dynamic)
-        for (int i = 0; i < width * height; i++) {
-            rgb_data[i * 3] = src_data[i * 4];
-            rgb_data[i * 3 + 1] = src_data[i * 4 + 1];
-            rgb_data[i * 3 + 2] = src_data[i * 4 + 2];
+    void consume(const uint8_t* p) {
+        for (int i = 0; i < 4; i++) {
+            acc_[i] = round(acc_[i], read64(p + i * 8));
         }
-        src_data = rgb_data.data();
     }
 
-    std::vector<uint8_t> scaled_data(static_cast<size_t>(output_width) * static_cast<size_t>(output_height) * 3);
-    resize_image(src_data, width, height, scaled_data.data(), output_width, output_height);
+    uint64_t acc_[4];
+    uint64_t seed_;
+    uint64_t total_;
+    uint8_t buffer_[32];
+    size_t buffered_;
+};
 
-    std::vector<uint8_t> output_data(static_cast<size_t>(output_width) * static_cast<size_t>(output_height) * 3);
-    apply_lut_to_image(lut, scaled_data.data(), output_width, output_height, output_data.data());
+// ============================================================================
+// 数据结构定义
+// ============================================================================
 
-    std::vector<uint8_t> png_data;
-    write_png_to_buffer(output_data.data(), output_width, output_height, png_data);
+// 定点格点的缩放：输出值 1.0 对应 255 << kFixedShift，即每个 8 位输出码值保留 5 位小数
+const int kFixedShift = 5;
+const int kFixedScale = 255 << kFixedShift;
 
-    return py::bytes(reinterpret_cast<const char*>(png_data.data()), png_data.size());
+// .cube 规范允许的格点数上限：3D 每边最多 256，1D 最多 65536 项
+const int kMaxLut3DSize = 256;
+const int kMaxLut1DSize = 65536;
+
+inline int max_lut_size(bool is_3d) {
+    return is_3d ? kMaxLut3DSize : kMaxLut1DSize;
 }
 
-py::bytes generate_preview_from_array_impl(const std::string& lut_file_path,
-                                           py::array_t<uint8_t> image_array,
-                                           int output_width,
-                                           int output_height) {
-    init_crc_table();
+struct LUTData {
+    bool is_3d;
+    std::string title;
+    int size;
+    std::vector<float> data_3d;
+    std::vector<float> data_1d;
+    // 3D 格点的结构数组（SoA）副本：R、G、B 三个平面依次存放，每个平面按 64 字节对齐
+    AlignedVector<float> soa;
+    size_t plane_stride;
+    // 8 位输入专用的定点格点：每个格点按 RGBX 交错存放 4 个 int16（值 × kFixedScale），
+    // 一次 64 位 gather 即可取到三个通道；LUT 值超出 int16 可表示范围时为空，回退浮点内核
+    AlignedVector<int16_t> fixed;
+    // 每个 8 位输入值对应的格点下标（不超过 size - 2）与 Q15 小数权重
+    std::array<int32_t, 256> fixed_index;
+    std::array<int16_t, 256> fixed_frac;
+    // 插值内核实际读取的 SoA 平面与定点格点：自行构建时指向 soa/fixed，
+    // 由二进制缓存映射时直接指向映射内存（此时 data_3d/soa/fixed 为空，backing 保持映射存活）
+    const float* soa_data;
+    const int16_t* fixed_data;
+    std::shared_ptr<const void> backing;
+    // 维度与格点值的哈希（预览缓存键的一部分），构建表时计算一次，映射二进制缓存时从文件头读出
+    uint64_t content_hash;
 
-    LUTData lut;
-    if (!parse_cube_file(lut_file_path, lut)) {
-        throw std::runtime_error("Failed to parse LUT file: " + lut_file_path);
+    LUTData()
+        : is_3d(true), size(0), plane_stride(0), fixed_index(), fixed_frac(), soa_data(nullptr), fixed_data(nullptr),
+          content_hash(0) {}
+
+    // 视图指针指向自身缓冲区，禁止复制
+    LUTData(const LUTData&) = delete;
+    LUTData& operator=(const LUTData&) = delete;
+
+    const float* plane(int channel) const {
+        return soa_data + plane_stride * channel;
     }
 
-    py::buffer_info buf = image_array.request();
-    if (buf.ndim != 3) {
-        throw std::runtime_error("Image array must be 3D (height, width, channels)");
+    // 由 data_3d 生成 SoA 副本，供向量化插值按平面 gather
+    void build_soa() {
+        soa.clear();
+        soa_data = nullptr;
+        plane_stride = 0;
+        if (!is_3d || !is_valid()) return;
+        size_t count = static_cast<size_t>(size) * size * size;
+        plane_stride = (count + 15) / 16 * 16;
+        soa.assign(plane_stride * 3, 0.0f);
+        for (size_t i = 0; i < count; i++) {
+            soa[i] = data_3d[i * 3];
+            soa[plane_stride + i] = data_3d[i * 3 + 1];
+            soa[plane_stride * 2 + i] = data_3d[i * 3 + 2];
+        }
+        soa_data = soa.data();
     }
 
-    int height = buf.shape[0];
-    int width = buf.shape[1];
-    int channels = buf.shape[2];
+    // 由 data_3d 生成定点格点与逐字节下标/权重表
+    void build_fixed() {
+        fixed.clear();
+        fixed_data = nullptr;
+        if (!is_3d || !is_valid()) return;
 
-    if (channels != 3 && channels != 4) {
-        throw std::runtime_error("Image must have 3 (RGB) or 4 (RGBA) channels");
-    }
+        // 插值时相邻格点之差也要放得进 int16，留出舍入余量
+        auto range = std::minmax_element(data_3d.begin(), data_3d.end());
+        const float limit = 32000.0f / kFixedScale;
+        if (!(*range.first >= -limit && *range.second <= limit && *range.second - *range.first <= limit)) {
+            return;
+        }
 
-    const uint8_t* src_data = static_cast<const uint8_t*>(buf.ptr);
+        size_t count = static_cast<size_t>(size) * size * size;
+        fixed.assign(count * 4, 0);
+        for (size_t i = 0; i < count; i++) {
+            for (int c = 0; c < 3; c++) {
+                fixed[i * 4 + c] = static_cast<int16_t>(std::lround(data_3d[i * 3 + c] * kFixedScale));
+            }
+        }
+        fixed_data = fixed.data();
+        build_fixed_weights();
+    }
 
-    std::vector<uint8_t> rgb_data;
-    if (channels == 4) {
-        rgb_data.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 3);
-        #pragma omp parallel for schedule(dynamic)
-        for (int i = 0; i < width * height; i++) {
-            rgb_data[i * 3] = src_data[i * 4];
-            rgb_data[i * 3 + 1] = src_data[i * 4 + 1];
-            rgb_data[i * 3 + 2] = src_data[i * 4 + 2];
+    void build_fixed_weights() {
+        // v / 255 * (size - 1) 的整数部分与 Q15 小数部分；v = 255 时权重 1.0 取 32767，误差远小于 1 个码值
+        for (int v = 0; v < 256; v++) {
+            int t = v * (size - 1);
+            int i0 = std::min(t / 255, size - 2);
+            int rem = t - i0 * 255;
+            fixed_index[v] = i0;
+            fixed_frac[v] = static_cast<int16_t>(std::min(32767, (rem * 32768 + 127) / 255));
         }
-        src_data = rgb_data.data();
     }
 
-    std::vector<uint8_t> scaled_data(static_cast<size_t>(output_width) * static_cast<size_t>(output_height) * 3);
-    resize_image(src_data, width, height, scaled_data.data(), output_width, output_height);
+    void build_tables() {
+        build_soa();
+        build_fixed();
+        build_content_hash();
+    }
+
+    // 只取维度与格点值（3D 按 SoA 平面，与解析或映射无关），不含标题
+    void build_content_hash() {
+        XXH64 hash;
+        hash.update_value(static_cast<uint32_t>(is_3d));
+        hash.update_value(static_cast<uint32_t>(size));
+        if (is_3d) {
+            const size_t count = static_cast<size_t>(size) * size * size;
+            for (int c = 0; c < 3 && soa_data; c++) {
+                hash.update(plane(c), count * sizeof(float));
+            }
+        } else {
+            hash.update(data_1d.data(), data_1d.size() * sizeof(float));
+        }
+        content_hash = hash.digest();
+    }
 
-    std::vector<uint8_t> output_data(static_cast<size_t>(output_width) * static_cast<size_t>(output_height) * 3);
-    apply_lut_to_image(lut, scaled_data.data(), output_width, output_height, output_data.data());
+    bool has_fixed() const {
+        return fixed_data != nullptr;
+    }
 
-    std::vector<uint8_t> png_data;
-    write_png_to_buffer(output_data.data(), output_width, output_height, png_data);
+    bool is_mapped() const {
+        return backing != nullptr;
+    }
 
-    return py::bytes(reinterpret_cast<const char*>(png_data.data()), png_data.size());
-}
+    bool is_valid() const {
+        if (is_3d) {
+            const size_t count = static_cast<size_t>(size) * size * size;
+            return size > 0 && (data_3d.size() == count * 3 || (soa_data && plane_stride >= count));
+        } else {
+            return size > 0 && data_1d.size() == static_cast<size_t>(size) * 3;
+        }
+    }
+};
+
+// ============================================================================
+// DEFLATE 压缩与解压（zlib 流，RFC 1950/1951）
+// ============================================================================
+
+// 长度码 257..285 的基准长度与额外位数
+const uint16_t kLengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const uint8_t kLengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+// 距离码 0..29 的基准距离与额外位数
+const uint16_t kDistBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+const uint8_t kDistExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+// 码长码的传输顺序
+const uint8_t kCodeLengthOrder[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+inline int length_symbol(int length) {
+    static const std::array<uint8_t, 259> table = [] {
+        std::array<uint8_t, 259> t{};
+        for (int code = 0; code < 29; code++) {
+            int next = code < 28 ? kLengthBase[code + 1] : 259;
+            for (int len = kLengthBase[code]; len < next; len++) t[len] = static_cast<uint8_t>(code);
+        }
+        return t;
+    }();
+    return table[length];
+}
+
+inline int distance_symbol(int dist) {
+    // 距离 <= 256 直接查表，更大的距离按 128 分组查表
+    static const std::array<uint8_t, 512> table = [] {
+        std::array<uint8_t, 512> t{};
+        for (int code = 0; code < 30; code++) {
+            int next = code < 29 ? kDistBase[code + 1] : 32769;
+            for (int d = kDistBase[code]; d < next; d++) {
+                if (d <= 256) t[d - 1] = static_cast<uint8_t>(code);
+                else t[256 + ((d - 1) >> 7)] = static_cast<uint8_t>(code);
+            }
+        }
+        return t;
+    }();
+    return dist <= 256 ? table[dist - 1] : table[256 + ((dist - 1) >> 7)];
+}
+
+// 按频率构建长度受限的 Huffman 码长；超过上限时压缩频率后重建
+// 符号数不超过 286，工作区全部放在栈上，每个块编码时不做堆分配
+void build_huffman_lengths(const uint32_t* freqs, int count, int max_bits, uint8_t* lengths) {
+    const int kMaxSymbols = 286;
+    if (count > kMaxSymbols) {
+        throw std::runtime_error("Too many Huffman symbols");
+    }
+    uint32_t work[kMaxSymbols];
+    std::copy(freqs, freqs + count, work);
+    for (;;) {
+        std::fill(lengths, lengths + count, 0);
+
+        int symbols[kMaxSymbols];
+        int symbol_count = 0;
+        for (int i = 0; i < count; i++) {
+            if (work[i] > 0) symbols[symbol_count++] = i;
+        }
+        if (symbol_count == 0) return;
+        if (symbol_count == 1) {
+            lengths[symbols[0]] = 1;
+            return;
+        }
+
+        // 节点：叶子在前，内部节点追加在后
+        uint64_t weight[kMaxSymbols * 2];
+        int parent[kMaxSymbols * 2];
+        int node_count = 0;
+        for (int i = 0; i < symbol_count; i++) weight[node_count++] = work[symbols[i]];
+        std::fill(parent, parent + symbol_count * 2, -1);
+
+        using Node = std::pair<uint64_t, int>;
+        Node heap[kMaxSymbols];
+        int heap_size = 0;
+        for (int i = 0; i < symbol_count; i++) heap[heap_size++] = Node(weight[i], i);
+        auto cmp = [](const Node& a, const Node& b) { return a > b; };
+        std::make_heap(heap, heap + heap_size, cmp);
+
+        while (heap_size > 1) {
+            std::pop_heap(heap, heap + heap_size, cmp);
+            Node a = heap[--heap_size];
+            std::pop_heap(heap, heap + heap_size, cmp);
+            Node b = heap[--heap_size];
+            int id = node_count;
+            weight[node_count++] = a.first + b.first;
+            parent[a.second] = id;
+            parent[b.second] = id;
+            heap[heap_size++] = Node(a.first + b.first, id);
+            std::push_heap(heap, heap + heap_size, cmp);
+        }
+
+        // 自顶向下计算深度（内部节点编号单调递增）
+        int depth[kMaxSymbols * 2];
+        depth[node_count - 1] = 0;
+        for (int i = node_count - 2; i >= 0; i--) {
+            depth[i] = depth[parent[i]] + 1;
+        }
+
+        bool overflow = false;
+        for (int i = 0; i < symbol_count; i++) {
+            if (depth[i] > max_bits) overflow = true;
+            lengths[symbols[i]] = static_cast<uint8_t>(depth[i]);
+        }
+        if (!overflow) return;
+
+        for (int i = 0; i < symbol_count; i++) work[symbols[i]] = (work[symbols[i]] >> 1) | 1;
+    }
+}
+
+// 由码长生成规范 Huffman 码（已按位反转，便于 LSB 优先写出）
+void build_canonical_codes(const uint8_t* lengths, int count, uint16_t* codes) {
+    uint16_t bl_count[16] = {0};
+    for (int i = 0; i < count; i++) bl_count[lengths[i]]++;
+    bl_count[0] = 0;
+
+    uint16_t next_code[16] = {0};
+    uint16_t code = 0;
+    for (int bits = 1; bits < 16; bits++) {
+        code = static_cast<uint16_t>((code + bl_count[bits - 1]) << 1);
+        next_code[bits] = code;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int len = lengths[i];
+        if (len == 0) {
+            codes[i] = 0;
+            continue;
+        }
+        uint16_t c = next_code[len]++;
+        uint16_t rev = 0;
+        for (int b = 0; b < len; b++) {
+            rev = static_cast<uint16_t>((rev << 1) | ((c >> b) & 1));
+        }
+        codes[i] = rev;
+    }
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(ScratchVector<uint8_t>& out) : out_(out), bits_(0), count_(0) {}
+
+    void put(uint32_t value, int nbits) {
+        bits_ |= static_cast<uint64_t>(value) << count_;
+        count_ += nbits;
+        while (count_ >= 8) {
+            out_.push_back(static_cast<uint8_t>(bits_ & 0xFF));
+            bits_ >>= 8;
+            count_ -= 8;
+        }
+    }
+
+    void align_to_byte() {
+        if (count_ > 0) {
+            out_.push_back(static_cast<uint8_t>(bits_ & 0xFF));
+            bits_ = 0;
+            count_ = 0;
+        }
+    }
+
+private:
+    ScratchVector<uint8_t>& out_;
+    uint64_t bits_;
+    int count_;
+};
+
+// 流式 zlib 编码器：LZ77（哈希链 + 惰性匹配）+ 动态/固定 Huffman/存储块择优
+// 只保留 32KB 滑动窗口和当前块的输入，可逐行喂入数据
+class DeflateEncoder {
+public:
+    static const int kWindowSize = 32768;
+    static const int kWindowMask = kWindowSize - 1;
+    static const int kMinMatch = 3;
+    static const int kMaxMatch = 258;
+    static const int kHashBits = 15;
+    static const int kHashSize = 1 << kHashBits;
+    static const size_t kMaxBlockSymbols = 16384;
+
+    DeflateEncoder(ScratchVector<uint8_t>& out, int level)
+        : out_(out), writer_(out), level_(std::max(0, std::min(9, level))),
+          base_(0), pos_(0), block_start_(0), adler_a_(1), adler_b_(0) {
+        static const int kChain[10] = {0, 4, 8, 16, 32, 64, 128, 256, 1024, 4096};
+        static const int kNice[10] = {0, 8, 16, 32, 64, 128, 128, 258, 258, 258};
+        static const int kMaxInsert[10] = {0, 4, 5, 6, 258, 258, 258, 258, 258, 258};
+        max_chain_ = kChain[level_];
+        nice_length_ = kNice[level_];
+        max_insert_ = kMaxInsert[level_];
+        lazy_ = level_ >= 4;
+
+        out_.push_back(0x78);
+        out_.push_back(level_ == 0 ? 0x01 : (level_ < 6 ? 0x5E : (level_ == 6 ? 0x9C : 0xDA)));
+
+        if (level_ > 0) {
+            head_.assign(kHashSize, 0);
+            prev_.assign(kWindowSize, 0);
+            symbols_.reserve(kMaxBlockSymbols);
+        }
+    }
+
+    void write(const uint8_t* data, size_t len) {
+        update_adler(data, len);
+        buf_.insert(buf_.end(), data, data + len);
+        if (level_ == 0) {
+            while (buf_.size() - (block_start_ - base_) >= 65535) {
+                emit_stored(65535, false);
+            }
+            slide(block_start_);
+            return;
+        }
+        size_t end = base_ + buf_.size();
+        if (end - pos_ > static_cast<size_t>(kMaxMatch) + 65536) {
+            compress(end - kMaxMatch);
+        }
+    }
+
+    void finish() {
+        if (level_ == 0) {
+            emit_stored(buf_.size() - (block_start_ - base_), true);
+        } else {
+            compress(base_ + buf_.size());
+            flush_block(true);
+        }
+        writer_.align_to_byte();
+        uint32_t adler = (adler_b_ << 16) | adler_a_;
+        out_.push_back((adler >> 24) & 0xFF);
+        out_.push_back((adler >> 16) & 0xFF);
+        out_.push_back((adler >> 8) & 0xFF);
+        out_.push_back(adler & 0xFF);
+    }
+
+private:
+    struct Symbol {
+        uint16_t length;  // 0 表示字面量
+        uint16_t value;   // 字面量字节或匹配距离
+    };
+
+    void update_adler(const uint8_t* data, size_t len) {
+        while (len > 0) {
+            size_t n = std::min<size_t>(len, 5552);
+            for (size_t i = 0; i < n; i++) {
+                adler_a_ += data[i];
+                adler_b_ += adler_a_;
+            }
+            adler_a_ %= 65521;
+            adler_b_ %= 65521;
+            data += n;
+            len -= n;
+        }
+    }
+
+    inline uint8_t at(size_t abs_pos) const { return buf_[abs_pos - base_]; }
+
+    inline uint32_t hash_at(size_t abs_pos) const {
+        const uint8_t* p = &buf_[abs_pos - base_];
+        uint32_t v = (static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[2];
+        return (v * 2654435761u) >> (32 - kHashBits);
+    }
+
+    inline void insert_hash(size_t abs_pos) {
+        uint32_t h = hash_at(abs_pos);
+        prev_[abs_pos & kWindowMask] = head_[h];
+        head_[h] = static_cast<uint32_t>(abs_pos + 1);
+    }
+
+    // 在哈希链上寻找最长匹配，返回长度（< kMinMatch 表示无匹配）
+    int longest_match(size_t abs_pos, size_t end, int prev_length, int& best_dist) {
+        int max_len = static_cast<int>(std::min<size_t>(kMaxMatch, end - abs_pos));
+        if (max_len < kMinMatch || prev_length >= max_len) return 0;
+
+        int best_len = prev_length;
+        int chain = prev_length >= 32 ? max_chain_ >> 2 : max_chain_;
+        const uint8_t* cur = &buf_[abs_pos - base_];
+        uint32_t cand = head_[hash_at(abs_pos)];
+
+        while (cand > 0 && chain-- > 0) {
+            size_t cpos = static_cast<size_t>(cand - 1);
+            if (cpos >= abs_pos || abs_pos - cpos > static_cast<size_t>(kWindowSize) || cpos < base_) break;
+            const uint8_t* ref = &buf_[cpos - base_];
+            if (ref[best_len < max_len ? best_len : max_len - 1] == cur[best_len < max_len ? best_len : max_len - 1] &&
+                ref[0] == cur[0] && ref[1] == cur[1]) {
+                int len = 2;
+                while (len < max_len && ref[len] == cur[len]) len++;
+                if (len > best_len) {
+                    best_len = len;
+                    best_dist = static_cast<int>(abs_pos - cpos);
+                    if (len >= nice_length_) break;
+                }
+            }
+            uint32_t next = prev_[cpos & kWindowMask];
+            if (next >= cand) break;
+            cand = next;
+        }
+        return best_len > prev_length ? best_len : 0;
+    }
+
+    void push_literal(uint8_t byte) {
+        symbols_.push_back({0, byte});
+    }
+
+    void push_match(int length, int dist) {
+        symbols_.push_back({static_cast<uint16_t>(length), static_cast<uint16_t>(dist)});
+    }
+
+    // 压缩 [pos_, limit)，匹配可向后读取到缓冲末尾
+    void compress(size_t limit) {
+        size_t end = base_ + buf_.size();
+        while (pos_ < limit) {
+            if (end - pos_ < static_cast<size_t>(kMinMatch)) {
+                push_literal(at(pos_));
+                pos_++;
+            } else {
+                compress_step(end);
+            }
+            // 符号位置已推进后再切块，保证块边界与原始字节对齐
+            if (symbols_.size() >= kMaxBlockSymbols) flush_block(false);
+        }
+        slide(std::min(block_start_, pos_ > static_cast<size_t>(kWindowSize) ? pos_ - kWindowSize : 0));
+    }
+
+    // 在 pos_ 处输出一个字面量或匹配
+    void compress_step(size_t end) {
+        int dist = 0;
+        int len = longest_match(pos_, end, kMinMatch - 1, dist);
+        insert_hash(pos_);
+
+        if (len >= kMinMatch && lazy_ && len < nice_length_ && pos_ + 1 + kMinMatch <= end) {
+            int next_dist = 0;
+            int next_len = longest_match(pos_ + 1, end, len, next_dist);
+            if (next_len > len) {
+                push_literal(at(pos_));
+                pos_++;
+                insert_hash(pos_);
+                len = next_len;
+                dist = next_dist;
+            }
+        }
+
+        if (len >= kMinMatch) {
+            push_match(len, dist);
+            size_t match_end = pos_ + len;
+            // 低级别只为短匹配补全哈希链，换取速度
+            if (len <= max_insert_) {
+                for (size_t p = pos_ + 1; p < match_end && p + kMinMatch <= end; p++) {
+                    insert_hash(p);
+                }
+            }
+            pos_ = match_end;
+        } else {
+            push_literal(at(pos_));
+            pos_++;
+        }
+    }
+
+    // 丢弃 keep_from 之前的数据（窗口与未输出块之外）
+    void slide(size_t keep_from) {
+        if (keep_from <= base_) return;
+        size_t drop = keep_from - base_;
+        if (drop < 65536 && drop * 2 < buf_.size()) return;
+        buf_.erase(buf_.begin(), buf_.begin() + drop);
+        base_ = keep_from;
+    }
+
+    void emit_stored(size_t len, bool last) {
+        const uint8_t* data = buf_.data() + (block_start_ - base_);
+        do {
+            size_t n = std::min<size_t>(len, 65535);
+            bool final_block = last && n == len;
+            writer_.put(final_block ? 1 : 0, 3);
+            writer_.align_to_byte();
+            out_.push_back(n & 0xFF);
+            out_.push_back((n >> 8) & 0xFF);
+            out_.push_back((~n) & 0xFF);
+            out_.push_back((~n >> 8) & 0xFF);
+            out_.insert(out_.end(), data, data + n);
+            data += n;
+            len -= n;
+            block_start_ += n;
+        } while (len > 0);
+    }
+
+    void flush_block(bool last) {
+        uint32_t lit_freq[286] = {0};
+        uint32_t dist_freq[30] = {0};
+        for (const Symbol& s : symbols_) {
+            if (s.length == 0) {
+                lit_freq[s.value]++;
+            } else {
+                lit_freq[257 + length_symbol(s.length)]++;
+                dist_freq[distance_symbol(s.value)]++;
+            }
+        }
+        lit_freq[256] = 1;
+
+        uint8_t lit_len[286];
+        uint8_t dist_len[30];
+        build_huffman_lengths(lit_freq, 286, 15, lit_len);
+        build_huffman_lengths(dist_freq, 30, 15, dist_len);
+        // 至少保留一个距离码，避免解码器拒绝空距离树
+        bool any_dist = false;
+        for (int i = 0; i < 30; i++) any_dist = any_dist || dist_len[i] > 0;
+        if (!any_dist) dist_len[0] = 1;
+
+        int hlit = 286;
+        while (hlit > 257 && lit_len[hlit - 1] == 0) hlit--;
+        int hdist = 30;
+        while (hdist > 1 && dist_len[hdist - 1] == 0) hdist--;
+
+        // 码长序列游程编码（16/17/18）
+        uint8_t all_lens[286 + 30];
+        const size_t lens_count = static_cast<size_t>(hlit + hdist);
+        std::copy(lit_len, lit_len + hlit, all_lens);
+        std::copy(dist_len, dist_len + hdist, all_lens + hlit);
+        std::pair<uint8_t, uint8_t> cl_symbols[286 + 30];
+        size_t cl_count = 0;
+        uint32_t cl_freq[19] = {0};
+        for (size_t i = 0; i < lens_count;) {
+            uint8_t v = all_lens[i];
+            size_t run = 1;
+            while (i + run < lens_count && all_lens[i + run] == v) run++;
+            size_t left = run;
+            if (v == 0) {
+                while (left >= 11) {
+                    size_t n = std::min<size_t>(left, 138);
+                    cl_symbols[cl_count++] = {18, static_cast<uint8_t>(n - 11)};
+                    cl_freq[18]++;
+                    left -= n;
+                }
+                if (left >= 3) {
+                    cl_symbols[cl_count++] = {17, static_cast<uint8_t>(left - 3)};
+                    cl_freq[17]++;
+                    left = 0;
+                }
+            } else if (left >= 4) {
+                cl_symbols[cl_count++] = {v, 0};
+                cl_freq[v]++;
+                left--;
+                while (left >= 3) {
+                    size_t n = std::min<size_t>(left, 6);
+                    cl_symbols[cl_count++] = {16, static_cast<uint8_t>(n - 3)};
+                    cl_freq[16]++;
+                    left -= n;
+                }
+            }
+            while (left > 0) {
+                cl_symbols[cl_count++] = {v, 0};
+                cl_freq[v]++;
+                left--;
+            }
+            i += run;
+        }
+
+        // 码长码树至少需要两个码字，否则 inflate 视为不完整
+        int cl_used = 0;
+        for (int i = 0; i < 19; i++) cl_used += cl_freq[i] > 0;
+        if (cl_used < 2) cl_freq[cl_freq[0] > 0 ? 1 : 0] = 1;
+
+        uint8_t cl_len[19];
+        build_huffman_lengths(cl_freq, 19, 7, cl_len);
+        int hclen = 19;
+        while (hclen > 4 && cl_len[kCodeLengthOrder[hclen - 1]] == 0) hclen--;
+
+        // 估算三种块类型的位数，择优输出
+        uint64_t dynamic_bits = 14 + 3 * static_cast<uint64_t>(hclen);
+        for (size_t i = 0; i < cl_count; i++) {
+            const auto& cs = cl_symbols[i];
+            dynamic_bits += cl_len[cs.first];
+            dynamic_bits += cs.first == 16 ? 2 : (cs.first == 17 ? 3 : (cs.first == 18 ? 7 : 0));
+        }
+        uint64_t fixed_bits = 0;
+        for (int i = 0; i < 286; i++) {
+            uint64_t extra = i >= 257 ? kLengthExtra[i - 257] : 0;
+            dynamic_bits += static_cast<uint64_t>(lit_freq[i]) * (lit_len[i] + extra);
+            fixed_bits += static_cast<uint64_t>(lit_freq[i]) * ((i < 144 ? 8 : (i < 256 ? 9 : (i < 280 ? 7 : 8))) + extra);
+        }
+        for (int i = 0; i < 30; i++) {
+            dynamic_bits += static_cast<uint64_t>(dist_freq[i]) * (dist_len[i] + kDistExtra[i]);
+            fixed_bits += static_cast<uint64_t>(dist_freq[i]) * (5 + kDistExtra[i]);
+        }
+        size_t raw_len = pos_ - block_start_;
+        uint64_t stored_bits = (static_cast<uint64_t>(raw_len) + 5 * (raw_len / 65535 + 1)) * 8;
+
+        if (stored_bits < dynamic_bits && stored_bits < fixed_bits) {
+            emit_stored(raw_len, last);
+        } else if (fixed_bits <= dynamic_bits) {
+            uint8_t fl[286];
+            uint8_t fd[30];
+            for (int i = 0; i < 286; i++) fl[i] = i < 144 ? 8 : (i < 256 ? 9 : (i < 280 ? 7 : 8));
+            std::fill(fd, fd + 30, 5);
+            writer_.put(last ? 1 : 0, 1);
+            writer_.put(1, 2);
+            emit_symbols(fl, fd);
+        } else {
+            uint16_t cl_codes[19];
+            build_canonical_codes(cl_len, 19, cl_codes);
+            writer_.put(last ? 1 : 0, 1);
+            writer_.put(2, 2);
+            writer_.put(hlit - 257, 5);
+            writer_.put(hdist - 1, 5);
+            writer_.put(hclen - 4, 4);
+            for (int i = 0; i < hclen; i++) writer_.put(cl_len[kCodeLengthOrder[i]], 3);
+            for (size_t i = 0; i < cl_count; i++) {
+                const auto& cs = cl_symbols[i];
+                writer_.put(cl_codes[cs.first], cl_len[cs.first]);
+                if (cs.first == 16) writer_.put(cs.second, 2);
+                else if (cs.first == 17) writer_.put(cs.second, 3);
+                else if (cs.first == 18) writer_.put(cs.second, 7);
+            }
+            emit_symbols(lit_len, dist_len);
+        }
+
+        symbols_.clear();
+        block_start_ = pos_;
+    }
+
+    void emit_symbols(const uint8_t* lit_len, const uint8_t* dist_len) {
+        uint16_t lit_codes[286];
+        uint16_t dist_codes[30];
+        build_canonical_codes(lit_len, 286, lit_codes);
+        build_canonical_codes(dist_len, 30, dist_codes);
+
+        for (const Symbol& s : symbols_) {
+            if (s.length == 0) {
+                writer_.put(lit_codes[s.value], lit_len[s.value]);
+                continue;
+            }
+            int lc = length_symbol(s.length);
+            writer_.put(lit_codes[257 + lc], lit_len[257 + lc]);
+            if (kLengthExtra[lc]) writer_.put(s.length - kLengthBase[lc], kLengthExtra[lc]);
+            int dc = distance_symbol(s.value);
+            writer_.put(dist_codes[dc], dist_len[dc]);
+            if (kDistExtra[dc]) writer_.put(s.value - kDistBase[dc], kDistExtra[dc]);
+        }
+        writer_.put(lit_codes[256], lit_len[256]);
+    }
+
+    ScratchVector<uint8_t>& out_;
+    BitWriter writer_;
+    int level_;
+    int max_chain_;
+    int nice_length_;
+    int max_insert_;
+    bool lazy_;
+
+    ScratchVector<uint8_t> buf_;     // 输入缓冲，buf_[0] 对应绝对位置 base_
+    size_t base_;
+    size_t pos_;                   // 下一个待压缩的绝对位置
+    size_t block_start_;           // 当前块的起始绝对位置
+    ScratchVector<uint32_t> head_;   // 哈希桶 -> 最近位置 + 1（单帧不超过 4GB）
+    ScratchVector<uint32_t> prev_;   // 位置 -> 链上前一位置 + 1
+    ScratchVector<Symbol> symbols_;
+
+    uint32_t adler_a_;
+    uint32_t adler_b_;
+};
+
+// LSB 优先的位读取器；读过输入末尾时补零并记下越界，由调用方在解码结束后检查
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : p_(data), end_(data + size), bits_(0), count_(0), padding_(0) {}
+
+    uint32_t peek(int nbits) {
+        if (count_ < nbits) refill();
+        return static_cast<uint32_t>(bits_ & ((uint64_t(1) << nbits) - 1));
+    }
+
+    void consume(int nbits) {
+        bits_ >>= nbits;
+        count_ -= nbits;
+    }
+
+    uint32_t get(int nbits) {
+        uint32_t value = peek(nbits);
+        consume(nbits);
+        return value;
+    }
+
+    // 缓冲中总是整字节补入，丢弃不足一字节的部分即回到字节边界
+    void align_to_byte() {
+        consume(count_ & 7);
+    }
+
+    bool overrun() const {
+        return padding_ * 8 > static_cast<size_t>(count_);
+    }
+
+private:
+    void refill() {
+        while (count_ <= 56) {
+            uint64_t byte = 0;
+            if (p_ < end_) {
+                byte = *p_++;
+            } else {
+                padding_++;
+            }
+            bits_ |= byte << count_;
+            count_ += 8;
+        }
+    }
+
+    const uint8_t* p_;
+    const uint8_t* end_;
+    uint64_t bits_;
+    int count_;
+    size_t padding_;
+};
+
+// 规范 Huffman 解码表：不超过 kFastBits 位的码字一次查表，更长的码字按码长逐位比较
+class HuffmanDecoder {
+public:
+    static const int kFastBits = 10;
+
+    // 码长过度分配时返回 false；不完整的码（如只有一个距离码）允许
+    bool build(const uint8_t* lengths, int count) {
+        std::fill(std::begin(counts_), std::end(counts_), 0);
+        for (int i = 0; i < count; i++) counts_[lengths[i]]++;
+        counts_[0] = 0;
+        int left = 1;
+        for (int len = 1; len < 16; len++) {
+            left = (left << 1) - counts_[len];
+            if (left < 0) return false;
+        }
+
+        uint16_t offsets[16];
+        offsets[1] = 0;
+        for (int len = 1; len < 15; len++) offsets[len + 1] = static_cast<uint16_t>(offsets[len] + counts_[len]);
+        for (int i = 0; i < count; i++) {
+            if (lengths[i] != 0) symbols_[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+        }
+
+        uint16_t codes[288];
+        build_canonical_codes(lengths, count, codes);
+        std::fill(std::begin(fast_), std::end(fast_), 0);
+        for (int i = 0; i < count; i++) {
+            const int len = lengths[i];
+            if (len == 0 || len > kFastBits) continue;
+            for (int j = codes[i]; j < (1 << kFastBits); j += 1 << len) {
+                fast_[j] = static_cast<uint16_t>((i << 4) | len);
+            }
+        }
+        return true;
+    }
+
+    // 返回符号，码字不存在时返回 -1
+    int decode(BitReader& in) const {
+        const uint32_t bits = in.peek(15);
+        const uint16_t entry = fast_[bits & ((1u << kFastBits) - 1)];
+        if (entry != 0) {
+            in.consume(entry & 15);
+            return entry >> 4;
+        }
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (int len = 1; len < 16; len++) {
+            code |= (bits >> (len - 1)) & 1;
+            const int n = counts_[len];
+            if (code - first < n) {
+                in.consume(len);
+                return symbols_[index + code - first];
+            }
+            index += n;
+            first = (first + n) << 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+private:
+    uint16_t fast_[1 << kFastBits];  // (符号 << 4) | 码长，0 表示需要逐位解码
+    uint16_t counts_[16];
+    uint16_t symbols_[288];
+};
+
+// 把 zlib 流解压到长度恰为 out_size 的缓冲区；流损坏、长度不符或 Adler-32 校验失败时返回 false
+bool inflate_zlib(const uint8_t* data, size_t size, uint8_t* out, size_t out_size) {
+    if (size < 6 || (data[0] & 0x0F) != 8 || (data[0] >> 4) > 7 || ((data[0] << 8) | data[1]) % 31 != 0 ||
+        (data[1] & 0x20) != 0) {
+        return false;
+    }
+    BitReader in(data + 2, size - 6);
+    size_t pos = 0;
+    HuffmanDecoder lit;
+    HuffmanDecoder dist;
+    bool last = false;
+    while (!last) {
+        last = in.get(1) != 0;
+        const uint32_t type = in.get(2);
+        if (type == 0) {
+            in.align_to_byte();
+            const uint32_t len = in.get(16);
+            const uint32_t nlen = in.get(16);
+            if ((len ^ 0xFFFF) != nlen || len > out_size - pos) return false;
+            for (uint32_t i = 0; i < len; i++) out[pos++] = static_cast<uint8_t>(in.get(8));
+            if (in.overrun()) return false;
+            continue;
+        }
+
+        uint8_t lengths[286 + 30];
+        if (type == 1) {
+            for (int i = 0; i < 286; i++) lengths[i] = i < 144 ? 8 : (i < 256 ? 9 : (i < 280 ? 7 : 8));
+            std::fill(lengths + 286, lengths + 316, 5);
+            if (!lit.build(lengths, 286) || !dist.build(lengths + 286, 30)) return false;
+        } else if (type == 2) {
+            const int hlit = static_cast<int>(in.get(5)) + 257;
+            const int hdist = static_cast<int>(in.get(5)) + 1;
+            const int hclen = static_cast<int>(in.get(4)) + 4;
+            if (hlit > 286 || hdist > 30) return false;
+            uint8_t cl_len[19] = {0};
+            for (int i = 0; i < hclen; i++) cl_len[kCodeLengthOrder[i]] = static_cast<uint8_t>(in.get(3));
+            HuffmanDecoder cl;
+            if (!cl.build(cl_len, 19)) return false;
+            for (int i = 0; i < hlit + hdist;) {
+                const int sym = cl.decode(in);
+                if (sym < 0) return false;
+                if (sym < 16) {
+                    lengths[i++] = static_cast<uint8_t>(sym);
+                    continue;
+                }
+                uint8_t value = 0;
+                int repeat;
+                if (sym == 16) {
+                    if (i == 0) return false;
+                    value = lengths[i - 1];
+                    repeat = 3 + static_cast<int>(in.get(2));
+                } else if (sym == 17) {
+                    repeat = 3 + static_cast<int>(in.get(3));
+                } else {
+                    repeat = 11 + static_cast<int>(in.get(7));
+                }
+                if (i + repeat > hlit + hdist) return false;
+                std::fill(lengths + i, lengths + i + repeat, value);
+                i += repeat;
+            }
+            if (lengths[256] == 0 || !lit.build(lengths, hlit) || !dist.build(lengths + hlit, hdist)) return false;
+        } else {
+            return false;
+        }
+
+        for (;;) {
+            const int sym = lit.decode(in);
+            if (sym < 0) return false;
+            if (sym < 256) {
+                if (pos == out_size) return false;
+                out[pos++] = static_cast<uint8_t>(sym);
+                continue;
+            }
+            if (sym == 256) break;
+            const int lc = sym - 257;
+            if (lc >= 29) return false;
+            const size_t length = kLengthBase[lc] + in.get(kLengthExtra[lc]);
+            const int dc = dist.decode(in);
+            if (dc < 0 || dc >= 30) return false;
+            const size_t distance = kDistBase[dc] + in.get(kDistExtra[dc]);
+            if (distance > pos || length > out_size - pos) return false;
+            const uint8_t* from = out + pos - distance;
+            for (size_t i = 0; i < length; i++) out[pos + i] = from[i];
+            pos += length;
+        }
+        if (in.overrun()) return false;
+    }
+    if (in.overrun() || pos != out_size) return false;
+
+    uint32_t a = 1;
+    uint32_t b = 0;
+    for (size_t i = 0; i < out_size;) {
+        const size_t n = std::min<size_t>(out_size - i, 5552);
+        for (size_t j = 0; j < n; j++) {
+            a += out[i + j];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        i += n;
+    }
+    const uint8_t* trailer = data + size - 4;
+    const uint32_t adler = (uint32_t(trailer[0]) << 24) | (uint32_t(trailer[1]) << 16) |
+                           (uint32_t(trailer[2]) << 8) | trailer[3];
+    return adler == ((b << 16) | a);
+}
+
+// ============================================================================
+// PNG 编码
+// ============================================================================
+
+void write_chunk(ScratchVector<uint8_t>& buffer, const char* type, const uint8_t* data, size_t size) {
+    uint32_t length = static_cast<uint32_t>(size);
+
+    // 写入长度
+    buffer.push_back((length >> 24) & 0xFF);
+    buffer.push_back((length >> 16) & 0xFF);
+    buffer.push_back((length >> 8) & 0xFF);
+    buffer.push_back(length & 0xFF);
+
+    // 写入类型
+    buffer.insert(buffer.end(), type, type + 4);
+
+    // 写入数据
+    if (size > 0) {
+        buffer.insert(buffer.end(), data, data + size);
+    }
+
+    // 计算并写入 CRC（包括 type 和 data）
+    uint32_t crc = get_chunk_crc(type, data, size);
+    buffer.push_back((crc >> 24) & 0xFF);
+    buffer.push_back((crc >> 16) & 0xFF);
+    buffer.push_back((crc >> 8) & 0xFF);
+    buffer.push_back(crc & 0xFF);
+}
+
+inline uint8_t paeth_predictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return static_cast<uint8_t>(a);
+    if (pb <= pc) return static_cast<uint8_t>(b);
+    return static_cast<uint8_t>(c);
+}
+
+// PNG 逐行滤波：每行按最小绝对差之和（MSAD）启发式在 5 种滤波器中择优，只保留上一行。
+// 输出行首字节为滤波类型，共 row_bytes + 1 字节；PNG 编码与预览缓存的磁盘条目共用
+class PngRowFilter {
+public:
+    PngRowFilter(int width, int channels)
+        : channels_(channels), row_bytes_(static_cast<size_t>(width) * channels) {
+        prev_row_.assign(row_bytes_, 0);
+        for (int f = 0; f < 5; f++) candidates_[f].resize(row_bytes_ + 1);
+    }
+
+    // adaptive 为 false 时不滤波（类型 0），供不压缩的级别使用
+    const uint8_t* filter(const uint8_t* row, bool adaptive) {
+        int best = 0;
+        if (!adaptive) {
+            uint8_t* out = candidates_[0].data();
+            out[0] = 0;
+            std::memcpy(out + 1, row, row_bytes_);
+        } else {
+            best = filter_row(row);
+        }
+        std::memcpy(prev_row_.data(), row, row_bytes_);
+        return candidates_[best].data();
+    }
+
+    size_t filtered_bytes() const {
+        return row_bytes_ + 1;
+    }
+
+private:
+    // 一次遍历生成 5 种滤波结果（首字节为滤波类型），返回 MSAD 评分最低者
+    int filter_row(const uint8_t* row) {
+        const uint8_t* up = prev_row_.data();
+        const size_t bpp = static_cast<size_t>(channels_);
+        uint8_t* out[5];
+        for (int f = 0; f < 5; f++) {
+            out[f] = candidates_[f].data() + 1;
+            candidates_[f][0] = static_cast<uint8_t>(f);
+        }
+
+        uint64_t score[5] = {0, 0, 0, 0, 0};
+        for (size_t i = 0; i < row_bytes_; i++) {
+            int x = row[i];
+            int a = i >= bpp ? row[i - bpp] : 0;
+            int b = up[i];
+            int c = i >= bpp ? up[i - bpp] : 0;
+            uint8_t v0 = static_cast<uint8_t>(x);
+            uint8_t v1 = static_cast<uint8_t>(x - a);
+            uint8_t v2 = static_cast<uint8_t>(x - b);
+            uint8_t v3 = static_cast<uint8_t>(x - ((a + b) >> 1));
+            uint8_t v4 = static_cast<uint8_t>(x - paeth_predictor(a, b, c));
+            out[0][i] = v0;
+            out[1][i] = v1;
+            out[2][i] = v2;
+            out[3][i] = v3;
+            out[4][i] = v4;
+            score[0] += static_cast<int8_t>(v0) < 0 ? 256 - v0 : v0;
+            score[1] += static_cast<int8_t>(v1) < 0 ? 256 - v1 : v1;
+            score[2] += static_cast<int8_t>(v2) < 0 ? 256 - v2 : v2;
+            score[3] += static_cast<int8_t>(v3) < 0 ? 256 - v3 : v3;
+            score[4] += static_cast<int8_t>(v4) < 0 ? 256 - v4 : v4;
+        }
+
+        int best = 0;
+        for (int f = 1; f < 5; f++) {
+            if (score[f] < score[best]) best = f;
+        }
+        return best;
+    }
+
+    int channels_;
+    size_t row_bytes_;
+    ScratchVector<uint8_t> prev_row_;
+    ScratchVector<uint8_t> candidates_[5];
+};
+
+// 还原一行滤波结果（filtered 首字节为滤波类型），prev 为上一行的还原结果，首行传全零行；
+// 滤波类型非法时返回 false
+bool unfilter_png_row(const uint8_t* filtered, const uint8_t* prev, uint8_t* row, size_t row_bytes, size_t bpp) {
+    const uint8_t type = filtered[0];
+    const uint8_t* in = filtered + 1;
+    switch (type) {
+        case 0:
+            std::memcpy(row, in, row_bytes);
+            return true;
+        case 1:
+            for (size_t i = 0; i < row_bytes; i++) {
+                row[i] = static_cast<uint8_t>(in[i] + (i >= bpp ? row[i - bpp] : 0));
+            }
+            return true;
+        case 2:
+            for (size_t i = 0; i < row_bytes; i++) row[i] = static_cast<uint8_t>(in[i] + prev[i]);
+            return true;
+        case 3:
+            for (size_t i = 0; i < row_bytes; i++) {
+                int a = i >= bpp ? row[i - bpp] : 0;
+                row[i] = static_cast<uint8_t>(in[i] + ((a + prev[i]) >> 1));
+            }
+            return true;
+        case 4:
+            for (size_t i = 0; i < row_bytes; i++) {
+                int a = i >= bpp ? row[i - bpp] : 0;
+                int c = i >= bpp ? prev[i - bpp] : 0;
+                row[i] = static_cast<uint8_t>(in[i] + paeth_predictor(a, prev[i], c));
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+// 逐行 PNG 编码器：行滤波交给 PngRowFilter，压缩结果按块写出 IDAT，只保留上一行和压缩器窗口
+class PngEncoder {
+public:
+    PngEncoder(ScratchVector<uint8_t>& buffer, int width, int height, int channels, int level)
+        : buffer_(buffer), width_(width), height_(height), channels_(channels), level_(level),
+          filter_(width, channels), deflate_(compressed_, level) {
+        const uint8_t png_signature[] = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+        buffer_.insert(buffer_.end(), png_signature, png_signature + 8);
+
+        uint8_t ihdr_data[13];
+        ihdr_data[0] = (width >> 24) & 0xFF;
+        ihdr_data[1] = (width >> 16) & 0xFF;
+        ihdr_data[2] = (width >> 8) & 0xFF;
+        ihdr_data[3] = width & 0xFF;
+        ihdr_data[4] = (height >> 24) & 0xFF;
+        ihdr_data[5] = (height >> 16) & 0xFF;
+        ihdr_data[6] = (height >> 8) & 0xFF;
+        ihdr_data[7] = height & 0xFF;
+        ihdr_data[8] = 8;
+        ihdr_data[9] = channels == 4 ? 6 : 2;
+        ihdr_data[10] = 0;
+        ihdr_data[11] = 0;
+        ihdr_data[12] = 0;
+        write_chunk(buffer_, "IHDR", ihdr_data, sizeof(ihdr_data));
+    }
+
+    void write_row(const uint8_t* row) {
+        deflate_.write(filter_.filter(row, level_ > 0), filter_.filtered_bytes());
+        flush_idat(false);
+    }
+
+    void finish() {
+        deflate_.finish();
+        flush_idat(true);
+        write_chunk(buffer_, "IEND", nullptr, 0);
+    }
+
+private:
+    void flush_idat(bool force) {
+        const size_t kIdatChunkSize = 65536;
+        while (compressed_.size() >= kIdatChunkSize || (force && !compressed_.empty())) {
+            size_t n = std::min(compressed_.size(), kIdatChunkSize);
+            write_chunk(buffer_, "IDAT", compressed_.data(), n);
+            compressed_.erase(compressed_.begin(), compressed_.begin() + n);
+        }
+    }
+
+    ScratchVector<uint8_t>& buffer_;
+    int width_;
+    int height_;
+    int channels_;
+    int level_;
+    PngRowFilter filter_;
+    ScratchVector<uint8_t> compressed_;
+    DeflateEncoder deflate_;
+};
+
+void write_png_to_buffer(const uint8_t* image_data, int width, int height,
+                         ScratchVector<uint8_t>& buffer, int channels = 3, int level = 6) {
+    PngEncoder encoder(buffer, width, height, channels, level);
+    size_t row_bytes = static_cast<size_t>(width) * channels;
+    for (int y = 0; y < height; y++) {
+        encoder.write_row(image_data + y * row_bytes);
+    }
+    encoder.finish();
+}
+
+// ============================================================================
+// LUT 解析器
+// ============================================================================
+
+// 只读内存映射文件，映射失败时回退为一次性读入
+class MappedFile {
+public:
+    // sequential 为 false 时按随机访问提示内核（二进制 LUT 缓存按格点查表，而非顺序扫描）
+    explicit MappedFile(const std::string& file_path, bool sequential = true) : data_(nullptr), size_(0) {
+#ifdef _WIN32
+        file_ = INVALID_HANDLE_VALUE;
+        mapping_ = nullptr;
+        std::wstring wide_path = fs::u8path(file_path).wstring();
+        file_ = CreateFileW(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | (sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS),
+                            nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file_, &file_size)) return;
+        size_ = static_cast<size_t>(file_size.QuadPart);
+        if (size_ == 0) {
+            data_ = "";
+            return;
+        }
+        mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_) {
+            data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        }
+#else
+        fd_ = ::open(fs::u8path(file_path).c_str(), O_RDONLY);
+        if (fd_ < 0) return;
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) return;
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ == 0) {
+            data_ = "";
+            return;
+        }
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (p != MAP_FAILED) {
+            data_ = static_cast<const char*>(p);
+            ::madvise(p, size_, sequential ? MADV_SEQUENTIAL : MADV_WILLNEED);
+        }
+#endif
+        if (!data_) {
+            // 映射失败（如特殊文件系统），退回普通读取
+            std::ifstream file(fs::u8path(file_path), std::ios::binary);
+            if (!file.is_open()) return;
+            fallback_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            data_ = fallback_.data();
+            size_ = fallback_.size();
+        }
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data_ && fallback_.empty() && size_ > 0) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+#else
+        if (data_ && fallback_.empty() && size_ > 0) ::munmap(const_cast<char*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool is_open() const { return data_ != nullptr; }
+    bool is_mapped() const { return data_ != nullptr && fallback_.empty() && size_ > 0; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+    std::string fallback_;
+#ifdef _WIN32
+    HANDLE file_;
+    HANDLE mapping_;
+#else
+    int fd_ = -1;
+#endif
+};
+
+inline bool is_cube_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+inline void skip_spaces(const char*& p, const char* end) {
+    while (p < end && is_cube_space(*p)) p++;
+}
+
+// 浮点 std::from_chars 在 GCC 11 之前与 Apple libc++ 上不可用，以 __cpp_lib_to_chars 区分；
+// 回退实现不走 strtof，避免宿主进程（如 Qt 调用 setlocale）把小数点换成逗号时解析出错
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define LUT_HAS_FLOAT_FROM_CHARS 1
+#endif
+
+#ifndef LUT_HAS_FLOAT_FROM_CHARS
+// 与区域设置无关的十进制浮点解析：[-]digits[.digits][(e|E)[+-]digits]
+// 有效数字最多累积 19 位，再按 10 的幂缩放，误差远小于 float 精度
+inline bool parse_decimal_float(const char*& p, const char* end, float& value) {
+    static const double kPow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+    const char* q = p;
+    const bool negative = q < end && *q == '-';
+    if (negative) q++;
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any_digit = false;
+    for (; q < end && *q >= '0' && *q <= '9'; q++) {
+        any_digit = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*q - '0');
+            if (mantissa != 0) digits++;
+        } else {
+            exponent++;
+        }
+    }
+    if (q < end && *q == '.') {
+        for (q++; q < end && *q >= '0' && *q <= '9'; q++) {
+            any_digit = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*q - '0');
+                if (mantissa != 0) digits++;
+                exponent--;
+            }
+        }
+    }
+    if (!any_digit) return false;
+
+    if (q < end && (*q == 'e' || *q == 'E')) {
+        const char* e = q + 1;
+        bool exp_negative = false;
+        if (e < end && (*e == '+' || *e == '-')) exp_negative = *e++ == '-';
+        if (e < end && *e >= '0' && *e <= '9') {
+            int exp_value = 0;
+            for (; e < end && *e >= '0' && *e <= '9'; e++) {
+                if (exp_value < 100000) exp_value = exp_value * 10 + (*e - '0');
+            }
+            exponent += exp_negative ? -exp_value : exp_value;
+            q = e;
+        }
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (mantissa != 0 && exponent != 0) {
+        if (exponent < 0 && exponent >= -22) {
+            result /= kPow10[-exponent];
+        } else if (exponent > 0 && exponent <= 22) {
+            result *= kPow10[exponent];
+        } else {
+            result *= std::pow(10.0, static_cast<double>(exponent));
+        }
+    }
+    if (!std::isfinite(result) || result > static_cast<double>(std::numeric_limits<float>::max())) return false;
+    value = static_cast<float>(negative ? -result : result);
+    p = q;
+    return true;
+}
+#endif
+
+// 解析一个浮点数（允许前导 '+'），成功时推进 p
+inline bool parse_cube_float(const char*& p, const char* end, float& value) {
+    skip_spaces(p, end);
+    if (p < end && *p == '+') p++;
+#ifdef LUT_HAS_FLOAT_FROM_CHARS
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+#else
+    return parse_decimal_float(p, end, value);
+#endif
+}
+
+inline bool parse_cube_int(std::string_view text, int& value) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    skip_spaces(p, end);
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    skip_spaces(p, end);
+    return p == end;
+}
+
+[[noreturn]] void throw_cube_error(size_t line_number, const std::string& message) {
+    throw std::runtime_error("LUT parse error at line " + std::to_string(line_number) + ": " + message);
+}
+
+// 单遍扫描连续缓冲区解析 .cube，不为每行分配内存；格式错误时抛出带行号的异常
+bool parse_cube_buffer(const char* data, size_t size, LUTData& lut) {
+    lut.is_3d = true;
+    lut.size = 0;
+    lut.title.clear();
+    lut.data_3d.clear();
+    lut.data_1d.clear();
+
+    const char* p = data;
+    const char* const end = data + size;
+    if (size >= 3 && static_cast<uint8_t>(p[0]) == 0xEF && static_cast<uint8_t>(p[1]) == 0xBB &&
+        static_cast<uint8_t>(p[2]) == 0xBF) {
+        p += 3;
+    }
+
+    std::vector<float>* target = &lut.data_3d;
+    size_t expected = 0;
+    size_t line_number = 0;
+
+    while (p < end) {
+        line_number++;
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!line_end) line_end = end;
+        const char* next_line = line_end < end ? line_end + 1 : end;
+
+        // trim
+        skip_spaces(p, line_end);
+        const char* q = line_end;
+        while (q > p && is_cube_space(q[-1])) q--;
+        std::string_view line(p, q - p);
+        p = next_line;
+
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        char first = line[0];
+        bool is_number = (first >= '0' && first <= '9') || first == '-' || first == '+' || first == '.';
+        if (!is_number) {
+            size_t key_end = 0;
+            while (key_end < line.size() && !is_cube_space(line[key_end])) key_end++;
+            std::string_view keyword = line.substr(0, key_end);
+            std::string_view rest = line.substr(key_end);
+
+            if (keyword == "TITLE") {
+                size_t pos1 = rest.find('"');
+                size_t pos2 = pos1 == std::string_view::npos ? pos1 : rest.find('"', pos1 + 1);
+                if (pos1 != std::string_view::npos && pos2 != std::string_view::npos) {
+                    lut.title.assign(rest.substr(pos1 + 1, pos2 - pos1 - 1));
+                }
+            } else if (keyword == "LUT_3D_SIZE" || keyword == "LUT_1D_SIZE") {
+                if (!target->empty()) {
+                    throw_cube_error(line_number, "size declared after table data");
+                }
+                const bool is_3d = keyword == "LUT_3D_SIZE";
+                int declared = 0;
+                if (!parse_cube_int(rest, declared) || declared < 2 || declared > max_lut_size(is_3d)) {
+                    throw_cube_error(line_number, "invalid " + std::string(keyword) + " value");
+                }
+                lut.size = declared;
+                lut.is_3d = is_3d;
+                target = lut.is_3d ? &lut.data_3d : &lut.data_1d;
+                expected = lut.is_3d ? static_cast<size_t>(declared) * declared * declared * 3
+                                     : static_cast<size_t>(declared) * 3;
+                target->reserve(expected);
+            }
+            // DOMAIN_MIN/DOMAIN_MAX/LUT_*_INPUT_RANGE 等其他关键字忽略
+            continue;
+        }
+
+        if (lut.size == 0) {
+            throw_cube_error(line_number, "table data before LUT_3D_SIZE/LUT_1D_SIZE");
+        }
+
+        const char* lp = line.data();
+        const char* le = lp + line.size();
+        float r, g, b;
+        if (!parse_cube_float(lp, le, r) || !parse_cube_float(lp, le, g) || !parse_cube_float(lp, le, b)) {
+            throw_cube_error(line_number, "expected three numbers, got \"" + std::string(line) + "\"");
+        }
+        skip_spaces(lp, le);
+        if (lp != le && *lp != '#') {
+            throw_cube_error(line_number, "unexpected trailing characters");
+        }
+        if (target->size() >= expected) {
+            throw_cube_error(line_number, "more table entries than declared size");
+        }
+        target->push_back(r);
+        target->push_back(g);
+        target->push_back(b);
+    }
+
+    if (lut.size > 0 && target->size() != expected) {
+        throw std::runtime_error("LUT parse error: expected " + std::to_string(expected / 3) +
+                                 " table entries, found " + std::to_string(target->size() / 3));
+    }
+
+    lut.build_tables();
+    return lut.is_valid();
+}
+
+bool parse_cube_file(const std::string& file_path, LUTData& lut) {
+    // 路径按 UTF-8 解释，Windows 下可直接打开中文路径；大文件直接内存映射
+    MappedFile file(file_path);
+    if (!file.is_open()) {
+        return false;
+    }
+    return parse_cube_buffer(file.data(), file.size(), lut);
+}
+
+bool parse_cube_content(const std::string& lut_content, LUTData& lut) {
+    return parse_cube_buffer(lut_content.data(), lut_content.size(), lut);
+}
+
+// ============================================================================
+// LUT 句柄与 LRU 缓存
+// ============================================================================
+
+// 解析后的 LUT 只读共享，可在多次预览/应用调用间复用
+using LUTHandle = std::shared_ptr<const LUTData>;
+
+size_t lut_memory_bytes(const LUTData& lut) {
+    return (lut.data_3d.size() + lut.data_1d.size() + lut.soa.size()) * sizeof(float) +
+           lut.fixed.size() * sizeof(int16_t) + lut.title.size() + sizeof(LUTData);
+}
+
+std::shared_ptr<LUTData> parse_lut_handle_from_file(const std::string& file_path) {
+    auto lut = std::make_shared<LUTData>();
+    if (!parse_cube_file(file_path, *lut)) {
+        throw std::runtime_error("Failed to parse LUT file: " + file_path);
+    }
+    return lut;
+}
+
+// 每次调用都重新解析并构建表，计为一次堆分配；反复使用同一 LUT 时应传 Lut 对象或文件路径
+std::shared_ptr<LUTData> parse_lut_handle_from_content(const std::string& lut_content) {
+    count_heap_allocation();
+    auto lut = std::make_shared<LUTData>();
+    if (!parse_cube_content(lut_content, *lut)) {
+        throw std::runtime_error("Failed to parse LUT data");
+    }
+    return lut;
+}
+
+std::atomic<uint64_t> g_temp_file_counter{0};
+
+// 同目录下不会与其他进程、线程重名的临时文件路径
+fs::path unique_temp_path(const fs::path& path) {
+#ifdef _WIN32
+    const unsigned long pid = GetCurrentProcessId();
+#else
+    const unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+    fs::path temp_path = path;
+    temp_path += "." + std::to_string(pid) + "-" + std::to_string(g_temp_file_counter.fetch_add(1)) + ".tmp";
+    return temp_path;
+}
+
+// 先写入同目录临时文件再替换目标，失败时不留下半个文件；write 向流中写出全部内容。
+// 临时文件名各不相同，并发写同一目标时互不截断；目标仍被映射（Windows）时替换失败并抛出异常
+template <typename WriteFn>
+void write_file_atomic(const std::string& file_path, WriteFn write) {
+    fs::path path = fs::u8path(file_path);
+    const fs::path temp_path = unique_temp_path(path);
+    std::error_code ec;
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (file) {
+            write(file);
+            file.flush();
+        }
+        if (!file) {
+            file.close();
+            fs::remove(temp_path, ec);
+            throw std::runtime_error("Cannot write file: " + file_path);
+        }
+    }
+    fs::rename(temp_path, path, ec);
+    if (ec) {
+        fs::remove(temp_path, ec);
+        throw std::runtime_error("Cannot write file: " + file_path);
+    }
+}
+
+// FNV-1a 64 位哈希，用于判断 .cube 源文件内容是否变化
+uint64_t fnv1a64(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 二进制 LUT 缓存（.lutc）：文件头 + 标题 + 按 64 字节对齐存放的表。
+// 3D LUT 存 SoA 浮点平面与可选的定点格点，布局与内存中一致，映射后直接供插值内核使用；
+// 1D LUT 存交错 RGB 浮点。文件按本机字节序写出，magic 不符即视为无效
+const char kLutBinaryMagic[8] = {'F', 'A', 'F', 'L', 'U', 'T', 'C', '\0'};
+const uint32_t kLutBinaryVersion = 2;
+const uint32_t kLutBinaryFlag3D = 1;
+const uint32_t kLutBinaryFlagFixed = 2;
+
+// 生成缓存时 .cube 源文件的大小、修改时间与内容哈希
+struct LutSourceStamp {
+    uint64_t bytes = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+};
+
+struct LutBinaryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t size;
+    uint32_t title_bytes;
+    uint64_t plane_stride;
+    uint64_t table_offset;
+    uint64_t fixed_offset;
+    uint64_t file_bytes;
+    uint64_t source_bytes;
+    int64_t source_mtime;
+    uint64_t source_hash;
+    uint64_t content_hash;  // LUTData::content_hash，映射时无需为计算预览缓存键读遍整个表
+};
+static_assert(sizeof(LutBinaryHeader) == 88, "LutBinaryHeader layout");
+
+inline uint64_t align64(uint64_t value) {
+    return (value + 63) & ~uint64_t(63);
+}
+
+void write_lut_binary(const LUTData& lut, const std::string& file_path, const LutSourceStamp& stamp) {
+    if (!lut.is_valid()) {
+        throw std::runtime_error("Cannot write invalid LUT");
+    }
+
+    const uint64_t count = lut.is_3d ? static_cast<uint64_t>(lut.size) * lut.size * lut.size : 0;
+    LutBinaryHeader header = {};
+    std::memcpy(header.magic, kLutBinaryMagic, sizeof(header.magic));
+    header.version = kLutBinaryVersion;
+    header.flags = (lut.is_3d ? kLutBinaryFlag3D : 0) | (lut.has_fixed() ? kLutBinaryFlagFixed : 0);
+    header.size = static_cast<uint32_t>(lut.size);
+    header.title_bytes = static_cast<uint32_t>(lut.title.size());
+    header.plane_stride = lut.is_3d ? lut.plane_stride : 0;
+    header.table_offset = align64(sizeof(LutBinaryHeader) + header.title_bytes);
+    const uint64_t table_bytes = (lut.is_3d ? header.plane_stride * 3 : lut.data_1d.size()) * sizeof(float);
+    uint64_t end = header.table_offset + table_bytes;
+    if (lut.has_fixed()) {
+        header.fixed_offset = align64(end);
+        end = header.fixed_offset + count * 4 * sizeof(int16_t);
+    }
+    header.file_bytes = end;
+    header.source_bytes = stamp.bytes;
+    header.source_mtime = stamp.mtime;
+    header.source_hash = stamp.hash;
+    header.content_hash = lut.content_hash;
+
+    write_file_atomic(file_path, [&](std::ofstream& file) {
+        static const char zeros[64] = {};
+        uint64_t offset = 0;
+        auto put = [&](const void* data, uint64_t bytes) {
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            offset += bytes;
+        };
+        auto pad_to = [&](uint64_t target) { put(zeros, target - offset); };
+
+        put(&header, sizeof(header));
+        put(lut.title.data(), lut.title.size());
+        pad_to(header.table_offset);
+        if (lut.is_3d) {
+            put(lut.soa_data, table_bytes);
+        } else {
+            put(lut.data_1d.data(), table_bytes);
+        }
+        if (lut.has_fixed()) {
+            pad_to(header.fixed_offset);
+            put(lut.fixed_data, count * 4 * sizeof(int16_t));
+        }
+    });
+}
+
+// 映射二进制缓存并构造 LUT，表直接引用映射内存；文件缺失、版本不符或结构损坏时返回空
+std::shared_ptr<LUTData> map_lut_binary(const std::string& file_path, LutSourceStamp& stamp) {
+    std::error_code ec;
+    if (!fs::is_regular_file(fs::u8path(file_path), ec)) {
+        return nullptr;
+    }
+    auto file = std::make_shared<MappedFile>(file_path, false);
+    if (!file->is_open() || file->size() < sizeof(LutBinaryHeader)) {
+        return nullptr;
+    }
+
+    LutBinaryHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, kLutBinaryMagic, sizeof(header.magic)) != 0 ||
+        header.version != kLutBinaryVersion || header.file_bytes != file->size()) {
+        return nullptr;
+    }
+
+    const bool is_3d = (header.flags & kLutBinaryFlag3D) != 0;
+    if (header.size < 2 || header.size > static_cast<uint32_t>(max_lut_size(is_3d))) {
+        return nullptr;
+    }
+    const bool has_fixed = is_3d && (header.flags & kLutBinaryFlagFixed) != 0;
+    const uint64_t count = is_3d ? static_cast<uint64_t>(header.size) * header.size * header.size : 0;
+    const uint64_t table_bytes = (is_3d ? header.plane_stride * 3 : uint64_t(header.size) * 3) * sizeof(float);
+    const uint64_t fixed_bytes = has_fixed ? count * 4 * sizeof(int16_t) : 0;
+    if ((is_3d && header.plane_stride < count) || header.table_offset % 64 != 0 ||
+        sizeof(LutBinaryHeader) + uint64_t(header.title_bytes) > header.table_offset ||
+        header.table_offset + table_bytes > header.file_bytes ||
+        (has_fixed && (header.fixed_offset % 64 != 0 || header.fixed_offset < header.table_offset + table_bytes ||
+                       header.fixed_offset + fixed_bytes > header.file_bytes))) {
+        return nullptr;
+    }
+
+    auto lut = std::make_shared<LUTData>();
+    lut->is_3d = is_3d;
+    lut->size = static_cast<int>(header.size);
+    lut->content_hash = header.content_hash;
+    lut->title.assign(file->data() + sizeof(LutBinaryHeader), header.title_bytes);
+    const char* table = file->data() + header.table_offset;
+    if (!is_3d) {
+        lut->data_1d.resize(static_cast<size_t>(header.size) * 3);
+        std::memcpy(lut->data_1d.data(), table, table_bytes);
+    } else {
+        lut->plane_stride = static_cast<size_t>(header.plane_stride);
+        const char* fixed = has_fixed ? file->data() + header.fixed_offset : nullptr;
+        if (file->is_mapped() && reinterpret_cast<uintptr_t>(file->data()) % 64 == 0) {
+            lut->soa_data = reinterpret_cast<const float*>(table);
+            lut->fixed_data = reinterpret_cast<const int16_t*>(fixed);
+            lut->backing = file;
+        } else {
+            // 退回普通读取时缓冲区未必对齐，复制到对齐的堆内存
+            lut->soa.resize(lut->plane_stride * 3);
+            std::memcpy(lut->soa.data(), table, table_bytes);
+            lut->soa_data = lut->soa.data();
+            if (fixed) {
+                lut->fixed.resize(count * 4);
+                std::memcpy(lut->fixed.data(), fixed, fixed_bytes);
+                lut->fixed_data = lut->fixed.data();
+            }
+        }
+        if (has_fixed) {
+            lut->build_fixed_weights();
+        }
+    }
+
+    stamp.bytes = header.source_bytes;
+    stamp.mtime = header.source_mtime;
+    stamp.hash = header.source_hash;
+    return lut;
+}
+
+// 把（可能引用映射内存的）LUT 复制到堆上，之后可以释放映射；内容哈希保持不变
+std::shared_ptr<LUTData> copy_lut_to_heap(const LUTData& source) {
+    auto lut = std::make_shared<LUTData>();
+    lut->is_3d = source.is_3d;
+    lut->title = source.title;
+    lut->size = source.size;
+    lut->content_hash = source.content_hash;
+    lut->data_1d = source.data_1d;
+    if (source.is_3d && source.soa_data) {
+        const size_t count = static_cast<size_t>(source.size) * source.size * source.size;
+        lut->plane_stride = source.plane_stride;
+        lut->soa.assign(source.soa_data, source.soa_data + source.plane_stride * 3);
+        lut->soa_data = lut->soa.data();
+        if (source.fixed_data) {
+            lut->fixed.assign(source.fixed_data, source.fixed_data + count * 4);
+            lut->fixed_data = lut->fixed.data();
+            lut->fixed_index = source.fixed_index;
+            lut->fixed_frac = source.fixed_frac;
+        }
+    }
+    return lut;
+}
+
+// 二进制缓存目录中与源路径对应的文件名
+std::string lut_binary_path(const std::string& cache_dir, const std::string& file_path) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.lutc",
+                  static_cast<unsigned long long>(fnv1a64(file_path.data(), file_path.size())));
+    return (fs::u8path(cache_dir) / name).u8string();
+}
+
+// 以 路径 + 修改时间 + 文件大小 为键的 LRU，按字节预算淘汰；
+// 设置二进制缓存目录后，未命中时优先映射 .lutc 而不解析 .cube
+class LUTCache {
+public:
+    static LUTCache& instance() {
+        static LUTCache cache;
+        return cache;
+    }
+
+    LUTHandle load(const std::string& file_path) {
+        std::error_code ec;
+        fs::path path = fs::u8path(file_path);
+        auto mtime = fs::last_write_time(path, ec);
+        if (ec) {
+            throw std::runtime_error("Cannot stat LUT file: " + file_path);
+        }
+        uintmax_t file_size = fs::file_size(path, ec);
+        if (ec) {
+            throw std::runtime_error("Cannot stat LUT file: " + file_path);
+        }
+        int64_t mtime_ticks = static_cast<int64_t>(mtime.time_since_epoch().count());
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = index_.find(file_path);
+            if (it != index_.end()) {
+                Entry& entry = *it->second;
+                if (entry.mtime == mtime_ticks && entry.file_size == file_size) {
+                    entries_.splice(entries_.begin(), entries_, it->second);
+                    hits_++;
+                    return entry.lut;
+                }
+                erase_locked(it);
+            }
+            misses_++;
+        }
+
+        // 解析不持锁，允许不同 LUT 并行加载
+        LUTHandle lut = load_source(file_path, file_size, mtime_ticks);
+        size_t bytes = lut_memory_bytes(*lut);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(file_path);
+        if (it != index_.end()) {
+            erase_locked(it);
+        }
+        entries_.push_front({file_path, mtime_ticks, file_size, bytes, lut});
+        index_[file_path] = entries_.begin();
+        bytes_ += bytes;
+        evict_locked();
+        return lut;
+    }
+
+    void set_limit(size_t limit_bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        limit_ = limit_bytes;
+        evict_locked();
+    }
+
+    // 移除路径对应的缓存项，删除或替换 LUT 文件前调用：缓存不再持有其 .lutc 映射。
+    // 其他地方仍持有的句柄继续有效，映射在最后一个句柄释放时关闭
+    bool evict(const std::string& file_path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(file_path);
+        if (it == index_.end()) {
+            return false;
+        }
+        erase_locked(it);
+        return true;
+    }
+
+    // 为空时禁用二进制缓存
+    void set_binary_dir(const std::string& dir) {
+        if (!dir.empty()) {
+            std::error_code ec;
+            fs::create_directories(fs::u8path(dir), ec);
+            if (ec) {
+                throw std::runtime_error("Cannot create LUT cache directory: " + dir);
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        binary_dir_ = dir;
+    }
+
+    std::string binary_dir() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return binary_dir_;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        index_.clear();
+        bytes_ = 0;
+    }
+
+    py::dict info() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        py::dict d;
+        d["entries"] = entries_.size();
+        d["bytes"] = bytes_;
+        d["limit"] = limit_;
+        d["hits"] = hits_;
+        d["misses"] = misses_;
+        d["binary_hits"] = binary_hits_;
+        d["binary_writes"] = binary_writes_;
+        d["source_hashes"] = source_hashes_;
+        return d;
+    }
+
+private:
+    struct Entry {
+        std::string path;
+        int64_t mtime;
+        uintmax_t file_size;
+        size_t bytes;
+        LUTHandle lut;
+    };
+
+    LUTCache()
+        : bytes_(0), limit_(64 * 1024 * 1024), hits_(0), misses_(0), binary_hits_(0), binary_writes_(0),
+          source_hashes_(0) {}
+
+    // 源文件大小与修改时间和缓存一致时直接映射；只有修改时间变化时按内容哈希确认；
+    // 其余情况重新解析 .cube 并重写缓存（写入失败不影响本次加载）
+    LUTHandle load_source(const std::string& file_path, uintmax_t file_size, int64_t mtime_ticks) {
+        const std::string dir = binary_dir();
+        if (dir.empty()) {
+            return parse_lut_handle_from_file(file_path);
+        }
+
+        const std::string binary_path = lut_binary_path(dir, file_path);
+        LutSourceStamp cached;
+        std::shared_ptr<LUTData> lut = map_lut_binary(binary_path, cached);
+        if (lut && cached.bytes == file_size && cached.mtime == mtime_ticks) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            binary_hits_++;
+            return lut;
+        }
+
+        MappedFile source(file_path);
+        if (!source.is_open()) {
+            throw std::runtime_error("Failed to parse LUT file: " + file_path);
+        }
+        LutSourceStamp stamp;
+        stamp.bytes = source.size();
+        stamp.mtime = mtime_ticks;
+        stamp.hash = fnv1a64(source.data(), source.size());
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            source_hashes_++;
+        }
+
+        if (lut && cached.bytes == stamp.bytes && cached.hash == stamp.hash) {
+            // 只有修改时间变化：更新文件头中的时间戳。Windows 下无法替换仍被映射的文件，
+            // 先把格点复制到堆上并释放映射再写，写完重新映射
+            std::shared_ptr<LUTData> heap = copy_lut_to_heap(*lut);
+            lut.reset();
+            try {
+                write_lut_binary(*heap, binary_path, stamp);
+                LutSourceStamp written;
+                lut = map_lut_binary(binary_path, written);
+            } catch (const std::exception&) {
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            binary_hits_++;
+            return lut ? lut : heap;
+        }
+        lut.reset();
+
+        auto parsed = std::make_shared<LUTData>();
+        if (!parse_cube_buffer(source.data(), source.size(), *parsed)) {
+            throw std::runtime_error("Failed to parse LUT file: " + file_path);
+        }
+        try {
+            write_lut_binary(*parsed, binary_path, stamp);
+            std::lock_guard<std::mutex> lock(mutex_);
+            binary_writes_++;
+        } catch (const std::exception&) {
+        }
+        return parsed;
+    }
+
+    using Index = std::unordered_map<std::string, std::list<Entry>::iterator>;
+
+    void erase_locked(Index::iterator it) {
+        bytes_ -= it->second->bytes;
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+
+    // 至少保留最近使用的一项，避免单个超大 LUT 被立即淘汰
+    void evict_locked() {
+        while (bytes_ > limit_ && entries_.size() > 1) {
+            Entry& victim = entries_.back();
+            bytes_ -= victim.bytes;
+            index_.erase(victim.path);
+            entries_.pop_back();
+        }
+    }
+
+    std::mutex mutex_;
+    std::list<Entry> entries_;
+    Index index_;
+    size_t bytes_;
+    size_t limit_;
+    uint64_t hits_;
+    uint64_t misses_;
+    uint64_t binary_hits_;
+    uint64_t binary_writes_;
+    // 读取并哈希源文件的次数（二进制缓存未能直接命中时）
+    uint64_t source_hashes_;
+    std::string binary_dir_;
+};
+
+// 判断字符串是否为已存在的文件路径（包含换行的视为 LUT 内容）
+bool is_lut_file_path(const std::string& value) {
+    if (value.empty() || value.size() > 4096 || value.find('\n') != std::string::npos) {
+        return false;
+    }
+    std::error_code ec;
+    return fs::is_regular_file(fs::u8path(value), ec);
+}
+
+// 接受 Lut 对象、文件路径或 .cube 文本，统一得到解析后的句柄
+// 在持有 GIL 时从 Python 参数取出的 LUT 来源：Lut 对象直接持有句柄，
+// 字符串（路径或内容）留到释放 GIL 之后再加载/解析
+struct LutSource {
+    LUTHandle handle;
+    std::string text;
+};
+
+LutSource lut_source(const py::object& lut_or_content) {
+    LutSource source;
+    if (py::isinstance<LUTData>(lut_or_content)) {
+        source.handle = lut_or_content.cast<std::shared_ptr<LUTData>>();
+    } else {
+        source.text = lut_or_content.cast<std::string>();
+    }
+    return source;
+}
+
+// 逐项取出列表中的 LUT 来源；类型不符的条目记为无效（source_ok 为 0），由调用方按解析失败处理
+void lut_sources(const py::list& luts, ScratchVector<LutSource>& sources, ScratchVector<char>& source_ok) {
+    sources.reserve(luts.size());
+    source_ok.reserve(luts.size());
+    for (const auto& item : luts) {
+        try {
+            sources.push_back(lut_source(py::reinterpret_borrow<py::object>(item)));
+            source_ok.push_back(1);
+        } catch (const std::exception&) {
+            sources.emplace_back();
+            source_ok.push_back(0);
+        }
+    }
+}
+
+// 不访问 Python 对象，可在释放 GIL 后调用
+LUTHandle resolve_lut(const LutSource& source) {
+    if (source.handle) {
+        return source.handle;
+    }
+    if (is_lut_file_path(source.text)) {
+        return LUTCache::instance().load(source.text);
+    }
+    return parse_lut_handle_from_content(source.text);
+}
+
+// ============================================================================
+// LUT 应用算法
+// ============================================================================
+
+inline float clamp01(float v) {
+    return std::max(0.0f, std::min(1.0f, v));
+}
+
+// 3D LUT 插值方式：三线性取 8 个格点，四面体取 4 个格点（与 DaVinci/ffmpeg lut3d 一致）
+enum class Interpolation {
+    Trilinear,
+    Tetrahedral
+};
+
+Interpolation parse_interpolation(const std::string& name) {
+    if (name == "trilinear") return Interpolation::Trilinear;
+    if (name == "tetrahedral") return Interpolation::Tetrahedral;
+    throw std::runtime_error("Unsupported interpolation: " + name + " (expected 'trilinear' or 'tetrahedral')");
+}
+
+// 标量三线性插值；调用方保证 LUT 有效，下标在入口处一次性钳制，无需逐次越界检查
+inline void apply_3d_lut(const LUTData& lut, float r, float g, float b, float& out_r, float& out_g, float& out_b) {
+    const int size = lut.size;
+    const int max_base = size - 2;
+    float rf = clamp01(r) * (size - 1);
+    float gf = clamp01(g) * (size - 1);
+    float bf = clamp01(b) * (size - 1);
+
+    // 基准格点最多取到 size - 2，顶端样本以权重 1 落在上侧格点
+    int r0 = std::min(static_cast<int>(rf), max_base);
+    int g0 = std::min(static_cast<int>(gf), max_base);
+    int b0 = std::min(static_cast<int>(bf), max_base);
+
+    float dr = rf - r0;
+    float dg = gf - g0;
+    float db = bf - b0;
+
+    const size_t sg = static_cast<size_t>(size);
+    const size_t sb = sg * sg;
+    const size_t base = (b0 * sb + g0 * sg) + r0;
+    const size_t o[8] = {
+        base, base + 1, base + sg, base + sg + 1,
+        base + sb, base + sb + 1, base + sb + sg, base + sb + sg + 1
+    };
+
+    float* outs[3] = {&out_r, &out_g, &out_b};
+    for (int c = 0; c < 3; c++) {
+        const float* p = lut.plane(c);
+        float c00 = p[o[0]] + (p[o[1]] - p[o[0]]) * dr;
+        float c10 = p[o[2]] + (p[o[3]] - p[o[2]]) * dr;
+        float c01 = p[o[4]] + (p[o[5]] - p[o[4]]) * dr;
+        float c11 = p[o[6]] + (p[o[7]] - p[o[6]]) * dr;
+        float c0 = c00 + (c10 - c00) * dg;
+        float c1 = c01 + (c11 - c01) * dg;
+        *outs[c] = c0 + (c1 - c0) * db;
+    }
+}
+
+// 标量四面体插值：按 dr/dg/db 的大小关系选出 6 个四面体之一，只取 4 个格点
+inline void apply_3d_lut_tetrahedral(const LUTData& lut, float r, float g, float b,
+                                     float& out_r, float& out_g, float& out_b) {
+    const int size = lut.size;
+    const int max_base = size - 2;
+    float rf = clamp01(r) * (size - 1);
+    float gf = clamp01(g) * (size - 1);
+    float bf = clamp01(b) * (size - 1);
+
+    int r0 = std::min(static_cast<int>(rf), max_base);
+    int g0 = std::min(static_cast<int>(gf), max_base);
+    int b0 = std::min(static_cast<int>(bf), max_base);
+
+    float dr = rf - r0;
+    float dg = gf - g0;
+    float db = bf - b0;
+
+    const size_t sr = 1;
+    const size_t sg = static_cast<size_t>(size);
+    const size_t sb = sg * sg;
+    const size_t base = (b0 * sb + g0 * sg) + r0;
+
+    // 四面体的两个中间顶点与 4 个权重
+    size_t o1, o2;
+    float w0, w1, w2, w3;
+    if (dr > dg) {
+        if (dg > db) {
+            o1 = sr; o2 = sr + sg;
+            w0 = 1.0f - dr; w1 = dr - dg; w2 = dg - db; w3 = db;
+        } else if (dr > db) {
+            o1 = sr; o2 = sr + sb;
+            w0 = 1.0f - dr; w1 = dr - db; w2 = db - dg; w3 = dg;
+        } else {
+            o1 = sb; o2 = sr + sb;
+            w0 = 1.0f - db; w1 = db - dr; w2 = dr - dg; w3 = dg;
+        }
+    } else {
+        if (db > dg) {
+            o1 = sb; o2 = sg + sb;
+            w0 = 1.0f - db; w1 = db - dg; w2 = dg - dr; w3 = dr;
+        } else if (db > dr) {
+            o1 = sg; o2 = sg + sb;
+            w0 = 1.0f - dg; w1 = dg - db; w2 = db - dr; w3 = dr;
+        } else {
+            o1 = sg; o2 = sr + sg;
+            w0 = 1.0f - dg; w1 = dg - dr; w2 = dr - db; w3 = db;
+        }
+    }
+    const size_t o3 = sr + sg + sb;
+
+    float* outs[3] = {&out_r, &out_g, &out_b};
+    for (int c = 0; c < 3; c++) {
+        const float* p = lut.plane(c) + base;
+        *outs[c] = p[0] * w0 + p[o1] * w1 + p[o2] * w2 + p[o3] * w3;
+    }
+}
+
+inline void apply_1d_lut(const LUTData& lut, float r, float g, float b, float& out_r, float& out_g, float& out_b) {
+    int size = lut.size;
+
+    auto interpolate = [&lut, size](float value, int offset) -> float {
+        float idx_f = clamp01(value) * (size - 1);
+        int idx0 = static_cast<int>(idx_f);
+        int idx1 = std::min(idx0 + 1, size - 1);
+        float t = idx_f - idx0;
+
+        float v0 = lut.data_1d[idx0 * 3 + offset];
+        float v1 = lut.data_1d[idx1 * 3 + offset];
+
+        return v0 * (1.0f - t) + v1 * t;
+    };
+
+    out_r = interpolate(r, 0);
+    out_g = interpolate(g, 1);
+    out_b = interpolate(b, 2);
+}
+
+inline void apply_lut_pixel(const LUTData& lut, float r, float g, float b, float& out_r, float& out_g, float& out_b,
+                            Interpolation interpolation = Interpolation::Trilinear) {
+    if (!lut.is_valid()) {
+        out_r = r; out_g = g; out_b = b;
+        return;
+    }
+    if (lut.is_3d && interpolation == Interpolation::Tetrahedral) {
+        apply_3d_lut_tetrahedral(lut, r, g, b, out_r, out_g, out_b);
+    } else if (lut.is_3d) {
+        apply_3d_lut(lut, r, g, b, out_r, out_g, out_b);
+    } else {
+        apply_1d_lut(lut, r, g, b, out_r, out_g, out_b);
+    }
+}
+
+// ============================================================================
+// 图像处理
+// ============================================================================
+
+// 输入/输出样本类型：8/16 位整数按满量程归一化，float32/float16 直接视为 0~1 的归一化值
+enum class SampleType {
+    U8,
+    U16,
+    F32,
+    F16
+};
+
+// numpy float16 的存储形式，计算时转换为 float
+struct Half {
+    uint16_t bits;
+};
+
+inline float half_to_float(uint16_t h) {
+    const uint32_t shifted_exp = 0x7c00u << 13;
+    uint32_t o = (h & 0x7fffu) << 13;
+    uint32_t exp = shifted_exp & o;
+    o += (127 - 15) << 23;
+    if (exp == shifted_exp) {
+        o += (128 - 16) << 23;  // Inf/NaN
+    } else if (exp == 0) {
+        // 非规格化数：借助浮点减法完成规格化
+        const uint32_t magic_bits = 113u << 23;
+        float magic;
+        float f;
+        o += 1u << 23;
+        std::memcpy(&magic, &magic_bits, 4);
+        std::memcpy(&f, &o, 4);
+        f -= magic;
+        std::memcpy(&o, &f, 4);
+    }
+    o |= static_cast<uint32_t>(h & 0x8000u) << 16;
+    float result;
+    std::memcpy(&result, &o, 4);
+    return result;
+}
+
+// 就近舍入到偶数，溢出为 Inf
+inline uint16_t float_to_half(float value) {
+    uint32_t x;
+    std::memcpy(&x, &value, 4);
+    const uint32_t sign = x & 0x80000000u;
+    x ^= sign;
+    uint16_t o;
+    if (x >= 0x47800000u) {
+        o = x > 0x7f800000u ? 0x7e00 : 0x7c00;
+    } else if (x < 0x38800000u) {
+        // 非规格化数：加上魔数使 10 位尾数对齐到最低位，由 FPU 完成舍入
+        const uint32_t magic_bits = 0x3f000000u;
+        float magic;
+        float f;
+        std::memcpy(&magic, &magic_bits, 4);
+        std::memcpy(&f, &x, 4);
+        f += magic;
+        uint32_t bits;
+        std::memcpy(&bits, &f, 4);
+        o = static_cast<uint16_t>(bits - magic_bits);
+    } else {
+        uint32_t mant_odd = (x >> 13) & 1;
+        x += 0xc8000fffu;
+        x += mant_odd;
+        o = static_cast<uint16_t>(x >> 13);
+    }
+    return static_cast<uint16_t>(o | (sign >> 16));
+}
+
+// 各样本类型与归一化浮点之间的转换；range 为 1.0 对应的样本值
+template <typename T>
+struct SampleTraits;
+
+template <>
+struct SampleTraits<uint8_t> {
+    static constexpr SampleType type = SampleType::U8;
+    static constexpr float range = 255.0f;
+    static float to_float(uint8_t v) { return v; }
+    static uint8_t from_unit(float v) { return static_cast<uint8_t>(clamp01(v) * 255.0f + 0.5f); }
+};
+
+template <>
+struct SampleTraits<uint16_t> {
+    static constexpr SampleType type = SampleType::U16;
+    static constexpr float range = 65535.0f;
+    static float to_float(uint16_t v) { return v; }
+    static uint16_t from_unit(float v) { return static_cast<uint16_t>(clamp01(v) * 65535.0f + 0.5f); }
+};
+
+template <>
+struct SampleTraits<float> {
+    static constexpr SampleType type = SampleType::F32;
+    static constexpr float range = 1.0f;
+    static float to_float(float v) { return v; }
+    static float from_unit(float v) { return v; }
+};
+
+template <>
+struct SampleTraits<Half> {
+    static constexpr SampleType type = SampleType::F16;
+    static constexpr float range = 1.0f;
+    static float to_float(Half v) { return half_to_float(v.bits); }
+    static Half from_unit(float v) { return Half{float_to_half(v)}; }
+};
+
+template <typename T>
+inline float sample_to_unit(T v) {
+    return SampleTraits<T>::to_float(v) * (1.0f / SampleTraits<T>::range);
+}
+
+inline size_t sample_size(SampleType type) {
+    switch (type) {
+        case SampleType::U8: return 1;
+        case SampleType::U16: return 2;
+        case SampleType::F16: return 2;
+        default: return 4;
+    }
+}
+
+inline const char* sample_dtype(SampleType type) {
+    switch (type) {
+        case SampleType::U8: return "uint8";
+        case SampleType::U16: return "uint16";
+        case SampleType::F16: return "float16";
+        default: return "float32";
+    }
+}
+
+SampleType parse_sample_type(const std::string& name) {
+    if (name == "uint8") return SampleType::U8;
+    if (name == "uint16") return SampleType::U16;
+    if (name == "float32") return SampleType::F32;
+    if (name == "float16") return SampleType::F16;
+    throw std::runtime_error("Unsupported dtype: " + name + " (expected 'uint8', 'uint16', 'float32' or 'float16')");
+}
+
+// 按运行时样本类型调用 f(T{})，把类型分派集中在一处
+template <typename F>
+decltype(auto) dispatch_sample(SampleType type, F&& f) {
+    switch (type) {
+        case SampleType::U16: return f(uint16_t{});
+        case SampleType::F32: return f(float{});
+        case SampleType::F16: return f(Half{});
+        default: return f(uint8_t{});
+    }
+}
+
+// 缩放滤波器：box 即面积平均，bilinear 为三角形滤波，lanczos3 为 3 瓣 Lanczos
+// 缩小时滤波器支撑域按缩放比例放大（抗锯齿），与 PIL 的 resize 行为一致
+enum class ResampleFilter {
+    Box,
+    Bilinear,
+    Lanczos3
+};
+
+ResampleFilter parse_resample_filter(const std::string& name) {
+    if (name == "box" || name == "area") return ResampleFilter::Box;
+    if (name == "bilinear") return ResampleFilter::Bilinear;
+    if (name == "lanczos" || name == "lanczos3") return ResampleFilter::Lanczos3;
+    throw std::runtime_error("Unsupported resample filter: " + name + " (expected 'box', 'bilinear' or 'lanczos3')");
+}
+
+inline double filter_support(ResampleFilter filter) {
+    switch (filter) {
+        case ResampleFilter::Box: return 0.5;
+        case ResampleFilter::Bilinear: return 1.0;
+        default: return 3.0;
+    }
+}
+
+inline double sinc(double x) {
+    if (x == 0.0) return 1.0;
+    x *= M_PI;
+    return std::sin(x) / x;
+}
+
+inline double filter_weight(ResampleFilter filter, double x) {
+    x = std::fabs(x);
+    switch (filter) {
+        case ResampleFilter::Box: return x <= 0.5 ? 1.0 : 0.0;
+        case ResampleFilter::Bilinear: return x < 1.0 ? 1.0 - x : 0.0;
+        default: return x < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+    }
+}
+
+// 单个方向的预计算权重：每个输出位置固定 taps 个输入，窗口贴边时整体平移，多余的权重为 0
+// 权重表从构造线程的暂存区分配，只在外层 ScratchScope 内有效
+struct ResampleAxis {
+    int taps;
+    ScratchVector<int32_t> start;
+    ScratchVector<float> weights;
+};
+
+ResampleAxis build_resample_axis(int in_size, int out_size, ResampleFilter filter) {
+    const double scale = static_cast<double>(in_size) / out_size;
+    const double filter_scale = std::max(scale, 1.0);
+    const double support = filter_support(filter) * filter_scale;
+
+    ResampleAxis axis;
+    axis.taps = std::min(in_size, static_cast<int>(std::ceil(support)) * 2 + 1);
+    axis.start.resize(out_size);
+    axis.weights.assign(static_cast<size_t>(out_size) * axis.taps, 0.0f);
+
+    ScratchVector<double> w(axis.taps);
+    for (int i = 0; i < out_size; i++) {
+        const double center = (i + 0.5) * scale;
+        int lo = std::max(0, static_cast<int>(center - support + 0.5));
+        int hi = std::min(in_size, static_cast<int>(center + support + 0.5));
+        hi = std::min(hi, lo + axis.taps);
+        if (hi <= lo) {
+            lo = std::min(std::max(0, static_cast<int>(center)), in_size - 1);
+            hi = lo + 1;
+        }
+
+        double total = 0.0;
+        for (int x = lo; x < hi; x++) {
+            w[x - lo] = filter_weight(filter, (x + 0.5 - center) / filter_scale);
+            total += w[x - lo];
+        }
+        if (total == 0.0) {
+            std::fill(w.begin(), w.begin() + (hi - lo), 0.0);
+            w[std::min(static_cast<int>(center), hi - 1) - lo] = 1.0;
+            total = 1.0;
+        }
+
+        int start = std::min(lo, in_size - axis.taps);
+        axis.start[i] = start;
+        float* out = axis.weights.data() + static_cast<size_t>(i) * axis.taps;
+        for (int x = lo; x < hi; x++) {
+            out[x - start] = static_cast<float>(w[x - lo] / total);
+        }
+    }
+    return axis;
+}
+
+// 输入像素布局：R/G/B/A 所在的通道序号（alpha 为 -1 表示没有 alpha，X 为忽略的填充字节）
+struct PixelLayout {
+    int channels;
+    int index[4];
+};
+
+PixelLayout parse_input_format(const std::string& name, int channels) {
+    static const struct {
+        const char* name;
+        PixelLayout layout;
+    } kFormats[] = {
+        {"rgb", {3, {0, 1, 2, -1}}},
+        {"bgr", {3, {2, 1, 0, -1}}},
+        {"rgba", {4, {0, 1, 2, 3}}},
+        {"bgra", {4, {2, 1, 0, 3}}},
+        {"rgbx", {4, {0, 1, 2, -1}}},
+        {"bgrx", {4, {2, 1, 0, -1}}},
+    };
+    std::string key = name == "auto" ? (channels == 4 ? "rgba" : "rgb") : name;
+    for (const auto& format : kFormats) {
+        if (key != format.name) continue;
+        if (format.layout.channels != channels) {
+            throw std::runtime_error("Input format '" + key + "' expects " + std::to_string(format.layout.channels) +
+                                     " channels, got " + std::to_string(channels));
+        }
+        return format.layout;
+    }
+    throw std::runtime_error("Unsupported input format: " + name +
+                             " (expected 'auto', 'rgb', 'bgr', 'rgba', 'bgra', 'rgbx' or 'bgrx')");
+}
+
+// 输入图像的只读视图，在持有 GIL 时从 numpy 数组中取出，之后的计算不再访问 Python 对象
+// 行、像素与通道步长以样本为单位且可以为负，非连续视图和带行填充的 QImage 缓冲都无需先复制
+struct ImageView {
+    const void* data;
+    SampleType sample;
+    int width;
+    int height;
+    PixelLayout layout;
+    ptrdiff_t row_stride;
+    ptrdiff_t pixel_stride;
+    ptrdiff_t offset[4];  // R/G/B/A 相对像素起点的样本偏移，offset[3] 仅在 has_alpha() 时有效
+
+    bool has_alpha() const { return layout.index[3] >= 0; }
+    template <typename T = uint8_t>
+    const T* row(int y) const { return static_cast<const T*>(data) + y * row_stride; }
+    bool is_packed_rgb() const {
+        return sample == SampleType::U8 && pixel_stride == 3 && offset[0] == 0 && offset[1] == 1 && offset[2] == 2;
+    }
+};
+
+#if LUT_HAS_X86
+// 读取 8 个样本并转成浮点（纵向滤波用），float16 没有对应实现，走标量路径
+LUT_TARGET_AVX2
+inline __m256 load8_avx2(const uint8_t* p) {
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+}
+
+LUT_TARGET_AVX2
+inline __m256 load8_avx2(const uint16_t* p) {
+    return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));
+}
+
+LUT_TARGET_AVX2
+inline __m256 load8_avx2(const float* p) {
+    return _mm256_loadu_ps(p);
+}
+#endif
+
+// 可分离缩放：每个输出行先做纵向滤波（得到整行浮点中间结果），再做横向滤波写出 RGB（及 alpha）
+// 各输出行互不依赖，可按行带分给线程；中间结果只有一行，留在缓存中
+// 纵向滤波直接处理源行覆盖的样本区间，与通道顺序和像素步长无关；
+// 区间过于稀疏（如列优先数组）时改为按像素收集成紧凑的 RGB(A) 行
+// 中间结果统一在 0~255 的量程内；高位深输入可输出归一化浮点，保留精度直到应用 LUT 之后
+class Resampler {
+public:
+    Resampler(const ImageView& image, int dst_width, int dst_height, ResampleFilter filter)
+        : image_(image), dst_width_(dst_width), dst_height_(dst_height),
+          channels_(image.has_alpha() ? 4 : 3) {
+        if (image.width <= 0 || image.height <= 0) {
+            return;
+        }
+        horizontal_ = build_resample_axis(image.width, dst_width, filter);
+        vertical_ = build_resample_axis(image.height, dst_height, filter);
+
+        ptrdiff_t lo = 0;
+        ptrdiff_t hi = 0;
+        for (int c = 0; c < channels_; c++) {
+            for (ptrdiff_t x : {ptrdiff_t(0), ptrdiff_t(image.width - 1)}) {
+                ptrdiff_t v = x * image.pixel_stride + image.offset[c];
+                if (c == 0 && x == 0) lo = hi = v;
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+            }
+        }
+        const size_t span = static_cast<size_t>(hi - lo + 1);
+        gather_ = span > static_cast<size_t>(image.width) * channels_ * 2 + 64;
+        if (gather_) {
+            line_len_ = static_cast<size_t>(image.width) * channels_;
+            line_begin_ = 0;
+            pixel_step_ = channels_;
+            for (int c = 0; c < channels_; c++) channel_at_[c] = c;
+        } else {
+            line_len_ = span;
+            line_begin_ = lo;
+            pixel_step_ = image.pixel_stride;
+            for (int c = 0; c < channels_; c++) channel_at_[c] = image.offset[c] - lo;
+        }
+
+        // 横向 SIMD 一次读取 4 个浮点，要求用到的通道落在同一个 4 元素窗口内
+        window_ = *std::min_element(channel_at_, channel_at_ + channels_);
+        ptrdiff_t window_end = *std::max_element(channel_at_, channel_at_ + channels_);
+        simd_ = window_end - window_ <= 3;
+        for (int c = 0; c < 4; c++) {
+            lane_[c] = c < channels_ ? static_cast<int>(channel_at_[c] - window_) : 0;
+        }
+    }
+
+    // 每个线程需要的中间行大小（浮点数个数），多留 4 个以便横向滤波整 4 个读取
+    size_t scratch_size() const {
+        return line_len_ + 4;
+    }
+
+    // 生成 [y_begin, y_end) 行，rgb 指向第 y_begin 行；alpha 非空且输入带 alpha 时同时写出 8 位 alpha 平面
+    // rgb 为 uint8_t 时输出 8 位像素，为 float 时输出 0~1 的归一化值
+    template <typename Out>
+    void rows(int y_begin, int y_end, Out* rgb, uint8_t* alpha, float* scratch) const {
+        const size_t dst_row_samples = static_cast<size_t>(dst_width_) * 3;
+        if (image_.width <= 0 || image_.height <= 0) {
+            std::fill(rgb, rgb + static_cast<size_t>(y_end - y_begin) * dst_row_samples, Out(0));
+            if (alpha) std::fill(alpha, alpha + static_cast<size_t>(y_end - y_begin) * dst_width_, 0);
+            return;
+        }
+        if (channels_ < 4) alpha = nullptr;
+        std::fill(scratch + line_len_, scratch + scratch_size(), 0.0f);
+        for (int y = y_begin; y < y_end; y++) {
+            Out* out = rgb + static_cast<size_t>(y - y_begin) * dst_row_samples;
+            uint8_t* out_alpha = alpha ? alpha + static_cast<size_t>(y - y_begin) * dst_width_ : nullptr;
+            dispatch_sample(image_.sample, [&](auto sample) { vertical<decltype(sample)>(y, scratch); });
+#if LUT_HAS_X86
+            if (simd_ && cpu_has_avx2()) {
+                horizontal_avx2(scratch, out, out_alpha);
+                continue;
+            }
+#endif
+            horizontal_scalar(scratch, out, out_alpha);
+        }
+    }
+
+private:
+    template <typename T>
+    const T* line_base(int y) const {
+        return image_.row<T>(vertical_.start[y]) + line_begin_;
+    }
+
+    // 纵向权重预先乘以 255 / 满量程，中间结果对所有样本类型都落在 0~255 量程
+    template <typename T>
+    void vertical(int y, float* row) const {
+        if (gather_) {
+            vertical_gather<T>(y, row);
+            return;
+        }
+#if LUT_HAS_X86
+        if constexpr (!std::is_same_v<T, Half>) {
+            if (cpu_has_avx2()) {
+                vertical_avx2<T>(y, row);
+                return;
+            }
+        }
+#endif
+        vertical_scalar<T>(y, row);
+    }
+
+    template <typename T>
+    void vertical_scalar(int y, float* row) const {
+        const float norm = 255.0f / SampleTraits<T>::range;
+        const float* w = vertical_.weights.data() + static_cast<size_t>(y) * vertical_.taps;
+        const T* base = line_base<T>(y);
+        std::fill(row, row + line_len_, 0.0f);
+        for (int k = 0; k < vertical_.taps; k++) {
+            if (w[k] == 0.0f) continue;
+            const T* line = base + k * image_.row_stride;
+            const float wk = w[k] * norm;
+            for (size_t i = 0; i < line_len_; i++) {
+                row[i] += SampleTraits<T>::to_float(line[i]) * wk;
+            }
+        }
+    }
+
+    template <typename T>
+    void vertical_gather(int y, float* row) const {
+        const float norm = 255.0f / SampleTraits<T>::range;
+        const float* w = vertical_.weights.data() + static_cast<size_t>(y) * vertical_.taps;
+        std::fill(row, row + line_len_, 0.0f);
+        for (int k = 0; k < vertical_.taps; k++) {
+            if (w[k] == 0.0f) continue;
+            const T* line = image_.row<T>(vertical_.start[y] + k);
+            const float wk = w[k] * norm;
+            for (int x = 0; x < image_.width; x++) {
+                const T* px = line + x * image_.pixel_stride;
+                float* out = row + static_cast<size_t>(x) * channels_;
+                for (int c = 0; c < channels_; c++) {
+                    out[c] += SampleTraits<T>::to_float(px[image_.offset[c]]) * wk;
+                }
+            }
+        }
+    }
+
+    static void store_rgb(uint8_t* out, const float* acc) {
+        for (int c = 0; c < 3; c++) {
+            out[c] = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, acc[c] + 0.5f)));
+        }
+    }
+
+    static void store_rgb(float* out, const float* acc) {
+        for (int c = 0; c < 3; c++) {
+            out[c] = acc[c] * (1.0f / 255.0f);
+        }
+    }
+
+    template <typename Out>
+    void horizontal_scalar(const float* row, Out* out, uint8_t* out_alpha) const {
+        const int taps = horizontal_.taps;
+        const int channels = out_alpha ? 4 : 3;
+        for (int x = 0; x < dst_width_; x++) {
+            const float* w = horizontal_.weights.data() + static_cast<size_t>(x) * taps;
+            const float* p = row + horizontal_.start[x] * pixel_step_;
+            float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (int k = 0; k < taps; k++) {
+                const float* q = p + k * pixel_step_;
+                for (int c = 0; c < channels; c++) {
+                    acc[c] += q[channel_at_[c]] * w[k];
+                }
+            }
+            store_rgb(out + x * 3, acc);
+            if (out_alpha) {
+                out_alpha[x] = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, acc[3] + 0.5f)));
+            }
+        }
+    }
+
+#if LUT_HAS_X86
+    // 纵向：每次 32 个样本转成浮点，与各行权重做 FMA 累加
+    template <typename T>
+    LUT_TARGET_AVX2
+    void vertical_avx2(int y, float* row) const {
+        const float norm = 255.0f / SampleTraits<T>::range;
+        const size_t row_len = line_len_;
+        const ptrdiff_t stride = image_.row_stride;
+        const float* w = vertical_.weights.data() + static_cast<size_t>(y) * vertical_.taps;
+        const T* base = line_base<T>(y);
+
+        size_t i = 0;
+        for (; i + 32 <= row_len; i += 32) {
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            __m256 acc2 = _mm256_setzero_ps();
+            __m256 acc3 = _mm256_setzero_ps();
+            for (int k = 0; k < vertical_.taps; k++) {
+                const T* line = base + k * stride + i;
+                __m256 wk = _mm256_set1_ps(w[k] * norm);
+                acc0 = _mm256_fmadd_ps(load8_avx2(line), wk, acc0);
+                acc1 = _mm256_fmadd_ps(load8_avx2(line + 8), wk, acc1);
+                acc2 = _mm256_fmadd_ps(load8_avx2(line + 16), wk, acc2);
+                acc3 = _mm256_fmadd_ps(load8_avx2(line + 24), wk, acc3);
+            }
+            _mm256_storeu_ps(row + i, acc0);
+            _mm256_storeu_ps(row + i + 8, acc1);
+            _mm256_storeu_ps(row + i + 16, acc2);
+            _mm256_storeu_ps(row + i + 24, acc3);
+        }
+        for (; i < row_len; i++) {
+            float acc = 0.0f;
+            for (int k = 0; k < vertical_.taps; k++) {
+                acc += SampleTraits<T>::to_float(base[k * stride + i]) * (w[k] * norm);
+            }
+            row[i] = acc;
+        }
+    }
+
+    // 横向：每个抽头读取像素所在的 4 个浮点，一次 FMA 完成全部通道，最后按布局重排为 RGBA
+    template <typename Out>
+    LUT_TARGET_AVX2
+    void horizontal_avx2(const float* row, Out* out, uint8_t* out_alpha) const {
+        const int taps = horizontal_.taps;
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 max_value = _mm_set1_ps(255.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128i lanes = _mm_setr_epi32(lane_[0], lane_[1], lane_[2], lane_[3]);
+        for (int x = 0; x < dst_width_; x++) {
+            const float* w = horizontal_.weights.data() + static_cast<size_t>(x) * taps;
+            const float* p = row + horizontal_.start[x] * pixel_step_ + window_;
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < taps; k++) {
+                acc = _mm_fmadd_ps(_mm_loadu_ps(p + k * pixel_step_), _mm_set1_ps(w[k]), acc);
+            }
+            acc = _mm_permutevar_ps(acc, lanes);
+            if constexpr (std::is_same_v<Out, float>) {
+                alignas(16) float values[4];
+                _mm_store_ps(values, _mm_mul_ps(acc, _mm_set1_ps(1.0f / 255.0f)));
+                std::memcpy(out + x * 3, values, sizeof(float) * 3);
+                if (out_alpha) {
+                    out_alpha[x] = static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, values[3] * 255.0f + 0.5f)));
+                }
+            } else {
+                acc = _mm_add_ps(_mm_min_ps(_mm_max_ps(acc, zero), max_value), half);
+                __m128i v = _mm_cvttps_epi32(acc);
+                v = _mm_packus_epi16(_mm_packs_epi32(v, v), v);
+                uint32_t rgba = static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+                std::memcpy(out + x * 3, &rgba, 3);
+                if (out_alpha) {
+                    out_alpha[x] = static_cast<uint8_t>(rgba >> 24);
+                }
+            }
+        }
+    }
+#endif
+
+    ImageView image_;
+    int dst_width_;
+    int dst_height_;
+    int channels_;               // 参与缩放的通道数：RGB 或 RGBA
+    bool gather_ = false;
+    bool simd_ = false;
+    size_t line_len_ = 0;        // 中间行的浮点数个数
+    ptrdiff_t line_begin_ = 0;   // 中间行第 0 个元素相对源行起点的样本偏移
+    ptrdiff_t pixel_step_ = 0;   // 中间行中相邻像素的间隔
+    ptrdiff_t channel_at_[4] = {0, 0, 0, 0};
+    ptrdiff_t window_ = 0;
+    int lane_[4] = {0, 0, 0, 0};
+    ResampleAxis horizontal_;
+    ResampleAxis vertical_;
+};
+
+// 整幅缩放（Out 为 uint8_t 时输出 8 位 RGB，为 float 时输出归一化 RGB；alpha 非空时另写 alpha 平面）
+// 每 kRowsPerTask 行为一个线程池任务，执行线程从自己的暂存区取中间行
+template <typename Out>
+void resize_image(const ImageView& image, Out* dst, int dst_width, int dst_height,
+                  ResampleFilter filter = ResampleFilter::Bilinear, uint8_t* alpha = nullptr) {
+    if (dst_width <= 0 || dst_height <= 0) {
+        return;
+    }
+    const int kRowsPerTask = 8;
+    ScratchScope scope;
+    Resampler resampler(image, dst_width, dst_height, filter);
+    const size_t row_samples = static_cast<size_t>(dst_width) * 3;
+    const int tasks = (dst_height + kRowsPerTask - 1) / kRowsPerTask;
+
+    parallel_for(tasks, [&](int64_t t) {
+        ScratchScope task_scope;
+        float* scratch = task_scope.alloc<float>(resampler.scratch_size());
+        const int y0 = static_cast<int>(t) * kRowsPerTask;
+        const int y1 = std::min(dst_height, y0 + kRowsPerTask);
+        resampler.rows(y0, y1, dst + y0 * row_samples, alpha ? alpha + static_cast<size_t>(y0) * dst_width : nullptr,
+                       scratch);
+    });
+}
+
+// 与 SampleTraits<uint8_t>::from_unit 和定点内核一致，四舍五入而不是截断
+inline uint8_t float_to_u8(float v) {
+    return static_cast<uint8_t>(std::max(0.0f, std::min(255.0f, v * 255.0f)) + 0.5f);
+}
+
+// 标量内核：对连续 RGB 像素应用 LUT
+template <Interpolation Mode>
+void apply_lut_span_scalar(const LUTData& lut, const uint8_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* s = src + i * 3;
+        uint8_t* d = dst + i * 3;
+        float out_r, out_g, out_b;
+        if (!lut.is_3d) {
+            apply_1d_lut(lut, s[0] / 255.0f, s[1] / 255.0f, s[2] / 255.0f, out_r, out_g, out_b);
+        } else if (Mode == Interpolation::Tetrahedral) {
+            apply_3d_lut_tetrahedral(lut, s[0] / 255.0f, s[1] / 255.0f, s[2] / 255.0f, out_r, out_g, out_b);
+        } else {
+            apply_3d_lut(lut, s[0] / 255.0f, s[1] / 255.0f, s[2] / 255.0f, out_r, out_g, out_b);
+        }
+        d[0] = float_to_u8(out_r);
+        d[1] = float_to_u8(out_g);
+        d[2] = float_to_u8(out_b);
+    }
+}
+
+// 标量内核：对连续的归一化浮点 RGB 应用 LUT，输出 LUT 原始值（不截断），src 与 dst 可以相同
+template <Interpolation Mode>
+void apply_lut_span_f32_scalar(const LUTData& lut, const float* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const float* s = src + i * 3;
+        float* d = dst + i * 3;
+        float out_r, out_g, out_b;
+        if (!lut.is_3d) {
+            apply_1d_lut(lut, s[0], s[1], s[2], out_r, out_g, out_b);
+        } else if (Mode == Interpolation::Tetrahedral) {
+            apply_3d_lut_tetrahedral(lut, s[0], s[1], s[2], out_r, out_g, out_b);
+        } else {
+            apply_3d_lut(lut, s[0], s[1], s[2], out_r, out_g, out_b);
+        }
+        d[0] = out_r;
+        d[1] = out_g;
+        d[2] = out_b;
+    }
+}
+
+#if LUT_HAS_X86
+// 8 个像素的 3D LUT 求值：fr/fg/fb 为格点坐标（已乘以 size - 1 并限制在格点范围内），out 为 LUT 原始值
+// 三线性取 8 个角点；四面体用比较 + 混合无分支地选出 4 个角点
+template <Interpolation Mode>
+LUT_TARGET_AVX2
+inline void eval_3d_lut_avx2(const LUTData& lut, __m256 fr, __m256 fg, __m256 fb, __m256 out[3]) {
+    const int size = lut.size;
+    const __m256i max_base = _mm256_set1_epi32(size - 2);
+    const __m256i stride_g = _mm256_set1_epi32(size);
+    const __m256i stride_b = _mm256_set1_epi32(size * size);
+    const __m256i one = _mm256_set1_epi32(1);
+
+    __m256i ir = _mm256_min_epi32(_mm256_cvttps_epi32(fr), max_base);
+    __m256i ig = _mm256_min_epi32(_mm256_cvttps_epi32(fg), max_base);
+    __m256i ib = _mm256_min_epi32(_mm256_cvttps_epi32(fb), max_base);
+
+    __m256 dr = _mm256_sub_ps(fr, _mm256_cvtepi32_ps(ir));
+    __m256 dg = _mm256_sub_ps(fg, _mm256_cvtepi32_ps(ig));
+    __m256 db = _mm256_sub_ps(fb, _mm256_cvtepi32_ps(ib));
+
+    __m256i o000 = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(ib, stride_b),
+                                                     _mm256_mullo_epi32(ig, stride_g)), ir);
+
+    if (Mode == Interpolation::Tetrahedral) {
+        const __m256i diag = _mm256_set1_epi32(1 + size + size * size);
+        __m256 w_max = _mm256_max_ps(_mm256_max_ps(dr, dg), db);
+        __m256 w_min = _mm256_min_ps(_mm256_min_ps(dr, dg), db);
+        __m256 w_mid = _mm256_max_ps(_mm256_min_ps(dr, dg), _mm256_min_ps(_mm256_max_ps(dr, dg), db));
+
+        // 最大分量所在轴（优先 r、g、b）与最小分量所在轴（优先 b、g、r），二者必不相同
+        __m256i r_is_max = _mm256_castps_si256(_mm256_and_ps(_mm256_cmp_ps(dr, dg, _CMP_GE_OQ),
+                                                              _mm256_cmp_ps(dr, db, _CMP_GE_OQ)));
+        __m256i g_ge_b = _mm256_castps_si256(_mm256_cmp_ps(dg, db, _CMP_GE_OQ));
+        __m256i off_max = _mm256_blendv_epi8(_mm256_blendv_epi8(stride_b, stride_g, g_ge_b), one, r_is_max);
+
+        __m256i b_is_min = _mm256_castps_si256(_mm256_and_ps(_mm256_cmp_ps(db, dg, _CMP_LE_OQ),
+                                                              _mm256_cmp_ps(db, dr, _CMP_LE_OQ)));
+        __m256i g_le_r = _mm256_castps_si256(_mm256_cmp_ps(dg, dr, _CMP_LE_OQ));
+        __m256i off_min = _mm256_blendv_epi8(_mm256_blendv_epi8(one, stride_g, g_le_r), stride_b, b_is_min);
+
+        __m256i o111 = _mm256_add_epi32(o000, diag);
+        __m256i o1 = _mm256_add_epi32(o000, off_max);
+        __m256i o2 = _mm256_sub_epi32(o111, off_min);
+
+        __m256 w0 = _mm256_sub_ps(_mm256_set1_ps(1.0f), w_max);
+        __m256 w1 = _mm256_sub_ps(w_max, w_mid);
+        __m256 w2 = _mm256_sub_ps(w_mid, w_min);
+
+        for (int c = 0; c < 3; c++) {
+            const float* p = lut.plane(c);
+            __m256 v = _mm256_mul_ps(_mm256_i32gather_ps(p, o000, 4), w0);
+            v = _mm256_fmadd_ps(_mm256_i32gather_ps(p, o1, 4), w1, v);
+            v = _mm256_fmadd_ps(_mm256_i32gather_ps(p, o2, 4), w2, v);
+            out[c] = _mm256_fmadd_ps(_mm256_i32gather_ps(p, o111, 4), w_min, v);
+        }
+    } else {
+        __m256i o100 = _mm256_add_epi32(o000, one);
+        __m256i o010 = _mm256_add_epi32(o000, stride_g);
+        __m256i o110 = _mm256_add_epi32(o010, one);
+        __m256i o001 = _mm256_add_epi32(o000, stride_b);
+        __m256i o101 = _mm256_add_epi32(o001, one);
+        __m256i o011 = _mm256_add_epi32(o001, stride_g);
+        __m256i o111 = _mm256_add_epi32(o011, one);
+
+        for (int c = 0; c < 3; c++) {
+            const float* p = lut.plane(c);
+            __m256 v000 = _mm256_i32gather_ps(p, o000, 4);
+            __m256 v100 = _mm256_i32gather_ps(p, o100, 4);
+            __m256 v010 = _mm256_i32gather_ps(p, o010, 4);
+            __m256 v110 = _mm256_i32gather_ps(p, o110, 4);
+            __m256 v001 = _mm256_i32gather_ps(p, o001, 4);
+            __m256 v101 = _mm256_i32gather_ps(p, o101, 4);
+            __m256 v011 = _mm256_i32gather_ps(p, o011, 4);
+            __m256 v111 = _mm256_i32gather_ps(p, o111, 4);
+
+            __m256 c00 = _mm256_fmadd_ps(_mm256_sub_ps(v100, v000), dr, v000);
+            __m256 c10 = _mm256_fmadd_ps(_mm256_sub_ps(v110, v010), dr, v010);
+            __m256 c01 = _mm256_fmadd_ps(_mm256_sub_ps(v101, v001), dr, v001);
+            __m256 c11 = _mm256_fmadd_ps(_mm256_sub_ps(v111, v011), dr, v011);
+            __m256 c0 = _mm256_fmadd_ps(_mm256_sub_ps(c10, c00), dg, c00);
+            __m256 c1 = _mm256_fmadd_ps(_mm256_sub_ps(c11, c01), dg, c01);
+            out[c] = _mm256_fmadd_ps(_mm256_sub_ps(c1, c0), db, c0);
+        }
+    }
+}
+
+// AVX2 内核：每次处理 8 个像素，从 SoA 平面 gather 角点后插值
+template <Interpolation Mode>
+LUT_TARGET_AVX2
+void apply_3d_lut_span_avx2(const LUTData& lut, const uint8_t* src, uint8_t* dst, size_t count) {
+    const __m256 scale = _mm256_set1_ps((lut.size - 1) / 255.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 max_value = _mm256_set1_ps(255.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+
+    alignas(32) int32_t lanes[3][8];
+    alignas(32) int32_t results[3][8];
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint8_t* s = src + i * 3;
+        for (int k = 0; k < 8; k++) {
+            lanes[0][k] = s[k * 3];
+            lanes[1][k] = s[k * 3 + 1];
+            lanes[2][k] = s[k * 3 + 2];
+        }
+
+        __m256 fr = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_load_si256(reinterpret_cast<const __m256i*>(lanes[0]))), scale);
+        __m256 fg = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_load_si256(reinterpret_cast<const __m256i*>(lanes[1]))), scale);
+        __m256 fb = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_load_si256(reinterpret_cast<const __m256i*>(lanes[2]))), scale);
+
+        __m256 out[3];
+        eval_3d_lut_avx2<Mode>(lut, fr, fg, fb, out);
+        for (int c = 0; c < 3; c++) {
+            __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(out[c], max_value), zero), max_value);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(results[c]), _mm256_cvttps_epi32(_mm256_add_ps(v, half)));
+        }
+
+        uint8_t* d = dst + i * 3;
+        for (int k = 0; k < 8; k++) {
+            d[k * 3] = static_cast<uint8_t>(results[0][k]);
+            d[k * 3 + 1] = static_cast<uint8_t>(results[1][k]);
+            d[k * 3 + 2] = static_cast<uint8_t>(results[2][k]);
+        }
+    }
+
+    if (i < count) {
+        apply_lut_span_scalar<Mode>(lut, src + i * 3, dst + i * 3, count - i);
+    }
+}
+
+// 浮点版本：输入先截断到 0~1（NaN 视为 0），输出 LUT 原始值
+template <Interpolation Mode>
+LUT_TARGET_AVX2
+void apply_3d_lut_span_f32_avx2(const LUTData& lut, const float* src, float* dst, size_t count) {
+    const __m256 scale = _mm256_set1_ps(static_cast<float>(lut.size - 1));
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    alignas(32) float lanes[3][8];
+    alignas(32) float results[3][8];
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const float* s = src + i * 3;
+        for (int k = 0; k < 8; k++) {
+            lanes[0][k] = s[k * 3];
+            lanes[1][k] = s[k * 3 + 1];
+            lanes[2][k] = s[k * 3 + 2];
+        }
+
+        __m256 coords[3];
+        for (int c = 0; c < 3; c++) {
+            __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_load_ps(lanes[c]), zero), one);
+            coords[c] = _mm256_mul_ps(v, scale);
+        }
+        __m256 out[3];
+        eval_3d_lut_avx2<Mode>(lut, coords[0], coords[1], coords[2], out);
+        for (int c = 0; c < 3; c++) {
+            _mm256_store_ps(results[c], out[c]);
+        }
+
+        float* d = dst + i * 3;
+        for (int k = 0; k < 8; k++) {
+            d[k * 3] = results[0][k];
+            d[k * 3 + 1] = results[1][k];
+            d[k * 3 + 2] = results[2][k];
+        }
+    }
+
+    if (i < count) {
+        apply_lut_span_f32_scalar<Mode>(lut, src + i * 3, dst + i * 3, count - i);
+    }
+}
+#endif
+
+// 定点插值：a + (b - a) * f，f 为 Q15 权重；舍入方式与 _mm256_mulhrs_epi16 完全一致
+inline int fixed_lerp(int a, int b, int f) {
+    return a + (((b - a) * f + 0x4000) >> 15);
+}
+
+inline uint8_t fixed_to_u8(int v) {
+    v = (v + (1 << (kFixedShift - 1))) >> kFixedShift;
+    return static_cast<uint8_t>(std::max(0, std::min(255, v)));
+}
+
+// 四面体的两个中间顶点（格点偏移）与按从大到小排列的三个权重
+// 相等时的取舍固定下来，保证标量与 SIMD 内核逐位一致
+struct FixedTetra {
+    int32_t o1, o2;
+    int f_max, f_mid, f_min;
+};
+
+inline FixedTetra fixed_tetra(const LUTData& lut, const uint8_t* s) {
+    const int f[3] = {lut.fixed_frac[s[0]], lut.fixed_frac[s[1]], lut.fixed_frac[s[2]]};
+    const int32_t stride[3] = {1, lut.size, lut.size * lut.size};
+    int hi = f[0] >= f[1] ? (f[0] >= f[2] ? 0 : 2) : (f[1] >= f[2] ? 1 : 2);
+    int lo = f[2] <= f[1] ? (f[2] <= f[0] ? 2 : 0) : (f[1] <= f[0] ? 1 : 0);
+    int mid = 3 - hi - lo;
+    return {stride[hi], stride[hi] + stride[mid], f[hi], f[mid], f[lo]};
+}
+
+inline int32_t fixed_base(const LUTData& lut, const uint8_t* s) {
+    return (lut.fixed_index[s[2]] * lut.size + lut.fixed_index[s[1]]) * lut.size + lut.fixed_index[s[0]];
+}
+
+// 标量定点内核：8 位输入、8 位输出，全程整数运算
+template <Interpolation Mode>
+void apply_lut_span_fixed_scalar(const LUTData& lut, const uint8_t* src, uint8_t* dst, size_t count) {
+    const int16_t* lattice = lut.fixed_data;
+    const int32_t sg = lut.size;
+    const int32_t sb = lut.size * lut.size;
+    const int32_t diag = 1 + sg + sb;
+
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* s = src + i * 3;
+        uint8_t* d = dst + i * 3;
+        const int16_t* p = lattice + static_cast<size_t>(fixed_base(lut, s)) * 4;
+
+        if (Mode == Interpolation::Tetrahedral) {
+            FixedTetra t = fixed_tetra(lut, s);
+            const int16_t* p1 = p + t.o1 * 4;
+            const int16_t* p2 = p + t.o2 * 4;
+            const int16_t* p3 = p + diag * 4;
+            for (int c = 0; c < 3; c++) {
+                int v = p[c] + (((p1[c] - p[c]) * t.f_max + 0x4000) >> 15)
+                             + (((p2[c] - p1[c]) * t.f_mid + 0x4000) >> 15)
+                             + (((p3[c] - p2[c]) * t.f_min + 0x4000) >> 15);
+                d[c] = fixed_to_u8(v);
+            }
+        } else {
+            const int fr = lut.fixed_frac[s[0]];
+            const int fg = lut.fixed_frac[s[1]];
+            const int fb = lut.fixed_frac[s[2]];
+            const int16_t* p010 = p + sg * 4;
+            const int16_t* p001 = p + sb * 4;
+            const int16_t* p011 = p + (sg + sb) * 4;
+            for (int c = 0; c < 3; c++) {
+                int c00 = fixed_lerp(p[c], p[4 + c], fr);
+                int c10 = fixed_lerp(p010[c], p010[4 + c], fr);
+                int c01 = fixed_lerp(p001[c], p001[4 + c], fr);
+                int c11 = fixed_lerp(p011[c], p011[4 + c], fr);
+                int c0 = fixed_lerp(c00, c10, fg);
+                int c1 = fixed_lerp(c01, c11, fg);
+                d[c] = fixed_to_u8(fixed_lerp(c0, c1, fb));
+            }
+        }
+    }
+}
+
+#if LUT_HAS_X86
+LUT_TARGET_AVX2
+inline __m256i fixed_lerp_avx2(__m256i a, __m256i b, __m256i f) {
+    return _mm256_add_epi16(a, _mm256_mulhrs_epi16(_mm256_sub_epi16(b, a), f));
+}
+
+// 把 4 个像素的 32 位权重各自复制到 64 位内的 4 个 16 位通道，与 RGBX 格点对齐
+LUT_TARGET_AVX2
+inline __m256i fixed_weights_avx2(__m128i w) {
+    __m256i x = _mm256_cvtepu32_epi64(w);
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, 0), 0);
+}
+
+// AVX2 定点内核：每次处理 8 个像素，分两组各 4 个像素
+// 每次 64 位 gather 取回一个格点的 RGBX，16 位通道内用 mulhrs 完成插值
+template <Interpolation Mode>
+LUT_TARGET_AVX2
+void apply_lut_span_fixed_avx2(const LUTData& lut, const uint8_t* src, uint8_t* dst, size_t count) {
+    const long long* lattice = reinterpret_cast<const long long*>(lut.fixed_data);
+    const int32_t sg = lut.size;
+    const int32_t sb = lut.size * lut.size;
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i stride_g = _mm256_set1_epi32(sg);
+    const __m256i stride_b = _mm256_set1_epi32(sb);
+    const __m256i diag = _mm256_set1_epi32(1 + sg + sb);
+    const __m256i round = _mm256_set1_epi16(1 << (kFixedShift - 1));
+    // 每个 128 位通道内 4 个 RGBX 像素压成 12 字节 RGB
+    const __m256i compact = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                             0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    alignas(32) int32_t index[3][8];
+    alignas(32) int32_t frac[3][8];
+    alignas(32) uint8_t packed[32];
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint8_t* s = src + i * 3;
+        for (int k = 0; k < 8; k++) {
+            for (int c = 0; c < 3; c++) {
+                index[c][k] = lut.fixed_index[s[k * 3 + c]];
+                frac[c][k] = lut.fixed_frac[s[k * 3 + c]];
+            }
+        }
+
+        __m256i ir = _mm256_load_si256(reinterpret_cast<const __m256i*>(index[0]));
+        __m256i ig = _mm256_load_si256(reinterpret_cast<const __m256i*>(index[1]));
+        __m256i ib = _mm256_load_si256(reinterpret_cast<const __m256i*>(index[2]));
+        __m256i fr = _mm256_load_si256(reinterpret_cast<const __m256i*>(frac[0]));
+        __m256i fg = _mm256_load_si256(reinterpret_cast<const __m256i*>(frac[1]));
+        __m256i fb = _mm256_load_si256(reinterpret_cast<const __m256i*>(frac[2]));
+        __m256i o000 = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(ib, stride_b),
+                                                         _mm256_mullo_epi32(ig, stride_g)), ir);
+
+        // 四面体：与 fixed_tetra 相同的取舍规则，用比较 + 混合无分支地选出两个中间顶点
+        __m256i o1, o2, w0, w1, w2;
+        if (Mode == Interpolation::Tetrahedral) {
+            __m256i r_lt_g = _mm256_cmpgt_epi32(fg, fr);
+            __m256i r_lt_b = _mm256_cmpgt_epi32(fb, fr);
+            __m256i g_lt_b = _mm256_cmpgt_epi32(fb, fg);
+            __m256i r_is_max = _mm256_andnot_si256(_mm256_or_si256(r_lt_g, r_lt_b), _mm256_set1_epi32(-1));
+            __m256i off_max = _mm256_blendv_epi8(_mm256_blendv_epi8(stride_g, stride_b, g_lt_b), one, r_is_max);
+            __m256i b_is_min = _mm256_andnot_si256(_mm256_or_si256(g_lt_b, r_lt_b), _mm256_set1_epi32(-1));
+            __m256i off_min = _mm256_blendv_epi8(_mm256_blendv_epi8(stride_g, one, r_lt_g), stride_b, b_is_min);
+
+            o1 = _mm256_add_epi32(o000, off_max);
+            o2 = _mm256_sub_epi32(_mm256_add_epi32(o000, diag), off_min);
+            w0 = _mm256_max_epi32(_mm256_max_epi32(fr, fg), fb);
+            w2 = _mm256_min_epi32(_mm256_min_epi32(fr, fg), fb);
+            w1 = _mm256_max_epi32(_mm256_min_epi32(fr, fg), _mm256_min_epi32(_mm256_max_epi32(fr, fg), fb));
+        } else {
+            o1 = o2 = o000;
+            w0 = fr;
+            w1 = fg;
+            w2 = fb;
+        }
+
+        __m256i result[2];
+        for (int g = 0; g < 2; g++) {
+            __m128i b0 = g ? _mm256_extracti128_si256(o000, 1) : _mm256_castsi256_si128(o000);
+            __m256i f0 = fixed_weights_avx2(g ? _mm256_extracti128_si256(w0, 1) : _mm256_castsi256_si128(w0));
+            __m256i f1 = fixed_weights_avx2(g ? _mm256_extracti128_si256(w1, 1) : _mm256_castsi256_si128(w1));
+            __m256i f2 = fixed_weights_avx2(g ? _mm256_extracti128_si256(w2, 1) : _mm256_castsi256_si128(w2));
+            __m256i v;
+
+            if (Mode == Interpolation::Tetrahedral) {
+                __m128i i1 = g ? _mm256_extracti128_si256(o1, 1) : _mm256_castsi256_si128(o1);
+                __m128i i2 = g ? _mm256_extracti128_si256(o2, 1) : _mm256_castsi256_si128(o2);
+                __m256i c0 = _mm256_i32gather_epi64(lattice, b0, 8);
+                __m256i c1 = _mm256_i32gather_epi64(lattice, i1, 8);
+                __m256i c2 = _mm256_i32gather_epi64(lattice, i2, 8);
+                __m256i c3 = _mm256_i32gather_epi64(lattice, _mm_add_epi32(b0, _mm256_castsi256_si128(diag)), 8);
+                v = _mm256_add_epi16(c0, _mm256_mulhrs_epi16(_mm256_sub_epi16(c1, c0), f0));
+                v = _mm256_add_epi16(v, _mm256_mulhrs_epi16(_mm256_sub_epi16(c2, c1), f1));
+                v = _mm256_add_epi16(v, _mm256_mulhrs_epi16(_mm256_sub_epi16(c3, c2), f2));
+            } else {
+                const __m128i o_r = _mm256_castsi256_si128(one);
+                __m128i b010 = _mm_add_epi32(b0, _mm256_castsi256_si128(stride_g));
+                __m128i b001 = _mm_add_epi32(b0, _mm256_castsi256_si128(stride_b));
+                __m128i b011 = _mm_add_epi32(b001, _mm256_castsi256_si128(stride_g));
+                __m256i v000 = _mm256_i32gather_epi64(lattice, b0, 8);
+                __m256i v100 = _mm256_i32gather_epi64(lattice, _mm_add_epi32(b0, o_r), 8);
+                __m256i v010 = _mm256_i32gather_epi64(lattice, b010, 8);
+                __m256i v110 = _mm256_i32gather_epi64(lattice, _mm_add_epi32(b010, o_r), 8);
+                __m256i v001 = _mm256_i32gather_epi64(lattice, b001, 8);
+                __m256i v101 = _mm256_i32gather_epi64(lattice, _mm_add_epi32(b001, o_r), 8);
+                __m256i v011 = _mm256_i32gather_epi64(lattice, b011, 8);
+                __m256i v111 = _mm256_i32gather_epi64(lattice, _mm_add_epi32(b011, o_r), 8);
+
+                __m256i c00 = fixed_lerp_avx2(v000, v100, f0);
+                __m256i c10 = fixed_lerp_avx2(v010, v110, f0);
+                __m256i c01 = fixed_lerp_avx2(v001, v101, f0);
+                __m256i c11 = fixed_lerp_avx2(v011, v111, f0);
+                __m256i c0 = fixed_lerp_avx2(c00, c10, f1);
+                __m256i c1 = fixed_lerp_avx2(c01, c11, f1);
+                v = fixed_lerp_avx2(c0, c1, f2);
+            }
+            result[g] = _mm256_srai_epi16(_mm256_adds_epi16(v, round), kFixedShift);
+        }
+
+        // packus 按 128 位通道交错两组结果，重排回像素 0..7 的顺序后压成 RGB
+        __m256i bytes = _mm256_packus_epi16(result[0], result[1]);
+        bytes = _mm256_permute4x64_epi64(bytes, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(packed), _mm256_shuffle_epi8(bytes, compact));
+
+        uint8_t* d = dst + i * 3;
+        std::memcpy(d, packed, 12);
+        std::memcpy(d + 12, packed + 16, 12);
+    }
+
+    if (i < count) {
+        apply_lut_span_fixed_scalar<Mode>(lut, src + i * 3, dst + i * 3, count - i);
+    }
+}
+#endif
+
+// 对连续 RGB 像素应用 LUT，按插值方式与 CPU 能力选择内核；src 与 dst 可以相同（原地处理）
+template <Interpolation Mode>
+void apply_lut_span_mode(const LUTData& lut, const uint8_t* src, uint8_t* dst, size_t count) {
+    // 8 位进、8 位出：优先使用定点格点，格点带宽减半且插值走 16 位通道
+    if (lut.has_fixed()) {
+#if LUT_HAS_X86
+        if (cpu_has_avx2()) {
+            apply_lut_span_fixed_avx2<Mode>(lut, src, dst, count);
+            return;
+        }
+#endif
+        apply_lut_span_fixed_scalar<Mode>(lut, src, dst, count);
+        return;
+    }
+#if LUT_HAS_X86
+    if (lut.is_3d && cpu_has_avx2()) {
+        apply_3d_lut_span_avx2<Mode>(lut, src, dst, count);
+        return;
+    }
+#endif
+    apply_lut_span_scalar<Mode>(lut, src, dst, count);
+}
+
+void apply_lut_span(const LUTData& lut, const uint8_t* src, uint8_t* dst, size_t count,
+                    Interpolation interpolation = Interpolation::Trilinear) {
+    if (interpolation == Interpolation::Tetrahedral) {
+        apply_lut_span_mode<Interpolation::Tetrahedral>(lut, src, dst, count);
+    } else {
+        apply_lut_span_mode<Interpolation::Trilinear>(lut, src, dst, count);
+    }
+}
+
+// 对连续的归一化浮点 RGB 应用 LUT（高位深路径），src 与 dst 可以相同
+template <Interpolation Mode>
+void apply_lut_span_f32_mode(const LUTData& lut, const float* src, float* dst, size_t count) {
+#if LUT_HAS_X86
+    if (lut.is_3d && cpu_has_avx2()) {
+        apply_3d_lut_span_f32_avx2<Mode>(lut, src, dst, count);
+        return;
+    }
+#endif
+    apply_lut_span_f32_scalar<Mode>(lut, src, dst, count);
+}
+
+void apply_lut_span_f32(const LUTData& lut, const float* src, float* dst, size_t count,
+                        Interpolation interpolation = Interpolation::Trilinear) {
+    if (interpolation == Interpolation::Tetrahedral) {
+        apply_lut_span_f32_mode<Interpolation::Tetrahedral>(lut, src, dst, count);
+    } else {
+        apply_lut_span_f32_mode<Interpolation::Trilinear>(lut, src, dst, count);
+    }
+}
+
+// 每个行带的目标大小：足够小以留在 L2 中，又足够大以摊薄调度开销
+const size_t kPreviewTileBytes = 256 * 1024;
+
+int preview_tile_rows(int output_width) {
+    size_t row_bytes = static_cast<size_t>(output_width) * 3;
+    return static_cast<int>(std::max<size_t>(1, std::min<size_t>(64, kPreviewTileBytes / row_bytes)));
+}
+
+// 从任意布局的一行中取出 width 个像素，写成紧凑的 RGB
+void load_rgb_row(const ImageView& image, int y, uint8_t* rgb) {
+    const uint8_t* src = image.row(y);
+    const ptrdiff_t step = image.pixel_stride;
+    const ptrdiff_t r = image.offset[0];
+    const ptrdiff_t g = image.offset[1];
+    const ptrdiff_t b = image.offset[2];
+    for (int x = 0; x < image.width; x++) {
+        const uint8_t* px = src + x * step;
+        rgb[x * 3] = px[r];
+        rgb[x * 3 + 1] = px[g];
+        rgb[x * 3 + 2] = px[b];
+    }
+}
+
+// 按输入的通道顺序写出紧凑的一行：RGB 取自 rgb，alpha 从源行原样复制，填充字节写 255
+void store_row_like(const ImageView& image, int y, const uint8_t* rgb, uint8_t* out) {
+    const int channels = image.layout.channels;
+    const int* index = image.layout.index;
+    if (channels == 3 && index[0] == 0 && index[1] == 1 && index[2] == 2) {
+        std::memcpy(out, rgb, static_cast<size_t>(image.width) * 3);
+        return;
+    }
+    const uint8_t* src = image.row(y);
+    for (int x = 0; x < image.width; x++) {
+        uint8_t* px = out + x * channels;
+        if (channels == 4) {
+            px[3] = 255;
+        }
+        px[index[0]] = rgb[x * 3];
+        px[index[1]] = rgb[x * 3 + 1];
+        px[index[2]] = rgb[x * 3 + 2];
+        if (index[3] >= 0) {
+            px[index[3]] = src[x * image.pixel_stride + image.offset[3]];
+        }
+    }
+}
+
+// 以原始分辨率应用 LUT，输出为与输入通道顺序相同的紧凑数组
+// 每个行带是一个线程池任务：紧凑 RGB 输入直接逐行送入内核；
+// 其余布局把行带取出到执行线程暂存区中的小缓冲，映射后再按原布局写回
+void apply_lut_to_image(const LUTData& lut, const ImageView& image, uint8_t* dst,
+                        Interpolation interpolation = Interpolation::Trilinear) {
+    const int width = image.width;
+    const int height = image.height;
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    const size_t out_row_bytes = static_cast<size_t>(width) * image.layout.channels;
+    const size_t rgb_row_bytes = static_cast<size_t>(width) * 3;
+    const bool direct = image.is_packed_rgb();
+    const bool apply = lut.is_valid();
+    const int band = preview_tile_rows(width);
+    const int bands = (height + band - 1) / band;
+
+    parallel_for(bands, [&](int64_t t) {
+        const int y0 = static_cast<int>(t) * band;
+        const int y1 = std::min(height, y0 + band);
+        if (direct) {
+            for (int y = y0; y < y1; y++) {
+                uint8_t* out = dst + y * out_row_bytes;
+                if (apply) {
+                    apply_lut_span(lut, image.row(y), out, static_cast<size_t>(width), interpolation);
+                } else {
+                    std::memcpy(out, image.row(y), rgb_row_bytes);
+                }
+            }
+            return;
+        }
+        ScratchScope task_scope;
+        uint8_t* tile = task_scope.alloc<uint8_t>(static_cast<size_t>(band) * rgb_row_bytes);
+        for (int y = y0; y < y1; y++) {
+            load_rgb_row(image, y, tile + (y - y0) * rgb_row_bytes);
+        }
+        if (apply) {
+            apply_lut_span(lut, tile, tile, static_cast<size_t>(y1 - y0) * width, interpolation);
+        }
+        for (int y = y0; y < y1; y++) {
+            store_row_like(image, y, tile + (y - y0) * rgb_row_bytes, dst + y * out_row_bytes);
+        }
+    });
+}
+
+// 从任意布局、任意样本类型的一行中取出归一化的浮点 RGB
+template <typename In>
+void load_unit_rgb_row(const ImageView& image, int y, float* rgb) {
+    const In* src = image.row<In>(y);
+    const ptrdiff_t step = image.pixel_stride;
+    const ptrdiff_t r = image.offset[0];
+    const ptrdiff_t g = image.offset[1];
+    const ptrdiff_t b = image.offset[2];
+    for (int x = 0; x < image.width; x++) {
+        const In* px = src + x * step;
+        rgb[x * 3] = sample_to_unit(px[r]);
+        rgb[x * 3 + 1] = sample_to_unit(px[g]);
+        rgb[x * 3 + 2] = sample_to_unit(px[b]);
+    }
+}
+
+// 按输入的通道顺序写出 Out 类型的紧凑一行：alpha 从源行换算后复制，填充通道写满量程
+template <typename In, typename Out>
+void store_unit_row_like(const ImageView& image, int y, const float* rgb, Out* out) {
+    const int channels = image.layout.channels;
+    const int* index = image.layout.index;
+    const In* src = image.row<In>(y);
+    const Out opaque = SampleTraits<Out>::from_unit(1.0f);
+    for (int x = 0; x < image.width; x++) {
+        Out* px = out + x * channels;
+        if (channels == 4) {
+            px[3] = opaque;
+        }
+        px[index[0]] = SampleTraits<Out>::from_unit(rgb[x * 3]);
+        px[index[1]] = SampleTraits<Out>::from_unit(rgb[x * 3 + 1]);
+        px[index[2]] = SampleTraits<Out>::from_unit(rgb[x * 3 + 2]);
+        if (index[3] >= 0) {
+            px[index[3]] = SampleTraits<Out>::from_unit(sample_to_unit(src[x * image.pixel_stride + image.offset[3]]));
+        }
+    }
+}
+
+// 高位深/浮点路径：按行带转换为归一化浮点 RGB，在浮点内核中应用 LUT 后直接转换为输出类型，中间不经过 8 位量化
+template <typename In, typename Out>
+void apply_lut_to_image_wide(const LUTData& lut, const ImageView& image, Out* dst,
+                             Interpolation interpolation = Interpolation::Trilinear) {
+    const int width = image.width;
+    const int height = image.height;
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    const size_t out_row_samples = static_cast<size_t>(width) * image.layout.channels;
+    const size_t rgb_row_samples = static_cast<size_t>(width) * 3;
+    const bool apply = lut.is_valid();
+    // 浮点行是 8 位行的 4 倍大，行带相应缩短以留在 L2 中
+    const int band = std::max(1, preview_tile_rows(width) / 4);
+    const int bands = (height + band - 1) / band;
+
+    parallel_for(bands, [&](int64_t t) {
+        ScratchScope task_scope;
+        float* tile = task_scope.alloc<float>(static_cast<size_t>(band) * rgb_row_samples);
+        const int y0 = static_cast<int>(t) * band;
+        const int y1 = std::min(height, y0 + band);
+        for (int y = y0; y < y1; y++) {
+            load_unit_rgb_row<In>(image, y, tile + (y - y0) * rgb_row_samples);
+        }
+        if (apply) {
+            apply_lut_span_f32(lut, tile, tile, static_cast<size_t>(y1 - y0) * width, interpolation);
+        }
+        for (int y = y0; y < y1; y++) {
+            store_unit_row_like<In, Out>(image, y, tile + (y - y0) * rgb_row_samples,
+                                         dst + y * out_row_samples);
+        }
+    });
+}
+
+// 按输入与输出的样本类型选择实现，dst 按 output 类型解释；8 位进 8 位出仍走定点/8 位内核
+void apply_lut_to_image_typed(const LUTData& lut, const ImageView& image, void* dst, SampleType output,
+                              Interpolation interpolation = Interpolation::Trilinear) {
+    if (image.sample == SampleType::U8 && output == SampleType::U8) {
+        apply_lut_to_image(lut, image, static_cast<uint8_t*>(dst), interpolation);
+        return;
+    }
+    dispatch_sample(image.sample, [&](auto in) {
+        dispatch_sample(output, [&](auto out) {
+            using In = decltype(in);
+            using Out = decltype(out);
+            apply_lut_to_image_wide<In, Out>(lut, image, static_cast<Out*>(dst), interpolation);
+        });
+    });
+}
+
+// ============================================================================
+// LUT 合成与导出
+// ============================================================================
+
+// 依次用链上每个 LUT（1D/3D 均可）映射 size³ 个单位格点，烘焙为一个 3D LUT；
+// 中间结果保持浮点，不在各级之间量化，播放/预览时只需查一次表
+std::shared_ptr<LUTData> compose_lut_chain(const std::vector<LUTHandle>& chain, int size,
+                                           Interpolation interpolation, const std::string& title) {
+    if (chain.empty()) {
+        throw std::runtime_error("LUT chain is empty");
+    }
+    if (size < 2 || size > kMaxLut3DSize) {
+        throw std::runtime_error("LUT size must be between 2 and " + std::to_string(kMaxLut3DSize));
+    }
+
+    auto result = std::make_shared<LUTData>();
+    result->is_3d = true;
+    result->size = size;
+    if (title.empty()) {
+        for (const LUTHandle& lut : chain) {
+            if (!result->title.empty()) result->title += " + ";
+            result->title += lut->title;
+        }
+    } else {
+        result->title = title;
+    }
+
+    // 按 .cube 约定 R 变化最快；每个 B 平面作为一个任务，原地逐级映射
+    const size_t plane = static_cast<size_t>(size) * size;
+    result->data_3d.resize(plane * size * 3);
+    const float scale = 1.0f / (size - 1);
+    float* data = result->data_3d.data();
+    parallel_for(size, [&](int64_t b) {
+        float* slice = data + static_cast<size_t>(b) * plane * 3;
+        float* p = slice;
+        for (int g = 0; g < size; g++) {
+            for (int r = 0; r < size; r++) {
+                *p++ = r * scale;
+                *p++ = g * scale;
+                *p++ = static_cast<float>(b) * scale;
+            }
+        }
+        for (const LUTHandle& lut : chain) {
+            apply_lut_span_f32(*lut, slice, slice, plane, interpolation);
+        }
+    });
+
+    result->build_tables();
+    return result;
+}
+
+// 将 LUT 重采样到 size 个格点：3D 在新格点上对原格点插值，1D 仍输出 1D
+std::shared_ptr<LUTData> resample_lut_data(const LUTHandle& lut, int size, Interpolation interpolation) {
+    if (lut->is_3d) {
+        return compose_lut_chain({lut}, size, interpolation, lut->title);
+    }
+    if (size < 2 || size > kMaxLut1DSize) {
+        throw std::runtime_error("1D LUT size must be between 2 and " + std::to_string(kMaxLut1DSize));
+    }
+
+    auto result = std::make_shared<LUTData>();
+    result->is_3d = false;
+    result->size = size;
+    result->title = lut->title;
+    result->data_1d.resize(static_cast<size_t>(size) * 3);
+    const float scale = 1.0f / (size - 1);
+    for (size_t i = 0; i < result->data_1d.size(); i++) {
+        result->data_1d[i] = static_cast<float>(i / 3) * scale;
+    }
+    apply_lut_span_f32(*lut, result->data_1d.data(), result->data_1d.data(), size, interpolation);
+    result->build_tables();
+    return result;
+}
+
+// 以 .cube 文本写出 LUT（6 位小数）
+void write_cube_file(const LUTData& lut, const std::string& file_path) {
+    if (!lut.is_valid()) {
+        throw std::runtime_error("Cannot write invalid LUT");
+    }
+
+    // 映射自二进制缓存的 3D LUT 没有交错数据，由 SoA 平面还原
+    std::vector<float> gathered;
+    if (lut.is_3d && lut.data_3d.empty()) {
+        const size_t count = static_cast<size_t>(lut.size) * lut.size * lut.size;
+        gathered.resize(count * 3);
+        for (size_t i = 0; i < count; i++) {
+            for (int c = 0; c < 3; c++) {
+                gathered[i * 3 + c] = lut.plane(c)[i];
+            }
+        }
+    }
+    const std::vector<float>& values = !gathered.empty() ? gathered : lut.is_3d ? lut.data_3d : lut.data_1d;
+
+    std::string text;
+    text.reserve(values.size() / 3 * 28 + 256);
+    if (!lut.title.empty()) {
+        std::string title = lut.title;
+        title.erase(std::remove(title.begin(), title.end(), '"'), title.end());
+        text += "TITLE \"" + title + "\"\n";
+    }
+    text += (lut.is_3d ? "LUT_3D_SIZE " : "LUT_1D_SIZE ") + std::to_string(lut.size) + "\n";
+
+    char line[96];
+    for (size_t i = 0; i < values.size(); i += 3) {
+        int n = std::snprintf(line, sizeof(line), "%.6f %.6f %.6f\n", values[i], values[i + 1], values[i + 2]);
+        text.append(line, static_cast<size_t>(n));
+    }
+
+    write_file_atomic(file_path, [&](std::ofstream& file) {
+        file.write(text.data(), static_cast<std::streamsize>(text.size()));
+    });
+}
+
+// ============================================================================
+// 预览缓存（按内容寻址）
+// ============================================================================
+
+// 缓存键由 LUT 格点、参考图像像素、输出尺寸与格式、插值与缩放方式共同决定，
+// 任一输入变化都会得到新键，旧条目自然失效，无需按 LUT id 手动清理
+const uint32_t kPreviewCacheVersion = 2;
+
+// LUT 内容哈希在构建表或映射二进制缓存时已算好，查缓存不再读遍格点
+uint64_t lut_content_hash(const LUTData& lut) {
+    return lut.content_hash;
+}
+
+// 参考图像哈希：样本类型、尺寸、通道布局与逐行像素。像素连续存放时整行一次写入，
+// 否则逐样本写入；同一内容换一种步长得到不同的键，只会多一次未命中
+uint64_t image_content_hash(const ImageView& image) {
+    XXH64 hash;
+    const int components = image.has_alpha() ? 4 : 3;
+    hash.update_value(static_cast<uint32_t>(image.sample));
+    hash.update_value(image.width);
+    hash.update_value(image.height);
+    hash.update_value(components);
+    ptrdiff_t span = 0;
+    for (int c = 0; c < components; c++) {
+        hash.update_value(static_cast<int64_t>(image.offset[c]));
+        span = std::max(span, image.offset[c] + 1);
+    }
+    const size_t item = sample_size(image.sample);
+    const bool dense = image.pixel_stride > 0 && image.offset[0] >= 0 && image.offset[1] >= 0 &&
+                       image.offset[2] >= 0 && (components == 3 || image.offset[3] >= 0) &&
+                       span <= image.pixel_stride;
+    for (int y = 0; y < image.height; y++) {
+        const uint8_t* row = static_cast<const uint8_t*>(image.data) + y * image.row_stride * static_cast<ptrdiff_t>(item);
+        if (dense) {
+            hash.update(row, (static_cast<size_t>(image.width - 1) * image.pixel_stride + span) * item);
+            continue;
+        }
+        for (int x = 0; x < image.width; x++) {
+            const uint8_t* pixel = row + x * image.pixel_stride * static_cast<ptrdiff_t>(item);
+            for (int c = 0; c < components; c++) {
+                hash.update(pixel + image.offset[c] * static_cast<ptrdiff_t>(item), item);
+            }
+        }
+    }
+    return hash.digest();
+}
+
+// 调用方传入的参考图像键（image_content_key 的结果）；为 0 时现算
+uint64_t resolve_image_key(const ImageView& image, uint64_t image_key) {
+    return image_key != 0 ? image_key : image_content_hash(image);
+}
+
+uint64_t preview_cache_key(uint64_t lut_hash, uint64_t image_hash, int width, int height, int channels,
+                           ResampleFilter filter, Interpolation interpolation) {
+    XXH64 hash;
+    hash.update_value(kPreviewCacheVersion);
+    hash.update_value(lut_hash);
+    hash.update_value(image_hash);
+    hash.update_value(width);
+    hash.update_value(height);
+    hash.update_value(channels);
+    hash.update_value(static_cast<int32_t>(filter));
+    hash.update_value(static_cast<int32_t>(interpolation));
+    return hash.digest();
+}
+
+// 磁盘条目（<键>.fafp）：文件头 + 按 PNG 方式逐行滤波后的 zlib 流（不含 PNG 分块与校验），
+// 读取时解压并还原滤波，无需完整的 PNG 解码
+const char kPreviewCacheMagic[8] = {'F', 'A', 'F', 'P', 'R', 'E', 'V', '\0'};
+// 写入在生成预览的调用内完成，取最快的压缩级别：照片类卡片比更高级别只大几个百分点；解压速度与级别无关
+const int kPreviewCacheLevel = 1;
+
+// 磁盘层默认上限：256×256 的照片类卡片压缩后约 100~140KB，可容纳约两千张；
+// 即使像素完全不可压缩（RGBA 约 256KB），也能容纳一千张
+const uint64_t kPreviewCacheDefaultDiskLimit = 256ull * 1024 * 1024;
+
+struct PreviewCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t channels;
+    uint32_t width;
+    uint32_t height;
+    uint64_t key;
+    uint64_t payload_bytes;
+};
+
+// 两级预览缓存：内存中按字节预算淘汰的 LRU，以及可选的磁盘目录（写入先落临时文件再替换）。
+// 磁盘命中会提升到内存层并刷新文件修改时间；磁盘层超出字节上限时按修改时间从旧到新删除条目，
+// LUT 改动或删除后留下的孤立条目由此逐步清除。读写失败只当作未命中，不影响预览生成
+class PreviewCache {
+public:
+    static PreviewCache& instance() {
+        static PreviewCache cache;
+        return cache;
+    }
+
+    // 命中时把像素复制到 output（width × height × channels）
+    bool lookup(uint64_t key, int width, int height, int channels, uint8_t* output) {
+        const size_t bytes = static_cast<size_t>(width) * height * channels;
+        std::string dir;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = index_.find(key);
+            if (it != index_.end() && it->second->pixels.size() == bytes) {
+                entries_.splice(entries_.begin(), entries_, it->second);
+                std::memcpy(output, it->second->pixels.data(), bytes);
+                memory_hits_++;
+                return true;
+            }
+            dir = dir_;
+        }
+
+        const std::string path = dir.empty() ? std::string() : entry_path(dir, key);
+        if (!path.empty() && read_entry(path, key, width, height, channels, output)) {
+            std::error_code ec;
+            fs::last_write_time(fs::u8path(path), fs::file_time_type::clock::now(), ec);
+            insert(key, output, bytes);
+            std::lock_guard<std::mutex> lock(mutex_);
+            disk_hits_++;
+            return true;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        misses_++;
+        return false;
+    }
+
+    void store(uint64_t key, int width, int height, int channels, const uint8_t* pixels) {
+        const size_t bytes = static_cast<size_t>(width) * height * channels;
+        insert(key, pixels, bytes);
+        const std::string dir = this->dir();
+        if (dir.empty()) {
+            return;
+        }
+        ScratchScope scope;
+        ScratchVector<uint8_t> payload;
+        {
+            PngRowFilter filter(width, channels);
+            DeflateEncoder deflate(payload, kPreviewCacheLevel);
+            const size_t row_bytes = static_cast<size_t>(width) * channels;
+            for (int y = 0; y < height; y++) {
+                deflate.write(filter.filter(pixels + y * row_bytes, true), filter.filtered_bytes());
+            }
+            deflate.finish();
+        }
+        PreviewCacheHeader header = {};
+        std::memcpy(header.magic, kPreviewCacheMagic, sizeof(header.magic));
+        header.version = kPreviewCacheVersion;
+        header.channels = static_cast<uint32_t>(channels);
+        header.width = static_cast<uint32_t>(width);
+        header.height = static_cast<uint32_t>(height);
+        header.key = key;
+        header.payload_bytes = payload.size();
+        try {
+            write_file_atomic(entry_path(dir, key), [&](std::ofstream& file) {
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+            });
+        } catch (const std::exception&) {
+            return;
+        }
+        bool over_budget;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            disk_writes_++;
+            // 覆盖已有条目时会重复计入，只会让下一次整理提前发生
+            disk_bytes_ += sizeof(header) + payload.size();
+            over_budget = disk_bytes_ > disk_limit_;
+        }
+        if (over_budget) {
+            prune_disk();
+        }
+    }
+
+    // 为空时只使用内存层
+    void set_dir(const std::string& dir) {
+        if (!dir.empty()) {
+            std::error_code ec;
+            fs::create_directories(fs::u8path(dir), ec);
+            if (ec) {
+                throw std::runtime_error("Cannot create preview cache directory: " + dir);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            dir_ = dir;
+            disk_bytes_ = 0;
+        }
+        prune_disk();
+    }
+
+    std::string dir() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dir_;
+    }
+
+    void set_limit(size_t limit_bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        limit_ = limit_bytes;
+        evict_locked();
+    }
+
+    void set_disk_limit(uint64_t limit_bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            disk_limit_ = limit_bytes;
+        }
+        prune_disk();
+    }
+
+    // 统计磁盘层用量，超出上限时删到上限的 3/4，避免之后每次写入都重新扫描目录
+    void prune_disk() {
+        std::lock_guard<std::mutex> prune_lock(prune_mutex_);
+        std::string dir;
+        uint64_t limit;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            dir = dir_;
+            limit = disk_limit_;
+        }
+        if (dir.empty()) {
+            return;
+        }
+        const uint64_t remaining = prune_dir(dir, limit, limit / 4 * 3);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (dir_ == dir) {
+            disk_bytes_ = remaining;
+        }
+    }
+
+    // disk 为 true 时同时删除磁盘目录中的缓存条目
+    void clear(bool disk) {
+        std::string dir;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entries_.clear();
+            index_.clear();
+            bytes_ = 0;
+            dir = dir_;
+            if (disk) {
+                disk_bytes_ = 0;
+            }
+        }
+        if (!disk || dir.empty()) {
+            return;
+        }
+        std::error_code ec;
+        for (fs::directory_iterator it(fs::u8path(dir), ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->path().extension() == ".fafp") {
+                std::error_code remove_ec;
+                fs::remove(it->path(), remove_ec);
+            }
+        }
+    }
+
+    py::dict info() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        py::dict d;
+        d["entries"] = entries_.size();
+        d["bytes"] = bytes_;
+        d["limit"] = limit_;
+        d["memory_hits"] = memory_hits_;
+        d["disk_hits"] = disk_hits_;
+        d["misses"] = misses_;
+        d["disk_writes"] = disk_writes_;
+        d["disk_bytes"] = disk_bytes_;
+        d["disk_limit"] = disk_limit_;
+        d["dir"] = dir_;
+        return d;
+    }
+
+private:
+    struct Entry {
+        uint64_t key;
+        CountedVector<uint8_t> pixels;
+    };
+
+    PreviewCache()
+        : bytes_(0), limit_(32 * 1024 * 1024), memory_hits_(0), disk_hits_(0), misses_(0), disk_writes_(0),
+          disk_bytes_(0), disk_limit_(kPreviewCacheDefaultDiskLimit) {}
+
+    // 汇总目录中 .fafp 条目的字节数；超过 limit 时按修改时间从旧到新删除，直到不超过 target。返回剩余字节数
+    static uint64_t prune_dir(const std::string& dir, uint64_t limit, uint64_t target) {
+        struct File {
+            fs::file_time_type mtime;
+            uint64_t size;
+            fs::path path;
+        };
+        std::vector<File> files;
+        uint64_t total = 0;
+        std::error_code ec;
+        for (fs::directory_iterator it(fs::u8path(dir), ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->path().extension() != ".fafp") {
+                continue;
+            }
+            std::error_code stat_ec;
+            const uint64_t size = it->file_size(stat_ec);
+            if (stat_ec) continue;
+            const fs::file_time_type mtime = it->last_write_time(stat_ec);
+            if (stat_ec) continue;
+            files.push_back({mtime, size, it->path()});
+            total += size;
+        }
+        if (total <= limit) {
+            return total;
+        }
+        std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.mtime < b.mtime; });
+        for (const File& file : files) {
+            if (total <= target) break;
+            std::error_code remove_ec;
+            if (fs::remove(file.path, remove_ec)) {
+                total -= file.size;
+            }
+        }
+        return total;
+    }
+
+    static std::string entry_path(const std::string& dir, uint64_t key) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.fafp", static_cast<unsigned long long>(key));
+        return (fs::u8path(dir) / name).u8string();
+    }
+
+    static bool read_entry(const std::string& path, uint64_t key, int width, int height, int channels,
+                           uint8_t* output) {
+        std::error_code ec;
+        if (!fs::is_regular_file(fs::u8path(path), ec)) {
+            return false;
+        }
+        MappedFile file(path);
+        if (!file.is_open() || file.size() < sizeof(PreviewCacheHeader)) {
+            return false;
+        }
+        PreviewCacheHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, kPreviewCacheMagic, sizeof(header.magic)) != 0 ||
+            header.version != kPreviewCacheVersion || header.key != key ||
+            header.width != static_cast<uint32_t>(width) || header.height != static_cast<uint32_t>(height) ||
+            header.channels != static_cast<uint32_t>(channels) ||
+            header.payload_bytes != file.size() - sizeof(header)) {
+            return false;
+        }
+
+        // 先解压出整幅滤波行，再逐行还原到 output
+        ScratchScope scope;
+        const size_t row_bytes = static_cast<size_t>(width) * channels;
+        const size_t filtered_bytes = (row_bytes + 1) * height;
+        uint8_t* filtered = scope.alloc<uint8_t>(filtered_bytes);
+        const uint8_t* payload = reinterpret_cast<const uint8_t*>(file.data()) + sizeof(header);
+        if (!inflate_zlib(payload, static_cast<size_t>(header.payload_bytes), filtered, filtered_bytes)) {
+            return false;
+        }
+        uint8_t* zero_row = scope.alloc<uint8_t>(row_bytes);
+        std::memset(zero_row, 0, row_bytes);
+        const uint8_t* prev = zero_row;
+        for (int y = 0; y < height; y++) {
+            uint8_t* row = output + y * row_bytes;
+            if (!unfilter_png_row(filtered + y * (row_bytes + 1), prev, row, row_bytes, static_cast<size_t>(channels))) {
+                return false;
+            }
+            prev = row;
+        }
+        return true;
+    }
+
+    void insert(uint64_t key, const uint8_t* pixels, size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            bytes_ -= it->second->pixels.size();
+            entries_.erase(it->second);
+            index_.erase(it);
+        }
+        entries_.push_front({key, CountedVector<uint8_t>(pixels, pixels + bytes)});
+        index_[key] = entries_.begin();
+        bytes_ += bytes;
+        evict_locked();
+    }
+
+    // 至少保留最近使用的一项
+    void evict_locked() {
+        while (bytes_ > limit_ && entries_.size() > 1) {
+            Entry& victim = entries_.back();
+            bytes_ -= victim.pixels.size();
+            index_.erase(victim.key);
+            entries_.pop_back();
+        }
+    }
+
+    std::mutex mutex_;
+    // 条目、链表节点与索引节点都计入 g_heap_allocations：只有写入新条目才会增长，命中内存层不分配
+    using EntryList = std::list<Entry, CountingAllocator<Entry>>;
+    EntryList entries_;
+    std::unordered_map<uint64_t, EntryList::iterator, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                       CountingAllocator<std::pair<const uint64_t, EntryList::iterator>>> index_;
+    size_t bytes_;
+    size_t limit_;
+    uint64_t memory_hits_;
+    uint64_t disk_hits_;
+    uint64_t misses_;
+    uint64_t disk_writes_;
+    uint64_t disk_bytes_;   // 磁盘层字节数：整理时按目录实际统计，之间按写入累加
+    uint64_t disk_limit_;
+    std::string dir_;
+    std::mutex prune_mutex_;  // 同一时间只有一个线程扫描、整理磁盘目录
+};
+
+// ============================================================================
+// 主生成函数
+// ============================================================================
+
+// 按 dtype 确定样本类型：uint8/uint16/float32/float16 直接读取，float64 转为 float32，
+// 其余类型沿用旧行为强制转换为 uint8；发生转换时 image_array 被替换为新数组，由调用方保持存活
+SampleType image_sample_type(py::array& image_array) {
+    const py::dtype dtype = image_array.dtype();
+    const char kind = dtype.kind();
+    const py::ssize_t itemsize = dtype.itemsize();
+    if (kind == 'u' && itemsize == 1) return SampleType::U8;
+    if (kind == 'u' && itemsize == 2) return SampleType::U16;
+    if (kind == 'f' && itemsize == 4) return SampleType::F32;
+    if (kind == 'f' && itemsize == 2) return SampleType::F16;
+    if (kind == 'f') {
+        image_array = py::array_t<float, py::array::forcecast>::ensure(image_array);
+        if (!image_array) throw std::runtime_error("Failed to convert image array to float32");
+        return SampleType::F32;
+    }
+    image_array = py::array_t<uint8_t, py::array::forcecast>::ensure(image_array);
+    if (!image_array) throw std::runtime_error("Failed to convert image array to uint8");
+    return SampleType::U8;
+}
+
+// 在持有 GIL 时从 numpy 数组取出视图；input_format 指定通道顺序，"auto" 按通道数视为 RGB 或 RGBA
+ImageView image_view(py::array& image_array, const std::string& input_format = "auto") {
+    const SampleType sample = image_sample_type(image_array);
+    py::buffer_info buf = image_array.request();
+    if (buf.ndim != 3) {
+        throw std::runtime_error("Image array must be 3D (height, width, channels)");
+    }
+
+    const int channels = static_cast<int>(buf.shape[2]);
+    if (channels != 3 && channels != 4) {
+        throw std::runtime_error("Image must have 3 (RGB) or 4 (RGBA) channels");
+    }
+
+    // 步长换算为样本个数，要求是样本大小的整数倍
+    const py::ssize_t itemsize = static_cast<py::ssize_t>(sample_size(sample));
+    for (int d = 0; d < 3; d++) {
+        if (buf.strides[d] % itemsize != 0) {
+            throw std::runtime_error("Image strides must be multiples of the item size");
+        }
+    }
+
+    ImageView view;
+    view.data = buf.ptr;
+    view.sample = sample;
+    view.height = static_cast<int>(buf.shape[0]);
+    view.width = static_cast<int>(buf.shape[1]);
+    view.layout = parse_input_format(input_format, channels);
+    view.row_stride = static_cast<ptrdiff_t>(buf.strides[0] / itemsize);
+    view.pixel_stride = static_cast<ptrdiff_t>(buf.strides[1] / itemsize);
+    for (int c = 0; c < 4; c++) {
+        int index = view.layout.index[c];
+        view.offset[c] = index >= 0 ? index * static_cast<ptrdiff_t>(buf.strides[2] / itemsize) : 0;
+    }
+    return view;
+}
+
+// 将参考图像缩放到输出尺寸（Dst 为 uint8_t 时为 8 位 RGB，为 float 时为归一化 RGB）；
+// 输入带 alpha 且 alpha 非空时同时输出缩放后的 alpha 平面。结果分配在调用方的 ScratchScope 中
+template <typename Dst>
+ScratchVector<Dst> scale_reference(const ImageView& image, int output_width, int output_height,
+                                   ResampleFilter filter = ResampleFilter::Bilinear,
+                                   ScratchVector<uint8_t>* alpha = nullptr) {
+    if (output_width <= 0 || output_height <= 0) {
+        throw std::runtime_error("Output size must be positive");
+    }
+    const size_t pixel_count = static_cast<size_t>(output_width) * static_cast<size_t>(output_height);
+    ScratchVector<Dst> scaled_data(pixel_count * 3);
+    uint8_t* alpha_data = nullptr;
+    if (alpha) {
+        alpha->assign(image.has_alpha() ? pixel_count : 0, 0);
+        alpha_data = image.has_alpha() ? alpha->data() : nullptr;
+    }
+    resize_image(image, scaled_data.data(), output_width, output_height, filter, alpha_data);
+    return scaled_data;
+}
+
+// 预览任务被取消时由渲染流水线抛出
+struct PreviewCancelled : std::runtime_error {
+    PreviewCancelled() : std::runtime_error("Preview cancelled") {}
+};
+
+// 把 RGB 行写入 output_channels（3 或 4）通道的目标行；RGBA 的 alpha 取自 alpha 行，没有时置为 255
+inline void store_preview_row(const uint8_t* rgb, const uint8_t* alpha, uint8_t* out, int width, int output_channels) {
+    if (output_channels == 3) {
+        std::memcpy(out, rgb, static_cast<size_t>(width) * 3);
+        return;
+    }
+    for (int x = 0; x < width; x++) {
+        out[x * 4] = rgb[x * 3];
+        out[x * 4 + 1] = rgb[x * 3 + 1];
+        out[x * 4 + 2] = rgb[x * 3 + 2];
+        out[x * 4 + 3] = alpha ? alpha[x] : 255;
+    }
+}
+
+// 示波器累加器：把紧凑 RGB 像素计入直方图（R/G/B/亮度各 256 级）、亮度波形、RGB 分量波形与矢量示波器
+// 亮度与色差按 BT.709 计算；波形与矢量图的第 0 行对应最高电平 / 最大 Cr，可直接当作图像绘制
+// 只是计数缓冲的视图，缓冲由调用方提供（暂存区或输出数组）
+struct ScopeAccumulator {
+    int scope_width = 0;
+    int vector_size = 0;
+    uint32_t* histogram = nullptr;    // 4 × 256
+    uint32_t* waveform = nullptr;     // 256 × scope_width
+    uint32_t* parade = nullptr;       // 3 × 256 × scope_width
+    uint32_t* vectorscope = nullptr;  // vector_size × vector_size
+
+    static size_t histogram_size() { return 4 * 256; }
+    static size_t waveform_size(int width) { return 256 * static_cast<size_t>(width); }
+    static size_t parade_size(int width) { return 3 * 256 * static_cast<size_t>(width); }
+    static size_t vectorscope_size(int vectors) { return static_cast<size_t>(vectors) * vectors; }
+    static size_t counters(int width, int vectors) {
+        return histogram_size() + waveform_size(width) + parade_size(width) + vectorscope_size(vectors);
+    }
+
+    void bind(int width, int vectors, uint32_t* hist, uint32_t* wave, uint32_t* par, uint32_t* vec) {
+        scope_width = width;
+        vector_size = vectors;
+        histogram = hist;
+        waveform = wave;
+        parade = par;
+        vectorscope = vec;
+    }
+
+    // 在 counters(width, vectors) 个计数的连续缓冲上依次划分各项
+    void bind(int width, int vectors, uint32_t* block) {
+        uint32_t* wave = block + histogram_size();
+        uint32_t* par = wave + waveform_size(width);
+        bind(width, vectors, block, wave, par, par + parade_size(width));
+    }
+
+    void clear() {
+        std::memset(histogram, 0, histogram_size() * sizeof(uint32_t));
+        std::memset(waveform, 0, waveform_size(scope_width) * sizeof(uint32_t));
+        std::memset(parade, 0, parade_size(scope_width) * sizeof(uint32_t));
+        std::memset(vectorscope, 0, vectorscope_size(vector_size) * sizeof(uint32_t));
+    }
+
+    static int level(uint8_t v) { return v; }
+    static int level(float v) { return SampleTraits<uint8_t>::from_unit(v); }
+
+    // rgb 为 rows 行、每行 width 个紧凑像素（8 位或归一化浮点）；columns[x] 是第 x 列所在的波形列
+    template <typename T>
+    void add(const T* rgb, int width, int rows, const int* columns) {
+        const size_t plane = 256 * static_cast<size_t>(scope_width);
+        const float half = (vector_size - 1) * 0.5f;
+        const float cb_scale = 2.0f * half / (1.8556f * 255.0f);
+        const float cr_scale = 2.0f * half / (1.5748f * 255.0f);
+        for (int y = 0; y < rows; y++) {
+            const T* row = rgb + static_cast<size_t>(y) * width * 3;
+            for (int x = 0; x < width; x++) {
+                const T* px = row + x * 3;
+                const int r = level(px[0]);
+                const int g = level(px[1]);
+                const int b = level(px[2]);
+                const int luma = (54 * r + 183 * g + 19 * b + 128) >> 8;
+                histogram[r]++;
+                histogram[256 + g]++;
+                histogram[512 + b]++;
+                histogram[768 + luma]++;
+
+                const size_t column = static_cast<size_t>(columns[x]);
+                waveform[(255 - luma) * scope_width + column]++;
+                parade[(255 - r) * scope_width + column]++;
+                parade[plane + (255 - g) * scope_width + column]++;
+                parade[2 * plane + (255 - b) * scope_width + column]++;
+
+                const int u = std::clamp(static_cast<int>(half + (b - luma) * cb_scale + 0.5f), 0, vector_size - 1);
+                const int v = std::clamp(static_cast<int>(half - (r - luma) * cr_scale + 0.5f), 0, vector_size - 1);
+                vectorscope[static_cast<size_t>(v) * vector_size + u]++;
+            }
+        }
+    }
+
+    void merge(const ScopeAccumulator& other) {
+        auto sum = [](uint32_t* dst, const uint32_t* src, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                dst[i] += src[i];
+            }
+        };
+        sum(histogram, other.histogram, histogram_size());
+        sum(waveform, other.waveform, waveform_size(scope_width));
+        sum(parade, other.parade, parade_size(scope_width));
+        sum(vectorscope, other.vectorscope, vectorscope_size(vector_size));
+    }
+};
+
+// 源图与调色结果的示波器：渲染时每个行带槽位各累加一份（同一槽位在各轮之间串行，无需加锁），
+// 全部行带完成后合并到第 0 份。第 0 份直接使用调用方绑定的 source_total/graded_total（通常是
+// 输出数组），其余槽位的计数与列映射取自调用线程的暂存区，重复统计不再为每个槽位申请堆内存
+struct PreviewScopes {
+    int scope_width;
+    int vector_size;
+    ScopeAccumulator source_total;
+    ScopeAccumulator graded_total;
+    int* columns = nullptr;
+    ScopeAccumulator* source = nullptr;
+    ScopeAccumulator* graded = nullptr;
+    int slots = 0;
+
+    PreviewScopes(int width, int vectors) : scope_width(width), vector_size(vectors) {
+        if (width < 1 || width > 4096) {
+            throw std::runtime_error("Scope width must be between 1 and 4096");
+        }
+        if (vectors < 2 || vectors > 1024) {
+            throw std::runtime_error("Vectorscope size must be between 2 and 1024");
+        }
+    }
+
+    // 在调用方的 ScratchScope 中分配；source_total/graded_total 需事先绑定
+    void prepare(int image_width, int slot_count) {
+        ScratchArena& arena = ScratchArena::local();
+        columns = arena.alloc<int>(image_width);
+        for (int x = 0; x < image_width; x++) {
+            columns[x] = static_cast<int>(static_cast<int64_t>(x) * scope_width / image_width);
+        }
+        slots = slot_count;
+        source = arena.alloc<ScopeAccumulator>(slots);
+        graded = arena.alloc<ScopeAccumulator>(slots);
+        const size_t counters = ScopeAccumulator::counters(scope_width, vector_size);
+        uint32_t* block = slots > 1 ? arena.alloc<uint32_t>(counters * 2 * (slots - 1)) : nullptr;
+        for (int i = 0; i < slots; i++) {
+            if (i == 0) {
+                source[i] = source_total;
+                graded[i] = graded_total;
+            } else {
+                source[i].bind(scope_width, vector_size, block + counters * 2 * (i - 1));
+                graded[i].bind(scope_width, vector_size, block + counters * (2 * (i - 1) + 1));
+            }
+            source[i].clear();
+            graded[i].clear();
+        }
+    }
+
+    void merge() {
+        for (int i = 1; i < slots; i++) {
+            source[0].merge(source[i]);
+            graded[0].merge(graded[i]);
+        }
+    }
+};
+
+// 行带流水线：每个线程池任务缩放一个行带并原地应用 LUT，随后按行序交给 sink(y, rgb_row, alpha_row)
+// 输入不带 alpha 时 alpha_row 为空；每轮只保留“线程数 × 行带”大小的缓冲，峰值内存与整帧尺寸无关
+// 高位深/浮点输入缩放为归一化浮点行带，在浮点内核中应用 LUT 后才量化为 8 位
+// 缓冲全部取自调用方的 ScratchScope（sink 可能让调用方的 ScratchVector 增长，这里不另开作用域）
+// cancel 非空时每个行带开始前检查，置位后跳过剩余行带并在本轮结束时抛出 PreviewCancelled
+// scopes 非空时在应用 LUT 前后分别把行带计入源图与调色结果的示波器
+template <typename Sink>
+void render_preview_tiles(const LUTData& lut, const ImageView& image,
+                          int output_width, int output_height,
+                          ResampleFilter filter, Interpolation interpolation, Sink&& sink,
+                          const std::atomic<bool>* cancel = nullptr,
+                          PreviewScopes* scopes = nullptr) {
+    if (output_width <= 0 || output_height <= 0) {
+        throw std::runtime_error("Output size must be positive");
+    }
+
+    const size_t row_bytes = static_cast<size_t>(output_width) * 3;
+    const int tile_rows = preview_tile_rows(output_width);
+    const int wave_tiles = ThreadPool::instance().num_threads();
+    const int wave_rows = wave_tiles * tile_rows;
+    const size_t wave_pixels = static_cast<size_t>(std::min(wave_rows, output_height)) * output_width;
+    ScratchArena& arena = ScratchArena::local();
+    uint8_t* wave = arena.alloc<uint8_t>(wave_pixels * 3);
+    uint8_t* wave_alpha = image.has_alpha() ? arena.alloc<uint8_t>(wave_pixels) : nullptr;
+    const bool apply = lut.is_valid();
+    const bool wide = image.sample != SampleType::U8;
+    Resampler resampler(image, output_width, output_height, filter);
+    const size_t scratch_size = resampler.scratch_size();
+    const size_t wide_tile_size = static_cast<size_t>(tile_rows) * row_bytes;
+    float* scratch = arena.alloc<float>(scratch_size * wave_tiles);
+    float* wide_tiles = wide ? arena.alloc<float>(wide_tile_size * wave_tiles) : nullptr;
+    if (scopes) {
+        scopes->prepare(output_width, std::min(wave_tiles, (output_height + tile_rows - 1) / tile_rows));
+    }
+
+    for (int wave_y = 0; wave_y < output_height; wave_y += wave_rows) {
+        const int wave_end = std::min(output_height, wave_y + wave_rows);
+        const int tiles = (wave_end - wave_y + tile_rows - 1) / tile_rows;
+
+        parallel_for(tiles, [&](int64_t task) {
+            if (cancel && cancel->load(std::memory_order_relaxed)) {
+                return;
+            }
+            const int t = static_cast<int>(task);
+            int y0 = wave_y + t * tile_rows;
+            int y1 = std::min(wave_end, y0 + tile_rows);
+            uint8_t* tile = wave + static_cast<size_t>(t) * tile_rows * row_bytes;
+            uint8_t* tile_alpha = wave_alpha
+                ? wave_alpha + static_cast<size_t>(t) * tile_rows * output_width : nullptr;
+            float* tile_scratch = scratch + static_cast<size_t>(t) * scratch_size;
+            const size_t pixels = static_cast<size_t>(y1 - y0) * output_width;
+            if (wide) {
+                float* rgb = wide_tiles + static_cast<size_t>(t) * wide_tile_size;
+                resampler.rows(y0, y1, rgb, tile_alpha, tile_scratch);
+                if (scopes) {
+                    scopes->source[t].add(rgb, output_width, y1 - y0, scopes->columns);
+                }
+                if (apply) {
+                    apply_lut_span_f32(lut, rgb, rgb, pixels, interpolation);
+                }
+                for (size_t i = 0; i < pixels * 3; i++) {
+                    tile[i] = SampleTraits<uint8_t>::from_unit(rgb[i]);
+                }
+                if (scopes) {
+                    scopes->graded[t].add(tile, output_width, y1 - y0, scopes->columns);
+                }
+                return;
+            }
+            resampler.rows(y0, y1, tile, tile_alpha, tile_scratch);
+            if (scopes) {
+                scopes->source[t].add(tile, output_width, y1 - y0, scopes->columns);
+            }
+            if (apply) {
+                apply_lut_span(lut, tile, tile, pixels, interpolation);
+            }
+            if (scopes) {
+                scopes->graded[t].add(tile, output_width, y1 - y0, scopes->columns);
+            }
+        });
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            throw PreviewCancelled();
+        }
+
+        for (int y = wave_y; y < wave_end; y++) {
+            const size_t row = static_cast<size_t>(y - wave_y);
+            sink(y, wave + row * row_bytes, wave_alpha ? wave_alpha + row * output_width : nullptr);
+        }
+    }
+    if (scopes) {
+        scopes->merge();
+    }
+}
+
+// 生成预览像素：行带直接写入调用方提供的输出缓冲（output_height × output_width × output_channels），
+// 不再经过整帧的缩放/映射中间结果
+void render_preview_pixels(const LUTData& lut, const ImageView& image, uint8_t* output_data,
+                           int output_width, int output_height, int output_channels,
+                           ResampleFilter filter = ResampleFilter::Bilinear,
+                           Interpolation interpolation = Interpolation::Trilinear,
+                           const std::atomic<bool>* cancel = nullptr,
+                           PreviewScopes* scopes = nullptr) {
+    ScratchScope scope;
+    const size_t out_row_bytes = static_cast<size_t>(output_width) * output_channels;
+    render_preview_tiles(lut, image, output_width, output_height, filter, interpolation,
+                         [&](int y, const uint8_t* row, const uint8_t* alpha) {
+                             store_preview_row(row, alpha, output_data + y * out_row_bytes,
+                                               output_width, output_channels);
+                         },
+                         cancel, scopes);
+}
+
+// 生成 PNG 预览：行带完成后逐行送入流式编码器，只保留压缩后的数据；输入带 alpha 时输出 RGBA PNG
+// 编码器状态与返回的 PNG 数据都在调用方的 ScratchScope 中
+ScratchVector<uint8_t> render_preview_png(const LUTData& lut, const ImageView& image,
+                                          int output_width, int output_height, int compress_level,
+                                          ResampleFilter filter = ResampleFilter::Bilinear,
+                                          Interpolation interpolation = Interpolation::Trilinear) {
+    init_crc_table();
+    ScratchVector<uint8_t> png_data;
+    const int channels = image.has_alpha() ? 4 : 3;
+    uint8_t* rgba = channels == 4 ? ScratchArena::local().alloc<uint8_t>(static_cast<size_t>(output_width) * 4)
+                                  : nullptr;
+    PngEncoder encoder(png_data, output_width, output_height, channels, compress_level);
+    render_preview_tiles(lut, image, output_width, output_height, filter, interpolation,
+                         [&](int, const uint8_t* row, const uint8_t* alpha) {
+                             if (channels == 3) {
+                                 encoder.write_row(row);
+                                 return;
+                             }
+                             store_preview_row(row, alpha, rgba, output_width, 4);
+                             encoder.write_row(rgba);
+                         });
+    encoder.finish();
+    return png_data;
+}
+
+// 草稿预览：源图按最近邻取样，LUT 直接取最近的格点而不插值，代价只与输出像素数有关。
+// 用于渐进式预览的第一帧，随后由正式的缩放与插值结果替换
+void render_preview_draft(const LUTData& lut, const ImageView& image, uint8_t* output_data,
+                          int output_width, int output_height, int output_channels) {
+    const bool apply = lut.is_valid();
+    const int size = lut.size;
+    const float scale = apply ? static_cast<float>(size - 1) : 0.0f;
+    const size_t out_row_bytes = static_cast<size_t>(output_width) * output_channels;
+    auto lattice = [&](float v) { return static_cast<size_t>(clamp01(v) * scale + 0.5f); };
+
+    dispatch_sample(image.sample, [&](auto sample) {
+        using T = decltype(sample);
+        const int band = 16;
+        parallel_for((output_height + band - 1) / band, [&](int64_t t) {
+            const int y0 = static_cast<int>(t) * band;
+            const int y1 = std::min(output_height, y0 + band);
+            for (int y = y0; y < y1; y++) {
+                // 取输出像素中心对应的源像素
+                const int sy = static_cast<int>((2 * static_cast<int64_t>(y) + 1) * image.height / (2 * output_height));
+                const T* row = image.row<T>(sy);
+                uint8_t* out = output_data + y * out_row_bytes;
+                for (int x = 0; x < output_width; x++) {
+                    const int sx = static_cast<int>((2 * static_cast<int64_t>(x) + 1) * image.width / (2 * output_width));
+                    const T* pixel = row + sx * image.pixel_stride;
+                    float rgb[3];
+                    for (int c = 0; c < 3; c++) {
+                        rgb[c] = sample_to_unit(pixel[image.offset[c]]);
+                    }
+                    if (apply && lut.is_3d) {
+                        const size_t index = (lattice(rgb[2]) * size + lattice(rgb[1])) * size + lattice(rgb[0]);
+                        for (int c = 0; c < 3; c++) {
+                            rgb[c] = lut.plane(c)[index];
+                        }
+                    } else if (apply) {
+                        for (int c = 0; c < 3; c++) {
+                            rgb[c] = lut.data_1d[lattice(rgb[c]) * 3 + c];
+                        }
+                    }
+                    for (int c = 0; c < 3; c++) {
+                        out[c] = SampleTraits<uint8_t>::from_unit(rgb[c]);
+                    }
+                    if (output_channels == 4) {
+                        out[3] = image.has_alpha() ? SampleTraits<uint8_t>::from_unit(sample_to_unit(pixel[image.offset[3]]))
+                                                   : 255;
+                    }
+                    out += output_channels;
+                }
+            }
+        });
+    });
+}
+
+// 对已缩放的 RGB 像素（8 位或归一化浮点）应用 LUT，写出 output_channels（3 或 4）通道的 8 位像素，
+// RGBA 的 alpha 取自 alpha 平面（可为空）；按行带映射到小缓冲后写入输出，无需额外的整帧 RGB 副本。
+// output_stride 为输出行距（字节，0 表示紧凑），可直接写入更大缓冲（如图集）中的一块区域
+template <typename Src>
+void apply_preview_lut(const LUTData& lut,
+                       const Src* scaled_data,
+                       const uint8_t* alpha,
+                       uint8_t* output_data,
+                       int output_width,
+                       int output_height,
+                       int output_channels,
+                       Interpolation interpolation = Interpolation::Trilinear,
+                       size_t output_stride = 0) {
+    const size_t row_bytes = static_cast<size_t>(output_width) * 3;
+    const size_t out_row_bytes = output_stride ? output_stride : static_cast<size_t>(output_width) * output_channels;
+    // 紧凑 RGB 输出直接映射到目标行，其余情况经行带缓冲逐行写出
+    const bool direct = output_channels == 3 && out_row_bytes == row_bytes;
+    const int tile_rows = preview_tile_rows(output_width);
+    const int tiles = (output_height + tile_rows - 1) / tile_rows;
+    const bool apply = lut.is_valid();
+
+    parallel_for(tiles, [&](int64_t t) {
+        ScratchScope task_scope;
+        uint8_t* tile = direct ? nullptr : task_scope.alloc<uint8_t>(static_cast<size_t>(tile_rows) * row_bytes);
+        int y0 = static_cast<int>(t) * tile_rows;
+        int y1 = std::min(output_height, y0 + tile_rows);
+        size_t pixels = static_cast<size_t>(y1 - y0) * output_width;
+        const Src* src = scaled_data + y0 * row_bytes;
+        uint8_t* rgb = direct ? output_data + y0 * out_row_bytes : tile;
+
+        if constexpr (std::is_same_v<Src, float>) {
+            const float* mapped = src;
+            if (apply) {
+                float* wide_tile = task_scope.alloc<float>(pixels * 3);
+                apply_lut_span_f32(lut, src, wide_tile, pixels, interpolation);
+                mapped = wide_tile;
+            }
+            for (size_t i = 0; i < pixels * 3; i++) {
+                rgb[i] = SampleTraits<uint8_t>::from_unit(mapped[i]);
+            }
+        } else if (apply) {
+            apply_lut_span(lut, src, rgb, pixels, interpolation);
+        } else {
+            std::memcpy(rgb, src, pixels * 3);
+        }
+        if (!direct) {
+            for (int y = y0; y < y1; y++) {
+                store_preview_row(rgb + (y - y0) * row_bytes,
+                                  alpha ? alpha + static_cast<size_t>(y) * output_width : nullptr,
+                                  output_data + y * out_row_bytes, output_width, output_channels);
+            }
+        }
+    });
+}
+
+// 参考图像只缩放一次，再把 selected 中选中的各 LUT 并行应用到缩放结果，写入 targets[i]
+// （行距 output_stride 字节，0 表示紧凑）；每个 LUT 写完后调用 done(i)。调用方需持有 ScratchScope
+template <typename Done>
+void grade_reference(const ImageView& image,
+                     const ScratchVector<LUTHandle>& handles,
+                     const ScratchVector<char>& selected,
+                     const ScratchVector<uint8_t*>& targets,
+                     int output_width,
+                     int output_height,
+                     int output_channels,
+                     ResampleFilter filter,
+                     Interpolation interpolation,
+                     size_t output_stride,
+                     Done&& done) {
+    if (std::find(selected.begin(), selected.end(), 1) == selected.end()) {
+        return;
+    }
+    // 高位深/浮点参考图缩放为归一化浮点，每个 LUT 在浮点内核中应用后才量化
+    const bool wide = image.sample != SampleType::U8;
+    ScratchVector<uint8_t> alpha;
+    ScratchVector<uint8_t> scaled_data;
+    ScratchVector<float> scaled_wide;
+    if (wide) {
+        scaled_wide = scale_reference<float>(image, output_width, output_height, filter, &alpha);
+    } else {
+        scaled_data = scale_reference<uint8_t>(image, output_width, output_height, filter, &alpha);
+    }
+    const uint8_t* alpha_data = alpha.empty() ? nullptr : alpha.data();
+
+    // 每个 LUT 是一个任务，其内部的行带再作为嵌套任务组提交，空闲线程可同时参与两层
+    parallel_for(static_cast<int64_t>(handles.size()), [&](int64_t i) {
+        if (!selected[i]) return;
+        if (wide) {
+            apply_preview_lut(*handles[i], scaled_wide.data(), alpha_data, targets[i], output_width,
+                              output_height, output_channels, interpolation, output_stride);
+        } else {
+            apply_preview_lut(*handles[i], scaled_data.data(), alpha_data, targets[i], output_width,
+                              output_height, output_channels, interpolation, output_stride);
+        }
+        done(i);
+    });
+}
+
+// 8 位紧凑 RGB/RGBA 缓冲的图像视图
+ImageView packed_u8_view(const uint8_t* data, int width, int height, int channels) {
+    ImageView view;
+    view.data = data;
+    view.sample = SampleType::U8;
+    view.width = width;
+    view.height = height;
+    view.layout = parse_input_format(channels == 4 ? "rgba" : "rgb", channels);
+    view.row_stride = static_cast<ptrdiff_t>(width) * channels;
+    view.pixel_stride = channels;
+    for (int c = 0; c < 4; c++) {
+        view.offset[c] = view.layout.index[c] >= 0 ? view.layout.index[c] : 0;
+    }
+    return view;
+}
+
+// 把 8 位紧凑 RGB/RGBA 图像缩放到目标尺寸，通道数不变；尺寸相同时直接复制
+void resize_packed(const uint8_t* src, int src_width, int src_height,
+                   uint8_t* dst, int dst_width, int dst_height, int channels, ResampleFilter filter) {
+    if (src_width == dst_width && src_height == dst_height) {
+        std::memcpy(dst, src, static_cast<size_t>(dst_width) * dst_height * channels);
+        return;
+    }
+    const ImageView view = packed_u8_view(src, src_width, src_height, channels);
+    if (channels == 3) {
+        resize_image(view, dst, dst_width, dst_height, filter);
+        return;
+    }
+    ScratchScope scope;
+    const size_t pixels = static_cast<size_t>(dst_width) * dst_height;
+    uint8_t* rgb = scope.alloc<uint8_t>(pixels * 3);
+    uint8_t* alpha = scope.alloc<uint8_t>(pixels);
+    resize_image(view, rgb, dst_width, dst_height, filter, alpha);
+    for (int y = 0; y < dst_height; y++) {
+        const size_t row = static_cast<size_t>(y) * dst_width;
+        store_preview_row(rgb + row * 3, alpha + row, dst + row * 4, dst_width, 4);
+    }
+}
+
+// 多尺寸预览（如 1x/2x/3x）：只在面积最大的尺寸上缩放参考图并应用 LUT，
+// 其余尺寸按面积从大到小依次由上一级经 Lanczos3 缩小得到（mip 链），不再对源图重复查表
+void render_preview_mips(const LUTData& lut, const ImageView& image,
+                         const std::vector<std::pair<int, int>>& sizes, const ScratchVector<uint8_t*>& outputs,
+                         int output_channels, ResampleFilter filter, Interpolation interpolation) {
+    ScratchScope scope;
+    ScratchVector<size_t> order(sizes.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    auto area = [&](size_t i) { return static_cast<int64_t>(sizes[i].first) * sizes[i].second; };
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return area(a) > area(b); });
+
+    const size_t top = order[0];
+    render_preview_pixels(lut, image, outputs[top], sizes[top].first, sizes[top].second, output_channels,
+                          filter, interpolation);
+    for (size_t k = 1; k < order.size(); k++) {
+        const size_t src = order[k - 1];
+        const size_t dst = order[k];
+        resize_packed(outputs[src], sizes[src].first, sizes[src].second,
+                      outputs[dst], sizes[dst].first, sizes[dst].second, output_channels, ResampleFilter::Lanczos3);
+    }
+}
+
+py::bytes png_to_bytes(const ScratchVector<uint8_t>& png_data) {
+    count_heap_allocation();
+    return py::bytes(reinterpret_cast<const char*>(png_data.data()), png_data.size());
+}
+
+// 在持有 GIL 时创建 (height, width, channels) 的输出数组，计算期间直接写入其缓冲区，
+// 除返回给 Python 的数组外不再分配整帧缓冲
+py::array_t<uint8_t> new_pixel_array(int width, int height, int channels) {
+    count_heap_allocation();
+    return py::array_t<uint8_t>(
+        {static_cast<py::ssize_t>(height), static_cast<py::ssize_t>(width), static_cast<py::ssize_t>(channels)});
+}
+
+// out 为 None 时新建输出数组；否则要求是形状匹配、C 连续的可写 uint8 数组，结果直接写入其中，
+// 反复生成同尺寸预览时复用同一块缓冲
+py::array pixel_output_array(const py::object& out, int width, int height, int channels) {
+    if (out.is_none()) {
+        return new_pixel_array(width, height, channels);
+    }
+    py::array output = out.cast<py::array>();
+    const py::dtype dtype = output.dtype();
+    if (dtype.kind() != 'u' || dtype.itemsize() != 1 || output.ndim() != 3 || output.shape(0) != height ||
+        output.shape(1) != width || output.shape(2) != channels || !(output.flags() & py::array::c_style)) {
+        throw std::runtime_error("out must be a C-contiguous uint8 array of shape (height, width, channels)");
+    }
+    return output;
+}
+
+// 任意样本类型的版本，numpy dtype 与 type 对应
+py::array new_sample_array(int width, int height, int channels, SampleType type) {
+    count_heap_allocation();
+    return py::array(
+        py::dtype(sample_dtype(type)),
+        {static_cast<py::ssize_t>(height), static_cast<py::ssize_t>(width), static_cast<py::ssize_t>(channels)});
+}
+
+int parse_pixel_format(const std::string& pixel_format) {
+    if (pixel_format == "rgb" || pixel_format == "RGB888") return 3;
+    if (pixel_format == "rgba" || pixel_format == "RGBA8888") return 4;
+    throw std::runtime_error("Unsupported pixel format: " + pixel_format + " (expected 'rgb' or 'rgba')");
+}
+
+// 以下入口先在持有 GIL 时取出缓冲区与 LUT 来源，解析/缩放/应用/编码期间释放 GIL，
+// 只在构造返回值时重新持有，多个 Python 线程可真正并行生成预览
+
+// 生成 PNG 预览：从 Lut 对象、LUT 内容或路径
+py::bytes generate_preview_impl(const py::object& lut_content_or_path,
+                                py::array image_array,
+                                int output_width,
+                                int output_height,
+                                int compress_level = 6,
+                                const std::string& interpolation = "trilinear",
+                                const std::string& resample = "bilinear",
+                                const std::string& input_format = "auto") {
+    Interpolation mode = parse_interpolation(interpolation);
+    ResampleFilter filter = parse_resample_filter(resample);
+    LutSource source = lut_source(lut_content_or_path);
+    ImageView image = image_view(image_array, input_format);
+
+    ScratchScope scope;
+    ScratchVector<uint8_t> png_data;
+    {
+        py::gil_scoped_release release;
+        LUTHandle lut = resolve_lut(source);
+        png_data = render_preview_png(*lut, image, output_width, output_height, compress_level, filter, mode);
+    }
+    return png_to_bytes(png_data);
+}
+
+py::bytes generate_preview_from_data_impl(const std::string& lut_content,
+                                         py::array image_array,
+                                         int output_width,
+                                         int output_height,
+                                         int compress_level = 6,
+                                         const std::string& interpolation = "trilinear",
+                                         const std::string& resample = "bilinear",
+                                         const std::string& input_format = "auto") {
+    Interpolation mode = parse_interpolation(interpolation);
+    ResampleFilter filter = parse_resample_filter(resample);
+    ImageView image = image_view(image_array, input_format);
+
+    ScratchScope scope;
+    ScratchVector<uint8_t> png_data;
+    {
+        py::gil_scoped_release release;
+        LUTData lut;
+        if (!parse_cube_content(lut_content, lut)) {
+            throw std::runtime_error("Failed to parse LUT data");
+        }
+        png_data = render_preview_png(lut, image, output_width, output_height, compress_level, filter, mode);
+    }
+    return png_to_bytes(png_data);
+}
+
+// 返回应用 LUT 后的原始像素（height, width, channels），跳过 PNG 编解码
+py::array generate_preview_pixels_impl(const py::object& lut_or_content,
+                                       py::array image_array,
+                                       int output_width,
+                                       int output_height,
+                                       const std::string& pixel_format = "rgb",
+                                       const std::string& interpolation = "trilinear",
+                                       const std::string& resample = "bilinear",
+                                       const std::string& input_format = "auto",
+                                       const py::object& out = py::none()) {
+    int output_channels = parse_pixel_format(pixel_format);
+    Interpolation mode = parse_interpolation(interpolation);
+    ResampleFilter filter = parse_resample_filter(resample);
+    LutSource source = lut_source(lut_or_content);
+    ImageView image = image_view(image_array, input_format);
+
+    if (output_width <= 0 || output_height <= 0) {
+        throw std::runtime_error("Output size must be positive");
+    }
+    py::array output = pixel_output_array(out, output_width, output_height, output_channels);
+    uint8_t* output_data = static_cast<uint8_t*>(output.mutable_data());
+    {
+        py::gil_scoped_release release;
+        LUTHandle lut = resolve_lut(source);
+        render_preview_pixels(*lut, image, output_data, output_width, output_height, output_channels, filter, mode);
+    }
+    return output;
+}
+
+// 创建示波器的输出数组并把 target 绑定到其中，统计结果直接合并进数组，无需再复制
+py::dict new_scope_arrays(int width, int vectors, ScopeAccumulator& target) {
+    const py::ssize_t w = width;
+    const py::ssize_t v = vectors;
+    count_heap_allocation(4);
+    py::array_t<uint32_t> histogram(std::vector<py::ssize_t>{4, 256});
+    py::array_t<uint32_t> waveform(std::vector<py::ssize_t>{256, w});
+    py::array_t<uint32_t> parade(std::vector<py::ssize_t>{3, 256, w});
+    py::array_t<uint32_t> vectorscope(std::vector<py::ssize_t>{v, v});
+    target.bind(width, vectors, histogram.mutable_data(), waveform.mutable_data(), parade.mutable_data(),
+                vectorscope.mutable_data());
+    py::dict d;
+    d["histogram"] = histogram;
+    d["waveform"] = waveform;
+    d["parade"] = parade;
+    d["vectorscope"] = vectorscope;
+    return d;
+}
+
+// 生成预览像素，并在应用 LUT 的同一轮行带中统计源图与调色结果的示波器（统计的是预览尺寸的像素）
+py::tuple generate_preview_scopes_impl(const py::object& lut_or_content,
+                                       py::array image_array,
+                                       int output_width,
+                                       int output_height,
+                                       const std::string& pixel_format = "rgb",
+                                       const std::string& interpolation = "trilinear",
+                                       const std::string& resample = "bilinear",
+                                       const std::string& input_format = "auto",
+                                       int scope_width = 256,
+                                       int vectorscope_size = 128) {
+    int output_channels = parse_pixel_format(pixel_format);
+    Interpolation mode = parse_interpolation(interpolation);
+    ResampleFilter filter = parse_resample_filter(resample);
+    LutSource source = lut_source(lut_or_content);
+    ImageView image = image_view(image_array, input_format);
+    PreviewScopes scopes(scope_width, vectorscope_size);
+
+    if (output_width <= 0 || output_height <= 0) {
+        throw std::runtime_error("Output size must be positive");
+    }
+    py::array_t<uint8_t> output = new_pixel_array(output_width, output_height, output_channels);
+    uint8_t* output_data = output.mutable_data();
+    py::dict result;
+    result["source"] = new_scope_arrays(scope_width, vectorscope_size, scopes.source_total);
+    result["graded"] = new_scope_arrays(scope_width, vectorscope_size, scopes.graded_total);
+    {
+        py::gil_scoped_release release;
+        LUTHandle lut = resolve_lut(source);
+        render_preview_pixels(*lut, image, output_data, output_width, output_height, output_channels, filter, mode,
+                              nullptr, &scopes);
+    }
+    return py::make_tuple(output, result);
+}
+
+// 先查预览缓存，未命中时生成并写回；image_hash 由调用方对同一参考图像只计算一次
+void render_preview_cached(const LUTData& lut, const ImageView& image, uint64_t image_hash, uint8_t* output,
+                           int output_width, int output_height, int output_channels,
+                           ResampleFilter filter, Interpolation interpolation) {
+    const uint64_t key = preview_cache_key(lut_content_hash(lut), image_hash, output_width, output_height,
+                                           output_channels, filter, interpolation);
+    PreviewCache& cache = PreviewCache::instance();
+    if (cache.lookup(key, output_width, output_height, output_channels, output)) {
+        return;
+    }
+    render_preview_pixels(lut, image, output, output_width, output_height, output_channels, filter, interpolation);
+    cache.store(key, output_width, output_height, output_channels, output);
+}
+
+// 与 generate_preview_pixels 相同，但结果经过预览缓存
+py::array generate_preview_cached_impl(const py::object& lut_or_content,
+                                       py::array image_array,
+                                       int output_width,
+                                       int output_height,
+                                       const std::string& pixel_format = "rgb",
+                                       const std::string& interpolation = "trilinear",
+                                       const std::string& resample = "bilinear",
+                                       const std::string& input_format = "auto",
+                                       uint64_t image_key = 0,
+                                       const py::object& out = py::none()) {
+    int output_channels = parse_pixel_format(pixel_format);
+    Interpolation mode = parse_interpolation(interpolation);
+    ResampleFilter filter = parse_resample_filter(resample);
+    LutSource source = lut_source(lut_or_content);
+    ImageView image = image_view(image_array, input_format);
+
+    if (output_width <= 0 || output_height <= 0) {
+        throw std::runtime_error("Output size must be positive");
+    }
+    py::array output = pixel_output_array(out, output_width, output_height, output_channels);
+    uint8_t* output_data = static_cast<uint8_t*>(output.mutable_data());
+    {
+        py::gil_scoped_release release;
+        LUTHandle lut = resolve_lut(source);
+        render_preview_cached(*lut, image, resolve_image_key(image, image_key), output_data, output_width,
+                              output_height, output_channels, filter, mode);
+    }
+    return output;
+}
+
+// 只查预览缓存，不生成：命中返回像素，未命中返回 None，适合在界面线程决定是否排队生成
+py::object lookup_preview_impl(const py::object& lut_or_content,
+                               py::array image_array,
+                               int output_width,
+                               int output_height,
+                               const std::string& pixel_format = "rgb",
+                               const std::string& interpolation = "trilinear",
+                               const std::string& resample = "bilinear",
+                               const std::string& input_format = "auto",
+                               uint64_t image_key = 0,
+                               const py::object& out = py::none()) {
+    int output_channels = parse_pixel_format(pixel_format);
+    Interpolation mode = parse_interpolation(interpolation);
+    ResampleFilter filter = parse_resample_filter(resample);
+    LutSource source = lut_source(lut_or_content);
+    ImageView image = image_view(image_array, input_format);
+
+    if (output_width <= 0 || output_height <= 0) {
+        throw std::runtime_error("Output size must be positive");
+    }
+    // 先查到暂存区，命中后才创建 numpy 数组（或写入 out）：界面线程逐张查询时未命中不产生分配，
+    // 也不会改动 out 的内容
+    if (!out.is_none()) {
+        pixel_output_array(out, output_width, output_height, output_channels);
+    }
+    const size_t bytes = static_cast<size_t>(output_width) * output_height * output_channels;
+    ScratchScope scope;
+    uint8_t* pixels = scope.alloc<uint8_t>(bytes);
+    bool hit;
+    {
+        py::gil_scoped_release release;
+        LUTHandle lut = resolve_lut(source);
+        const uint64_t key = preview_cache_key(lut_content_hash(*lut), resolve_image_key(image, image_key),
+                                               output_width, output_height, output_channels, filter, mode);
+        hit = PreviewCache::instance().lookup(key, output_width, output_height, output_channels, pixels);
+    }
+    if (!hit) {
+        return py::none();
+    }
+    py::array output = pixel_output_array(out, output_width, output_height, output_channels);
+    std::memcpy(output.mutable_data(), pixels, bytes);
+    return output;
+}
+
+// 用同一张参考图像批量生成多个 LUT 的预览：参考图只缩放一次，各 LUT 分配到不同线程
+// 无法解析的 LUT 在结果列表中对应 None，不影响其余条目；use_cache 时命中缓存的条目不再生成，
+// 全部命中时也不缩放参考图像
+py::list generate_previews_batch_impl(const py::list& luts,
+                                      py::array image_array,
+                                      int output_width,
+                                      int output_height,
+                                      const std::string& pixel_format = "rgb",
+                                      const std::string& interpolation = "trilinear",
+                                      const std::string& resample = "bilinear",
+                                      const std::string& input_format = "auto",
+                                      bool use_cache = false,
+                                      uint64_t image_key = 0) {
+    int output_channels = parse_pixel_format(pixel_format);
+    Interpolation mode = parse_interpolation(interpolation);
+    ResampleFilter filter = parse_resample_filter(resample);
+    ImageView image = image_view(image_array, input_format);
+    // 逐项数组放在暂存区：整个调用期间有效，释放 GIL 前后由同一线程持有
+    ScratchScope scope;
+    ScratchVector<LutSource> sources;
+    ScratchVector<char> source_ok;
+    lut_sources(luts, sources, source_ok);
+
+    if (output_width <= 0 || output_height <= 0) {
+        throw std::runtime_error("Output size must be positive");
+    }
+    const int64_t count = static_cast<int64_t>(sources.size());
+    ScratchVector<LUTHandle> handles(sources.size());
+    ScratchVector<py::array_t<uint8_t>> results(sources.size());
+    ScratchVector<uint8_t*> targets(sources.size(), nullptr);
+    // 先解析全部 LUT 并查缓存，只为未命中的条目缩放参考图像
+    ScratchVector<uint64_t> keys(sources.size(), 0);
+    ScratchVector<char> pending(sources.size(), 0);
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (!source_ok[i]) continue;
+        results[i] = new_pixel_array(output_width, output_height, output_channels);
+        targets[i] = results[i].mutable_data();
+    }
+    {
+        py::gil_scoped_release release;
+        const uint64_t image_hash = use_cache ? resolve_image_key(image, image_key) : 0;
+        parallel_for(count, [&](int64_t i) {
+            if (!source_ok[i]) return;
+            try {
+                handles[i] = resolve_lut(sources[i]);
+            } catch (const std::exception&) {
+                return;
+            }
+            if (use_cache) {
+                keys[i] = preview_cache_key(lut_content_hash(*handles[i]), image_hash, output_width, output_height,
+                                            output_channels, filter, mode);
+                if (PreviewCache::instance().lookup(keys[i], output_width, output_height, output_channels,
+                                                    targets[i])) {
+                    return;
+                }
+            }
+            pending[i] = 1;
+        });
+        grade_reference(image, handles, pending, targets, output_width, output_height, output_channels, filter, mode, 0,
+                        [&](int64_t i) {
+                            if (use_cache) {
+                                PreviewCache::instance().store(keys[i], output_width, output_height,
+                                                               output_channels, targets[i]);
+                            }
+                        });
+    }
+
+    py::list previews;
+    for (int64_t i = 0; i < count; i++) {
+        if (handles[i]) {
+            previews.append(results[i]);
+        } else {
+            previews.append(py::none());
+        }
+    }
+    return previews;
+}
+
+// 图集排布：columns 列、按行填充，格子之间留 spacing 像素
+struct AtlasLayout {
+    int columns;
+    int rows;
+    int width;
+    int height;
+};
+
+AtlasLayout atlas_layout(int64_t count, int cell_width, int cell_height, int columns, int spacing) {
+    if (count <= 0) {
+        throw std::runtime_error("LUT list must not be empty");
+    }
+    if (cell_width <= 0 || cell_height <= 0) {
+        throw std::runtime_error("Cell size must be positive");
+    }
+    if (spacing < 0) {
+        throw std::runtime_error("Spacing must not be negative");
+    }
+    // 未指定列数时排成接近正方形
+    int64_t cols = columns > 0 ? std::min<int64_t>(columns, count)
+                               : static_cast<int64_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    int64_t rows = (count + cols - 1) / cols;
+    int64_t width = cols * cell_width + (cols - 1) * spacing;
+    int64_t height = rows * cell_height + (rows - 1) * spacing;
+    if (width > 32768 || height > 32768) {
+        throw std::runtime_error("Atlas too large");
+    }
+    return {static_cast<int>(cols), static_cast<int>(rows), static_cast<int>(width), static_cast<int>(height)};
+}
+
+// 用同一张参考图像为多个 LUT 生成预览并拼进一张图集，返回 (图集数组, 矩形列表)。
+// 矩形为 (x, y, 宽, 高)，解析失败的条目为 None 且对应格子留空（全 0）；
+// use_cache 时整张图集作为一个缓存条目，键由各 LUT 的预览键与排布共同决定
+py::tuple generate_preview_atlas_impl(const py::list& luts,
+                                      py::array image_array,
+                                      int cell_width,
+                                      int cell_height,
+                                      int columns = 0,
+                                      int spacing = 0,
+                                      const std::string& pixel_format = "rgb",
+                                      const std::string& interpolation = "trilinear",
+                                      const std::string& resample = "bilinear",
+                                      const std::string& input_format = "auto",
+                                      bool use_cache = false,
+                                      uint64_t image_key = 0) {
+    int output_channels = parse_pixel_format(pixel_format);
+    Interpolation mode = parse_interpolation(interpolation);
+    ResampleFilter filter = parse_resample_filter(resample);
+    ImageView image = image_view(image_array, input_format);
+    ScratchScope scope;
+    ScratchVector<LutSource> sources;
+    ScratchVector<char> source_ok;
+    lut_sources(luts, sources, source_ok);
+
+    const int64_t count = static_cast<int64_t>(sources.size());
+    const AtlasLayout layout = atlas_layout(count, cell_width, cell_height, columns, spacing);
+    py::array_t<uint8_t> atlas = new_pixel_array(layout.width, layout.height, output_channels);
+    uint8_t* atlas_data = atlas.mutable_data();
+    const size_t stride = static_cast<size_t>(layout.width) * output_channels;
+
+    ScratchVector<LUTHandle> handles(sources.size());
+    ScratchVector<uint8_t*> targets(sources.size());
+    ScratchVector<char> selected(sources.size(), 0);
+    for (int64_t i = 0; i < count; i++) {
+        const int x = static_cast<int>(i % layout.columns) * (cell_width + spacing);
+        const int y = static_cast<int>(i / layout.columns) * (cell_height + spacing);
+        targets[i] = atlas_data + static_cast<size_t>(y) * stride + static_cast<size_t>(x) * output_channels;
+    }
+    {
+        py::gil_scoped_release release;
+        parallel_for(count, [&](int64_t i) {
+            if (!source_ok[i]) return;
+            try {
+                handles[i] = resolve_lut(sources[i]);
+            } catch (const std::exception&) {
+            }
+        });
+        for (int64_t i = 0; i < count; i++) {
+            selected[i] = handles[i] ? 1 : 0;
+        }
+
+        uint64_t key = 0;
+        bool hit = false;
+        if (use_cache) {
+            const uint64_t image_hash = resolve_image_key(image, image_key);
+            XXH64 hash;
+            hash.update_value(kPreviewCacheVersion);
+            hash.update_value(layout.columns);
+            hash.update_value(spacing);
+            for (int64_t i = 0; i < count; i++) {
+                uint64_t cell_key = handles[i] ? preview_cache_key(lut_content_hash(*handles[i]), image_hash, cell_width,
+                                                                   cell_height, output_channels, filter, mode)
+                                               : 0;
+                hash.update_value(cell_key);
+            }
+            key = hash.digest();
+            hit = PreviewCache::instance().lookup(key, layout.width, layout.height, output_channels, atlas_data);
+        }
+        if (!hit) {
+            // 格子间隙与失败条目保持为 0（RGBA 时即透明）
+            std::memset(atlas_data, 0, stride * layout.height);
+            grade_reference(image, handles, selected, targets, cell_width, cell_height, output_channels, filter, mode,
+                            stride, [](int64_t) {});
+            if (use_cache) {
+                PreviewCache::instance().store(key, layout.width, layout.height, output_channels, atlas_data);
+            }
+        }
+    }
+
+    py::list rects;
+    for (int64_t i = 0; i < count; i++) {
+        if (handles[i]) {
+            rects.append(py::make_tuple(static_cast<int>(i % layout.columns) * (cell_width + spacing),
+                                        static_cast<int>(i / layout.columns) * (cell_height + spacing),
+                                        cell_width, cell_height));
+        } else {
+            rects.append(py::none());
+        }
+    }
+    return py::make_tuple(atlas, rects);
+}
+
+// 一次生成多个尺寸的预览像素，返回与 sizes 顺序一致的数组列表
+py::list generate_preview_mips_impl(const py::object& lut_or_content,
+                                    py::array image_array,
+                                    const std::vector<std::pair<int, int>>& sizes,
+                                    const std::string& pixel_format = "rgb",
+                                    const std::string& interpolation = "trilinear",
+                                    const std::string& resample = "bilinear",
+                                    const std::string& input_format = "auto") {
+    int output_channels = parse_pixel_format(pixel_format);
+    Interpolation mode = parse_interpolation(interpolation);
+    ResampleFilter filter = parse_resample_filter(resample);
+    LutSource source = lut_source(lut_or_content);
+    ImageView image = image_view(image_array, input_format);
+
+    if (sizes.empty()) {
+        throw std::runtime_error("At least one output size is required");
+    }
+    ScratchScope scope;
+    ScratchVector<py::array_t<uint8_t>> arrays;
+    ScratchVector<uint8_t*> outputs;
+    arrays.reserve(sizes.size());
+    outputs.reserve(sizes.size());
+    for (const auto& size : sizes) {
+        if (size.first <= 0 || size.second <= 0) {
+            throw std::runtime_error("Output size must be positive");
+        }
+        arrays.push_back(new_pixel_array(size.first, size.second, output_channels));
+        outputs.push_back(arrays.back().mutable_data());
+    }
+    {
+        py::gil_scoped_release release;
+        LUTHandle lut = resolve_lut(source);
+        render_preview_mips(*lut, image, sizes, outputs, output_channels, filter, mode);
+    }
+
+    py::list result;
+    for (auto& array : arrays) {
+        result.append(array);
+    }
+    return result;
+}
+
+// 以原始分辨率对整幅图像应用 LUT，输出与输入通道顺序相同的紧凑数组，alpha 原样保留
+// 输出 dtype 默认与输入相同；16 位与浮点输入全程以浮点计算，只在写出时量化一次
+py::array apply_lut_impl(const py::object& lut_or_content, py::array image_array,
+                         const std::string& interpolation = "trilinear",
+                         const std::string& input_format = "auto",
+                         const std::string& output_dtype = "") {
+    Interpolation mode = parse_interpolation(interpolation);
+    LutSource source = lut_source(lut_or_content);
+    ImageView image = image_view(image_array, input_format);
+    const SampleType output = output_dtype.empty() ? image.sample : parse_sample_type(output_dtype);
+
+    py::array result = new_sample_array(image.width, image.height, image.layout.channels, output);
+    void* output_data = result.mutable_data();
+    {
+        py::gil_scoped_release release;
+        LUTHandle lut = resolve_lut(source);
+        apply_lut_to_image_typed(*lut, image, output_data, output, mode);
+    }
+    return result;
+}
+
+// 将多个 LUT 按顺序合成为一个 size³ 的 3D LUT；指定 output_path 时同时写出 .cube 文件
+std::shared_ptr<LUTData> compose_luts_impl(const py::list& luts, int out_size = 33,
+                                           const std::string& interpolation = "trilinear",
+                                           const std::string& output_path = "",
+                                           const std::string& title = "") {
+    Interpolation mode = parse_interpolation(interpolation);
+    std::vector<LutSource> sources;
+    sources.reserve(luts.size());
+    for (const py::handle& item : luts) {
+        sources.push_back(lut_source(py::reinterpret_borrow<py::object>(item)));
+    }
+
+    py::gil_scoped_release release;
+    std::vector<LUTHandle> chain;
+    chain.reserve(sources.size());
+    for (const LutSource& source : sources) {
+        chain.push_back(resolve_lut(source));
+    }
+    std::shared_ptr<LUTData> result = compose_lut_chain(chain, out_size, mode, title);
+    if (!output_path.empty()) {
+        write_cube_file(*result, output_path);
+    }
+    return result;
+}
+
+// 将 LUT 重采样到 new_size 个格点；指定 output_path 时同时写出 .cube 文件
+std::shared_ptr<LUTData> resample_lut_impl(const py::object& lut_or_content, int new_size,
+                                           const std::string& method = "tetrahedral",
+                                           const std::string& output_path = "") {
+    Interpolation mode = parse_interpolation(method);
+    LutSource source = lut_source(lut_or_content);
+
+    py::gil_scoped_release release;
+    std::shared_ptr<LUTData> result = resample_lut_data(resolve_lut(source), new_size, mode);
+    if (!output_path.empty()) {
+        write_cube_file(*result, output_path);
+    }
+    return result;
+}
+
+// ============================================================================
+// 预览会话（LUT 强度调节）
+// ============================================================================
+
+// 按 weight / 256 在两段 8 位数据之间线性混合：out = (a × (256 − w) + b × w + 128) >> 8，w ∈ [0, 256]
+// 中间值最大 255 × 256 + 128，放得进 16 位无符号数
+void lerp_u8_scalar(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t count, int weight) {
+    const int inv = 256 - weight;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = static_cast<uint8_t>((a[i] * inv + b[i] * weight + 128) >> 8);
+    }
+}
+
+#if LUT_HAS_X86
+// 每次 32 字节：按 128 位通道内解包为 16 位，乘加后移位再打包，通道内顺序不变
+LUT_TARGET_AVX2
+void lerp_u8_avx2(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t count, int weight) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i wa = _mm256_set1_epi16(static_cast<short>(256 - weight));
+    const __m256i wb = _mm256_set1_epi16(static_cast<short>(weight));
+    const __m256i round = _mm256_set1_epi16(128);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(va, zero), wa),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(vb, zero), wb));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(va, zero), wa),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(vb, zero), wb));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, round), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, round), 8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_packus_epi16(lo, hi));
+    }
+    lerp_u8_scalar(a + i, b + i, out + i, count - i, weight);
+}
+#endif
+
+void lerp_u8(const uint8_t* a, const uint8_t* b, uint8_t* out, size_t count, int weight) {
+#if LUT_HAS_X86
+    if (cpu_has_avx2()) {
+        lerp_u8_avx2(a, b, out, count, weight);
+        return;
+    }
+#endif
+    lerp_u8_scalar(a, b, out, count, weight);
+}
+
+// 预览会话：缩放后的参考图像（原始帧）与完整应用 LUT 的结果（效果帧）常驻内存，
+// 调节强度时只在两帧之间混合一次，不再重复缩放、查表和编码；换 LUT 时也只需重新查表
+class PreviewSession {
+public:
+    PreviewSession(const LUTData& lut, const ImageView& image, int width, int height,
+                   ResampleFilter filter, Interpolation interpolation)
+        : width_(width), height_(height), has_alpha_(image.has_alpha()), interpolation_(interpolation) {
+        if (width <= 0 || height <= 0) {
+            throw std::runtime_error("Output size must be positive");
+        }
+        const size_t pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+        base_.resize(pixels * 3);
+        graded_.resize(pixels * 3);
+        if (has_alpha_) {
+            alpha_.resize(pixels);
+        }
+        uint8_t* alpha = has_alpha_ ? alpha_.data() : nullptr;
+
+        if (image.sample == SampleType::U8) {
+            resize_image(image, base_.data(), width, height, filter, alpha);
+        } else {
+            // 高位深输入保留归一化浮点的缩放结果，查表时不先量化为 8 位
+            wide_.resize(pixels * 3);
+            resize_image(image, wide_.data(), width, height, filter, alpha);
+            const size_t chunk = 64 * 1024;
+            const size_t samples = wide_.size();
+            parallel_for(static_cast<int64_t>((samples + chunk - 1) / chunk), [&](int64_t t) {
+                const size_t begin = static_cast<size_t>(t) * chunk;
+                const size_t end = std::min(samples, begin + chunk);
+                for (size_t i = begin; i < end; i++) {
+                    base_[i] = SampleTraits<uint8_t>::from_unit(wide_[i]);
+                }
+            });
+        }
+        grade(lut);
+    }
+
+    PreviewSession(const PreviewSession&) = delete;
+    PreviewSession& operator=(const PreviewSession&) = delete;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    bool has_alpha() const { return has_alpha_; }
+
+    // 换用另一个 LUT 重新生成效果帧，缩放结果不变
+    void set_lut(const LUTData& lut) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        grade(lut);
+    }
+
+    // 按 strength（0~1，0 为原图，1 为完整效果）混合两帧，写出 output_channels（3 或 4）通道的 8 位像素
+    void render(float strength, uint8_t* output, int output_channels) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const int weight = static_cast<int>(std::lround(clamp01(strength) * 256.0f));
+        const size_t row_bytes = static_cast<size_t>(width_) * 3;
+        const size_t out_row_bytes = static_cast<size_t>(width_) * output_channels;
+        const int tile_rows = preview_tile_rows(width_);
+        const int tiles = (height_ + tile_rows - 1) / tile_rows;
+
+        parallel_for(tiles, [&](int64_t t) {
+            const int y0 = static_cast<int>(t) * tile_rows;
+            const int y1 = std::min(height_, y0 + tile_rows);
+            const size_t offset = static_cast<size_t>(y0) * row_bytes;
+            const size_t samples = static_cast<size_t>(y1 - y0) * row_bytes;
+            if (output_channels == 3) {
+                lerp_u8(base_.data() + offset, graded_.data() + offset, output + offset, samples, weight);
+                return;
+            }
+            ScratchScope task_scope;
+            uint8_t* tile = task_scope.alloc<uint8_t>(samples);
+            lerp_u8(base_.data() + offset, graded_.data() + offset, tile, samples, weight);
+            for (int y = y0; y < y1; y++) {
+                store_preview_row(tile + (y - y0) * row_bytes,
+                                  has_alpha_ ? alpha_.data() + static_cast<size_t>(y) * width_ : nullptr,
+                                  output + y * out_row_bytes, width_, 4);
+            }
+        });
+    }
+
+private:
+    void grade(const LUTData& lut) {
+        if (!wide_.empty()) {
+            apply_preview_lut(lut, wide_.data(), nullptr, graded_.data(), width_, height_, 3, interpolation_);
+        } else {
+            apply_preview_lut(lut, base_.data(), nullptr, graded_.data(), width_, height_, 3, interpolation_);
+        }
+    }
+
+    int width_;
+    int height_;
+    bool has_alpha_;
+    Interpolation interpolation_;
+    AlignedVector<uint8_t> base_;
+    AlignedVector<uint8_t> graded_;
+    AlignedVector<uint8_t> alpha_;
+    AlignedVector<float> wide_;
+    std::mutex mutex_;
+};
+
+// 在持有 GIL 时取出参数，释放 GIL 后缩放参考图像并生成效果帧
+std::shared_ptr<PreviewSession> create_preview_session_impl(const py::object& lut_or_content,
+                                                            py::array image_array,
+                                                            int output_width,
+                                                            int output_height,
+                                                            const std::string& interpolation = "trilinear",
+                                                            const std::string& resample = "bilinear",
+                                                            const std::string& input_format = "auto") {
+    Interpolation mode = parse_interpolation(interpolation);
+    ResampleFilter filter = parse_resample_filter(resample);
+    LutSource source = lut_source(lut_or_content);
+    ImageView image = image_view(image_array, input_format);
+
+    py::gil_scoped_release release;
+    LUTHandle lut = resolve_lut(source);
+    return std::make_shared<PreviewSession>(*lut, image, output_width, output_height, filter, mode);
+}
+
+void preview_session_set_lut(PreviewSession& session, const py::object& lut_or_content) {
+    LutSource source = lut_source(lut_or_content);
+    py::gil_scoped_release release;
+    LUTHandle lut = resolve_lut(source);
+    session.set_lut(*lut);
+}
+
+// out 为形状匹配、C 连续的可写 uint8 数组时直接写入，拖动滑块时可反复复用同一块缓冲
+py::array preview_session_render(PreviewSession& session, float strength,
+                                 const std::string& pixel_format, const py::object& out) {
+    const int channels = parse_pixel_format(pixel_format);
+    py::array output = pixel_output_array(out, session.width(), session.height(), channels);
+    uint8_t* output_data = static_cast<uint8_t*>(output.mutable_data());
+    {
+        py::gil_scoped_release release;
+        session.render(strength, output_data, channels);
+    }
+    return output;
+}
+
+// ============================================================================
+// 异步预览任务
+// ============================================================================
+
+// 一个待生成的预览：输入视图与输出缓冲由 Python 侧句柄保持存活，本身不持有 Python 对象
+struct PreviewJob {
+    enum class State { Pending, Running, Done, Failed, Cancelled };
+
+    LutSource source;
+    ImageView image;
+    uint8_t* output = nullptr;
+    int width = 0;
+    int height = 0;
+    int channels = 3;
+    ResampleFilter filter = ResampleFilter::Bilinear;
+    Interpolation interpolation = Interpolation::Trilinear;
+    // 渐进式预览：先写出 draft_width × draft_height 的草稿，再生成正式结果；为空时不生成草稿
+    uint8_t* draft = nullptr;
+    int draft_width = 0;
+    int draft_height = 0;
+
+    // 在行带之间检查的取消标记
+    std::atomic<bool> cancel{false};
+    // 排队顺序，只在调度器锁内读写
+    int priority = 0;
+    uint64_t sequence = 0;
+
+    std::mutex mutex;
+    std::condition_variable finished_cv;
+    State state = State::Pending;
+    bool draft_ready = false;
+    std::string error;
+
+    void finish(State final_state, const std::string& message = std::string()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            state = final_state;
+            error = message;
+        }
+        finished_cv.notify_all();
+    }
+
+    bool finished() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return state != State::Pending && state != State::Running;
+    }
+
+    void publish_draft() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            draft_ready = true;
+        }
+        finished_cv.notify_all();
+    }
+
+    // 等待结束（accept_draft 时草稿就绪也返回）；timeout_ms < 0 时一直等待，返回是否等到
+    bool wait(double timeout_ms, bool accept_draft = false) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto is_ready = [&] {
+            return (state != State::Pending && state != State::Running) || (accept_draft && draft_ready);
+        };
+        if (timeout_ms < 0) {
+            finished_cv.wait(lock, is_ready);
+            return true;
+        }
+        return finished_cv.wait_for(lock, std::chrono::duration<double, std::milli>(timeout_ms), is_ready);
+    }
+};
+
+using PreviewJobHandle = std::shared_ptr<PreviewJob>;
+
+// 预览任务调度器：自有的少量调度线程按优先级（高者先，同级先提交者先）取出任务，
+// 每个任务的行带仍交给共享线程池并行。排队中的任务可随时调整优先级或直接移出队列，
+// 运行中的任务在行带之间响应取消，快速滚动时过期请求不会挡在可见卡片之前
+class PreviewScheduler {
+public:
+    static PreviewScheduler& instance() {
+        // 与线程池相同，故意不析构
+        static PreviewScheduler* scheduler = new PreviewScheduler(2);
+        return *scheduler;
+    }
+
+    void submit(const PreviewJobHandle& job, int priority) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job->priority = priority;
+            job->sequence = next_sequence_++;
+            queue_.insert(job);
+        }
+        cv_.notify_one();
+    }
+
+    void set_priority(const PreviewJobHandle& job, int priority) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = queue_.find(job);
+        if (it == queue_.end()) {
+            job->priority = priority;
+            return;
+        }
+        queue_.erase(it);
+        job->priority = priority;
+        queue_.insert(job);
+    }
+
+    int priority(const PreviewJobHandle& job) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return job->priority;
+    }
+
+    // 排队中的任务直接移出并标记为已取消；运行中的任务由渲染流水线在下一个行带前停止
+    void cancel(const PreviewJobHandle& job) {
+        job->cancel.store(true, std::memory_order_relaxed);
+        bool removed = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = queue_.find(job);
+            if (it != queue_.end()) {
+                queue_.erase(it);
+                removed = true;
+            }
+        }
+        if (removed) {
+            job->finish(PreviewJob::State::Cancelled);
+        }
+    }
+
+    size_t pending() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size();
+    }
+
+private:
+    struct Order {
+        bool operator()(const PreviewJobHandle& a, const PreviewJobHandle& b) const {
+            if (a->priority != b->priority) return a->priority > b->priority;
+            return a->sequence < b->sequence;
+        }
+    };
+
+    explicit PreviewScheduler(int workers) {
+        for (int i = 0; i < workers; i++) {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    void worker_loop() {
+        for (;;) {
+            PreviewJobHandle job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&] { return !queue_.empty(); });
+                job = *queue_.begin();
+                queue_.erase(queue_.begin());
+                std::lock_guard<std::mutex> job_lock(job->mutex);
+                job->state = PreviewJob::State::Running;
+            }
+            run(*job);
+        }
+    }
+
+    static void run(PreviewJob& job) {
+        try {
+            if (job.cancel.load(std::memory_order_relaxed)) {
+                throw PreviewCancelled();
+            }
+            LUTHandle lut = resolve_lut(job.source);
+            if (job.draft) {
+                render_preview_draft(*lut, job.image, job.draft, job.draft_width, job.draft_height, job.channels);
+                job.publish_draft();
+            }
+            render_preview_pixels(*lut, job.image, job.output, job.width, job.height, job.channels,
+                                  job.filter, job.interpolation, &job.cancel);
+            job.finish(PreviewJob::State::Done);
+        } catch (const PreviewCancelled&) {
+            job.finish(PreviewJob::State::Cancelled);
+        } catch (const std::exception& e) {
+            job.finish(PreviewJob::State::Failed, e.what());
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::set<PreviewJobHandle, Order> queue_;
+    uint64_t next_sequence_ = 0;
+    std::vector<std::thread> workers_;
+};
+
+// Python 侧的任务句柄：持有参考图像与输出数组，保证任务运行期间缓冲有效；
+// 句柄被回收时先取消任务并等待其停止，再释放缓冲
+class PreviewTask {
+public:
+    PreviewTask(PreviewJobHandle job, py::array image, py::array output, py::object draft)
+        : job_(std::move(job)), image_(std::move(image)), output_(std::move(output)), draft_(std::move(draft)) {}
+
+    ~PreviewTask() {
+        PreviewScheduler::instance().cancel(job_);
+        py::gil_scoped_release release;
+        job_->wait(-1);
+    }
+
+    PreviewTask(const PreviewTask&) = delete;
+    PreviewTask& operator=(const PreviewTask&) = delete;
+
+    const PreviewJobHandle& job() const { return job_; }
+
+    std::string state() {
+        std::lock_guard<std::mutex> lock(job_->mutex);
+        switch (job_->state) {
+            case PreviewJob::State::Pending: return "pending";
+            case PreviewJob::State::Running: return "running";
+            case PreviewJob::State::Done: return "done";
+            case PreviewJob::State::Failed: return "failed";
+            case PreviewJob::State::Cancelled: return "cancelled";
+        }
+        return "unknown";
+    }
+
+    bool draft_ready() {
+        std::lock_guard<std::mutex> lock(job_->mutex);
+        return job_->draft_ready;
+    }
+
+    // 等待结果；超时返回 None，失败或被取消时抛出 RuntimeError。
+    // draft 为 True 时正式结果之前先返回已就绪的草稿（尺寸为正式结果的 1/4），可据 done() 区分
+    py::object result(double timeout_ms, bool draft) {
+        bool ready;
+        {
+            py::gil_scoped_release release;
+            ready = job_->wait(timeout_ms, draft);
+        }
+        if (!ready) {
+            return py::none();
+        }
+        std::lock_guard<std::mutex> lock(job_->mutex);
+        if (job_->state == PreviewJob::State::Cancelled) {
+            throw std::runtime_error("Preview cancelled");
+        }
+        if (job_->state == PreviewJob::State::Failed) {
+            throw std::runtime_error(job_->error);
+        }
+        if (job_->state != PreviewJob::State::Done) {
+            return draft_;
+        }
+        return output_;
+    }
+
+private:
+    PreviewJobHandle job_;
+    py::array image_;
+    py::array output_;
+    py::object draft_;
+};
+
+// 在持有 GIL 时准备输入视图与输出数组，随后交给调度器，立即返回任务句柄
+std::shared_ptr<PreviewTask> submit_preview_impl(const py::object& lut_or_content,
+                                                 py::array image_array,
+                                                 int output_width,
+                                                 int output_height,
+                                                 const std::string& pixel_format = "rgb",
+                                                 const std::string& interpolation = "trilinear",
+                                                 const std::string& resample = "bilinear",
+                                                 const std::string& input_format = "auto",
+                                                 int priority = 0,
+                                                 bool progressive = false) {
+    auto job = std::make_shared<PreviewJob>();
+    job->channels = parse_pixel_format(pixel_format);
+    job->interpolation = parse_interpolation(interpolation);
+    job->filter = parse_resample_filter(resample);
+    job->source = lut_source(lut_or_content);
+    job->image = image_view(image_array, input_format);
+    if (output_width <= 0 || output_height <= 0) {
+        throw std::runtime_error("Output size must be positive");
+    }
+    job->width = output_width;
+    job->height = output_height;
+
+    py::array_t<uint8_t> output = new_pixel_array(output_width, output_height, job->channels);
+    job->output = output.mutable_data();
+    py::object draft = py::none();
+    if (progressive) {
+        job->draft_width = std::max(1, (output_width + 3) / 4);
+        job->draft_height = std::max(1, (output_height + 3) / 4);
+        py::array_t<uint8_t> draft_array = new_pixel_array(job->draft_width, job->draft_height, job->channels);
+        job->draft = draft_array.mutable_data();
+        draft = draft_array;
+    }
+    auto task = std::make_shared<PreviewTask>(job, image_array, output, draft);
+    PreviewScheduler::instance().submit(job, priority);
+    return task;
+}
 
 // ============================================================================
 // pybind11 模块定义
@@ -599,28 +6278,76 @@ py::bytes generate_preview_from_array_impl(const std::string& lut_file_path,
 PYBIND11_MODULE(lut_preview_cpp, m) {
     m.doc() = "C++ 实现的高性能 LUT 预览生成器";
 
-    // 接受 LUT 文件内容的版本
-    m.def("generate_preview", [](const py::object& lut_content_or_path, py::array_t<uint8_t> image_array,
-                                int output_width, int output_height) {
-        // 尝试作为文件路径处理
-        std::string path = lut_content_or_path.cast<std::string>();
-        
-        // 首先尝试解析为文件路径
-        std::ifstream test_file(path);
-        if (test_file.is_open()) {
-            test_file.close();
-            // 是有效文件路径，使用文件版本
-            return generate_preview_from_array_impl(path, image_array, output_width, output_height);
-        }
-        
-        // 否则尝试作为内容处理
-        return generate_preview_from_data_impl(path, image_array, output_width, output_height);
+    py::class_<LUTData, std::shared_ptr<LUTData>>(m, "Lut", "解析后的 LUT，可在多次预览/应用调用间复用")
+        .def(py::init(&parse_lut_handle_from_content), py::arg("lut_content"),
+             py::call_guard<py::gil_scoped_release>())
+        .def_static("from_file", &parse_lut_handle_from_file, "从 .cube 文件解析 LUT（不经过缓存）", py::arg("path"),
+                    py::call_guard<py::gil_scoped_release>())
+        .def_readonly("title", &LUTData::title)
+        .def_readonly("size", &LUTData::size)
+        .def_readonly("is_3d", &LUTData::is_3d)
+        .def_property_readonly("nbytes", [](const LUTData& lut) { return lut_memory_bytes(lut); })
+        .def_property_readonly("mapped", &LUTData::is_mapped, "格点是否直接引用映射的二进制缓存文件")
+        .def("__repr__", [](const LUTData& lut) {
+            return "<Lut " + std::string(lut.is_3d ? "3D" : "1D") + " size=" + std::to_string(lut.size) +
+                   " title=\"" + lut.title + "\">";
+        });
+
+    m.def("load_lut", [](const std::string& path) {
+        return std::const_pointer_cast<LUTData>(LUTCache::instance().load(path));
     },
-    "从 LUT 内容或路径生成预览图像",
-    py::arg("lut_content_or_path"),
-    py::arg("image_array"),
-    py::arg("output_width"),
-    py::arg("output_height"));
+    "通过 LRU 缓存加载 LUT 文件（按路径、修改时间和大小判定是否重新解析）",
+    py::arg("path"),
+    py::call_guard<py::gil_scoped_release>());
+
+    m.def("set_lut_cache_limit", [](size_t limit_bytes) { LUTCache::instance().set_limit(limit_bytes); },
+          "设置 LUT 缓存的字节预算",
+          py::arg("limit_bytes"));
+    m.def("evict_lut", [](const std::string& path) { return LUTCache::instance().evict(path); },
+          "从 LUT 缓存中移除指定文件，删除或替换该文件前调用以释放缓存对其 .lutc 的映射（返回是否存在该项）",
+          py::arg("path"));
+    m.def("clear_lut_cache", []() { LUTCache::instance().clear(); }, "清空 LUT 缓存");
+    m.def("get_lut_cache_info", []() { return LUTCache::instance().info(); }, "获取 LUT 缓存统计信息");
+    m.def("set_lut_binary_cache_dir", [](const std::string& dir) { LUTCache::instance().set_binary_dir(dir); },
+          "设置二进制 LUT 缓存（.lutc）目录：加载 .cube 时优先映射缓存，源文件变化时自动重新解析（为空时禁用）",
+          py::arg("cache_dir"));
+    m.def("get_lut_binary_cache_dir", []() { return LUTCache::instance().binary_dir(); },
+          "获取二进制 LUT 缓存目录（未启用时为空字符串）");
+    m.def("get_lut_binary_path", [](const std::string& path) {
+        const std::string dir = LUTCache::instance().binary_dir();
+        return dir.empty() ? std::string() : lut_binary_path(dir, path);
+    },
+    "获取 LUT 文件对应的二进制缓存路径（未启用时为空字符串）",
+    py::arg("path"));
+
+    m.def("set_num_threads", [](int n) { ThreadPool::instance().set_num_threads(n); },
+          "设置线程池的线程数（含调用线程，<= 0 时恢复为 CPU 核心数），所有入口共享",
+          py::arg("n"),
+          py::call_guard<py::gil_scoped_release>());
+    m.def("get_num_threads", []() { return ThreadPool::instance().num_threads(); }, "获取线程池的线程数");
+
+    m.def("get_scratch_info", []() {
+        py::dict d;
+        d["allocations"] = g_scratch_allocations.load();
+        d["heap_allocations"] = g_heap_allocations.load();
+        d["reserved_bytes"] = g_scratch_reserved.load();
+        return d;
+    }, "获取线程暂存区统计信息（allocations 为暂存区申请新内存块的次数，heap_allocations 为暂存区以外随调用发生的堆分配次数）");
+    m.def("trim_scratch", &trim_scratch, "收缩各线程的暂存区，容量超过 keep_bytes 的整体释放（为 0 时全部释放）",
+          py::arg("keep_bytes") = 0,
+          py::call_guard<py::gil_scoped_release>());
+
+    // 接受 Lut 对象、LUT 文件路径或内容的版本
+    m.def("generate_preview", &generate_preview_impl,
+          "从 Lut 对象、LUT 内容或路径生成预览图像",
+          py::arg("lut_content_or_path"),
+          py::arg("image_array"),
+          py::arg("output_width"),
+          py::arg("output_height"),
+          py::arg("compress_level") = 6,
+          py::arg("interpolation") = "trilinear",
+          py::arg("resample") = "bilinear",
+          py::arg("input_format") = "auto");
 
     // 直接接受内容的版本
     m.def("generate_preview_from_data", &generate_preview_from_data_impl,
@@ -628,7 +6355,210 @@ PYBIND11_MODULE(lut_preview_cpp, m) {
           py::arg("lut_content"),
           py::arg("image_array"),
           py::arg("output_width"),
-          py::arg("output_height"));
+          py::arg("output_height"),
+          py::arg("compress_level") = 6,
+          py::arg("interpolation") = "trilinear",
+          py::arg("resample") = "bilinear",
+          py::arg("input_format") = "auto");
+
+    // 返回原始像素的版本，可直接构造 QImage
+    m.def("generate_preview_pixels", &generate_preview_pixels_impl,
+          "从 Lut 对象、LUT 内容或路径生成预览像素（numpy 数组，RGB888 或 RGBA8888）",
+          py::arg("lut"),
+          py::arg("image_array"),
+          py::arg("output_width"),
+          py::arg("output_height"),
+          py::arg("pixel_format") = "rgb",
+          py::arg("interpolation") = "trilinear",
+          py::arg("resample") = "bilinear",
+          py::arg("input_format") = "auto",
+          py::arg("out") = py::none());
+
+    // 批量版本：一次调用生成整个 LUT 库的缩略图
+    m.def("generate_previews_batch", &generate_previews_batch_impl,
+          "用同一张参考图像为多个 LUT 生成预览像素，返回与 luts 等长的列表（解析失败的条目为 None）",
+          py::arg("luts"),
+          py::arg("image_array"),
+          py::arg("output_width"),
+          py::arg("output_height"),
+          py::arg("pixel_format") = "rgb",
+          py::arg("interpolation") = "trilinear",
+          py::arg("resample") = "bilinear",
+          py::arg("input_format") = "auto",
+          py::arg("use_cache") = false,
+          py::arg("image_key") = 0);
+
+    // 经过预览缓存的版本：键为 LUT 格点、参考图像、尺寸与插值方式的 XXH64，任一输入变化自动失效
+    // image_key 为 image_content_key 预先算好的参考图像键，为 0 时每次调用现算
+    m.def("generate_preview_cached", &generate_preview_cached_impl,
+          "与 generate_preview_pixels 相同，但先查内存/磁盘预览缓存，未命中时生成并写回",
+          py::arg("lut"),
+          py::arg("image_array"),
+          py::arg("output_width"),
+          py::arg("output_height"),
+          py::arg("pixel_format") = "rgb",
+          py::arg("interpolation") = "trilinear",
+          py::arg("resample") = "bilinear",
+          py::arg("input_format") = "auto",
+          py::arg("image_key") = 0,
+          py::arg("out") = py::none());
+    m.def("lookup_preview", &lookup_preview_impl,
+          "只查预览缓存：命中返回像素数组（传入 out 时写入 out 并返回它），未命中返回 None",
+          py::arg("lut"),
+          py::arg("image_array"),
+          py::arg("output_width"),
+          py::arg("output_height"),
+          py::arg("pixel_format") = "rgb",
+          py::arg("interpolation") = "trilinear",
+          py::arg("resample") = "bilinear",
+          py::arg("input_format") = "auto",
+          py::arg("image_key") = 0,
+          py::arg("out") = py::none());
+    m.def("image_content_key", [](py::array image_array, const std::string& input_format) {
+        ImageView image = image_view(image_array, input_format);
+        py::gil_scoped_release release;
+        return image_content_hash(image);
+    },
+    "计算参考图像的缓存键，可作为 image_key 传给各缓存接口，同一参考图像反复查询时不必每次读遍全部像素",
+    py::arg("image_array"),
+    py::arg("input_format") = "auto");
+    m.def("set_preview_cache_dir", [](const std::string& dir) { PreviewCache::instance().set_dir(dir); },
+          "设置预览缓存的磁盘目录（为空时只使用内存层），并按磁盘层上限整理目录",
+          py::arg("cache_dir"),
+          py::call_guard<py::gil_scoped_release>());
+    m.def("get_preview_cache_dir", []() { return PreviewCache::instance().dir(); },
+          "获取预览缓存的磁盘目录");
+    m.def("set_preview_cache_limit", [](size_t limit_bytes) { PreviewCache::instance().set_limit(limit_bytes); },
+          "设置预览缓存内存层的字节上限",
+          py::arg("limit_bytes"));
+    m.def("set_preview_cache_disk_limit",
+          [](uint64_t limit_bytes) { PreviewCache::instance().set_disk_limit(limit_bytes); },
+          "设置预览缓存磁盘层的字节上限，超出时按修改时间从旧到新删除条目",
+          py::arg("limit_bytes"),
+          py::call_guard<py::gil_scoped_release>());
+    m.def("clear_preview_cache", [](bool disk) { PreviewCache::instance().clear(disk); },
+          "清空预览缓存内存层，disk 为 True 时同时删除磁盘条目",
+          py::arg("disk") = false);
+    m.def("get_preview_cache_info", []() { return PreviewCache::instance().info(); },
+          "获取预览缓存统计信息");
+
+    // 图集版本：N 个 LUT 的预览拼进一张图像，界面可从同一张 QPixmap 绘制全部卡片
+    m.def("generate_preview_atlas", &generate_preview_atlas_impl,
+          "为多个 LUT 生成预览并拼成一张图集，返回 (图集数组, 矩形列表)，矩形为 (x, y, 宽, 高)，解析失败的条目为 None",
+          py::arg("luts"),
+          py::arg("image_array"),
+          py::arg("cell_width"),
+          py::arg("cell_height"),
+          py::arg("columns") = 0,
+          py::arg("spacing") = 0,
+          py::arg("pixel_format") = "rgb",
+          py::arg("interpolation") = "trilinear",
+          py::arg("resample") = "bilinear",
+          py::arg("input_format") = "auto",
+          py::arg("use_cache") = false,
+          py::arg("image_key") = 0);
+
+    // 带示波器的版本：histogram (4, 256) 依次为 R/G/B/亮度；waveform (256, scope_width)；
+    // parade (3, 256, scope_width)；vectorscope (size, size)，横轴 Cb、纵轴 Cr，均为 uint32 计数
+    m.def("generate_preview_scopes", &generate_preview_scopes_impl,
+          "生成预览像素并统计源图与调色结果的直方图、波形、分量波形与矢量示波器，返回 (像素数组, {'source': ..., 'graded': ...})",
+          py::arg("lut"),
+          py::arg("image_array"),
+          py::arg("output_width"),
+          py::arg("output_height"),
+          py::arg("pixel_format") = "rgb",
+          py::arg("interpolation") = "trilinear",
+          py::arg("resample") = "bilinear",
+          py::arg("input_format") = "auto",
+          py::arg("scope_width") = 256,
+          py::arg("vectorscope_size") = 128);
+
+    // 多尺寸版本：只在最大尺寸上应用 LUT，较小尺寸由 mip 链缩小得到
+    m.def("generate_preview_mips", &generate_preview_mips_impl,
+          "一次生成多个尺寸（如 1x/2x/3x）的预览像素，返回与 sizes 顺序一致的 numpy 数组列表",
+          py::arg("lut"),
+          py::arg("image_array"),
+          py::arg("sizes"),
+          py::arg("pixel_format") = "rgb",
+          py::arg("interpolation") = "trilinear",
+          py::arg("resample") = "bilinear",
+          py::arg("input_format") = "auto");
+
+    // 异步版本：提交后立即返回任务句柄，可轮询、等待、调整优先级或取消
+    py::class_<PreviewTask, std::shared_ptr<PreviewTask>>(m, "PreviewTask", "异步预览任务句柄")
+        .def_property_readonly("state", &PreviewTask::state,
+                               "任务状态：pending、running、done、failed 或 cancelled")
+        .def("done", [](PreviewTask& task) { return task.job()->finished(); }, "任务是否已结束（含失败与取消）")
+        .def("cancel", [](PreviewTask& task) { PreviewScheduler::instance().cancel(task.job()); },
+             "取消任务：排队中的立即移出队列，运行中的在下一个行带前停止")
+        .def_property("priority",
+                      [](PreviewTask& task) { return PreviewScheduler::instance().priority(task.job()); },
+                      [](PreviewTask& task, int priority) { PreviewScheduler::instance().set_priority(task.job(), priority); },
+                      "优先级，数值大者先执行；排队中修改会立即调整顺序")
+        .def("draft_ready", &PreviewTask::draft_ready, "渐进式任务的草稿是否已就绪")
+        .def("result", &PreviewTask::result,
+             "等待并返回预览像素；timeout_ms < 0 时一直等待，超时返回 None，失败或被取消时抛出 RuntimeError；"
+             "draft 为 True 时正式结果之前先返回已就绪的 1/4 分辨率草稿",
+             py::arg("timeout_ms") = -1.0,
+             py::arg("draft") = false);
+
+    m.def("submit_preview", &submit_preview_impl,
+          "提交异步预览任务，返回 PreviewTask；priority 数值大者先执行，progressive 时先生成 1/4 分辨率的草稿",
+          py::arg("lut"),
+          py::arg("image_array"),
+          py::arg("output_width"),
+          py::arg("output_height"),
+          py::arg("pixel_format") = "rgb",
+          py::arg("interpolation") = "trilinear",
+          py::arg("resample") = "bilinear",
+          py::arg("input_format") = "auto",
+          py::arg("priority") = 0,
+          py::arg("progressive") = false);
+    m.def("get_pending_previews", []() { return PreviewScheduler::instance().pending(); },
+          "获取排队中（尚未开始）的异步预览任务数");
+
+    m.def("apply_lut", &apply_lut_impl,
+          "以原始分辨率对图像应用 LUT，返回同形状的数组（uint8/uint16/float32/float16，默认与输入相同）",
+          py::arg("lut"),
+          py::arg("image_array"),
+          py::arg("interpolation") = "trilinear",
+          py::arg("input_format") = "auto",
+          py::arg("output_dtype") = "");
+
+    py::class_<PreviewSession, std::shared_ptr<PreviewSession>>(m, "PreviewSession",
+        "常驻原始帧与效果帧的预览会话，调节 LUT 强度时只做一次混合")
+        .def(py::init(&create_preview_session_impl),
+             py::arg("lut"),
+             py::arg("image_array"),
+             py::arg("output_width"),
+             py::arg("output_height"),
+             py::arg("interpolation") = "trilinear",
+             py::arg("resample") = "bilinear",
+             py::arg("input_format") = "auto")
+        .def_property_readonly("width", &PreviewSession::width)
+        .def_property_readonly("height", &PreviewSession::height)
+        .def_property_readonly("has_alpha", &PreviewSession::has_alpha)
+        .def("set_lut", &preview_session_set_lut, "换用另一个 LUT 重新生成效果帧（不重新缩放）", py::arg("lut"))
+        .def("render", &preview_session_render,
+             "按强度（0~1）混合原始帧与效果帧，返回 (height, width, channels) 的 uint8 数组",
+             py::arg("strength") = 1.0f,
+             py::arg("pixel_format") = "rgb",
+             py::arg("out") = py::none());
+
+    m.def("compose_luts", &compose_luts_impl,
+          "将多个 LUT（Lut 对象、路径或内容，1D/3D 可混用）按顺序烘焙为一个 3D LUT，可选写出 .cube 文件",
+          py::arg("luts"),
+          py::arg("out_size") = 33,
+          py::arg("interpolation") = "trilinear",
+          py::arg("output_path") = "",
+          py::arg("title") = "");
+
+    m.def("resample_lut", &resample_lut_impl,
+          "将 LUT 重采样到 new_size 个格点（如 65 → 33 以减小体积、加快加载），可选写出 .cube 文件",
+          py::arg("lut"),
+          py::arg("new_size"),
+          py::arg("method") = "tetrahedral",
+          py::arg("output_path") = "");
 
     m.attr("__version__") = VERSION;
 }
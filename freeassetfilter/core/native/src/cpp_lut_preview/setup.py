@@ -76,13 +76,13 @@ if platform.system() == "Windows":
                 "-O3",
                 "-Wall",
                 "-Wextra",
-                "-fopenmp",
+                "-pthread",
                 "-std=c++17",
                 "-ffast-math",
                 "-march=native",
                 "-DMS_WIN64",
             ]
-            ext.extra_link_args = ["-fopenmp", "-static-libgcc", "-static-libstdc++"]
+            ext.extra_link_args = ["-pthread", "-static-libgcc", "-static-libstdc++"]
     else:
         info("[Setup] 使用 MSVC 编译器")
         for ext in ext_modules:
@@ -90,12 +90,10 @@ if platform.system() == "Windows":
                 "/O2",
                 "/W3",
                 "/EHsc",
-                "/openmp",
                 "/std:c++17",
                 "/utf-8",
                 "/MT",
             ]
-            ext.extra_link_args = ["/openmp"]
         
 elif platform.system() == "Darwin":
     for ext in ext_modules:
@@ -112,12 +110,12 @@ else:
             "-O3",
             "-Wall",
             "-Wextra",
-            "-fopenmp",
+            "-pthread",
             "-std=c++17",
             "-ffast-math",
             "-march=native",
         ]
-        ext.extra_link_args = ["-fopenmp"]
+        ext.extra_link_args = ["-pthread"]
 
 
 setup(
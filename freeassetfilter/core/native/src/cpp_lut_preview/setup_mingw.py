@@ -31,14 +31,14 @@ for ext in ext_modules:
         "-O3",
         "-Wall",
         "-Wextra",
-        "-fopenmp",
+        "-pthread",
         "-std=c++17",
         "-ffast-math",
         "-march=native",
         "-DMS_WIN64",
     ]
     ext.extra_link_args = [
-        "-fopenmp",
+        "-pthread",
         "-static-libgcc",
         "-static-libstdc++",
     ]
@@ -262,6 +262,43 @@ class CubeLUTParser:
         return out_r, out_g, out_b
 
 
+def read_lut_info(file_path: str) -> Tuple[Optional[Dict[str, Any]], str]:
+    """
+    解析LUT文件并返回基本信息
+
+    优先使用 C++ 解析器（内存映射 + 单遍扫描，大尺寸 LUT 只受磁盘读取速度限制），
+    不可用时回退到 Python 解析器
+
+    Args:
+        file_path: LUT文件路径
+
+    Returns:
+        Tuple[Optional[Dict[str, Any]], str]: (LUT信息, 错误信息)
+    """
+    try:
+        from freeassetfilter.core.native.src import cpp_lut_preview
+        if ((cpp_lut_preview.is_cpp_available() or cpp_lut_preview._try_import_cpp_module())
+                and cpp_lut_preview.has_cpp_api("Lut")):
+            try:
+                lut = cpp_lut_preview.parse_lut_file(file_path)
+            except (RuntimeError, ValueError) as e:
+                # C++ 解析器的错误信息包含出错行号
+                return None, str(e)
+            return {
+                'title': lut.title,
+                'size': lut.size,
+                'is_3d': lut.is_3d,
+                'data_count': lut.size ** (3 if lut.is_3d else 1),
+            }, ""
+    except (ImportError, AttributeError) as e:
+        debug(f"C++ LUT解析器不可用，使用Python解析: {e}")
+
+    parser = CubeLUTParser(file_path)
+    if not parser.parse():
+        return None, "LUT文件解析失败，文件可能已损坏"
+    return parser.get_info(), ""
+
+
 def validate_lut_file(file_path: str) -> Tuple[bool, str]:
     """
     验证LUT文件是否有效
@@ -292,11 +329,10 @@ def validate_lut_file(file_path: str) -> Tuple[bool, str]:
         return False, "文件过大"
 
     # 尝试解析文件
-    parser = CubeLUTParser(file_path)
-    if not parser.parse():
-        return False, "LUT文件解析失败，文件可能已损坏"
+    lut_info, parse_error = read_lut_info(file_path)
+    if lut_info is None:
+        return False, parse_error or "LUT文件解析失败，文件可能已损坏"
 
-    lut_info = parser.get_info()
     if lut_info['size'] == 0:
         return False, "LUT大小无效"
 
@@ -320,13 +356,167 @@ def get_lut_preview_dir() -> str:
     return str(preview_dir)
 
 
-def copy_lut_file(source_path: str, lut_id: Optional[str] = None) -> Tuple[bool, str]:
+def get_lut_preview_path(file_path: str) -> str:
+    """
+    获取LUT按id保存的预览图路径（{id}_preview.png）
+
+    C++ 预览缓存不可用时（如预编译模块早于当前源码），预览图按此路径保存与读取
+
+    Args:
+        file_path: LUT文件路径
+
+    Returns:
+        str: 预览图路径
+    """
+    file_name = Path(file_path).stem
+    parts = file_name.split('_', 1)
+    lut_id = parts[0] if len(parts) > 1 and len(parts[0]) == 36 else file_name
+    return os.path.join(get_lut_preview_dir(), f"{lut_id}_preview.png")
+
+
+def get_lut_binary_cache_dir() -> str:
+    """获取二进制LUT缓存（.lutc）存储目录"""
+    base_dir = Path(__file__).parent.parent.parent
+    cache_dir = base_dir / "data" / "lut_cache"
+    cache_dir.mkdir(parents=True, exist_ok=True)
+    return str(cache_dir)
+
+
+def enable_lut_binary_cache() -> bool:
+    """
+    为C++ LUT模块启用二进制缓存，可重复调用
+
+    Returns:
+        bool: 是否已启用（C++模块不可用时为False）
+    """
+    try:
+        from freeassetfilter.core.native.src import cpp_lut_preview
+        if not (cpp_lut_preview.is_cpp_available() or cpp_lut_preview._try_import_cpp_module()):
+            return False
+        cpp_lut_preview.set_lut_binary_cache_dir(get_lut_binary_cache_dir())
+        return True
+    except (ImportError, AttributeError, RuntimeError, OSError) as e:
+        debug(f"启用二进制LUT缓存失败: {e}")
+        return False
+
+
+def enable_lut_preview_cache() -> bool:
+    """
+    为C++ LUT模块启用预览缓存的磁盘层（LUT预览图目录），可重复调用
+
+    Returns:
+        bool: 是否已启用（C++模块不可用时为False）
+    """
+    try:
+        from freeassetfilter.core.native.src import cpp_lut_preview
+        if not (cpp_lut_preview.is_cpp_available() or cpp_lut_preview._try_import_cpp_module()):
+            return False
+        cpp_lut_preview.set_preview_cache_dir(get_lut_preview_dir())
+        return True
+    except (ImportError, AttributeError, RuntimeError, OSError) as e:
+        debug(f"启用LUT预览缓存失败: {e}")
+        return False
+
+
+def cache_lut_binary(lut_path: str) -> bool:
+    """
+    为LUT文件生成二进制缓存，之后加载该LUT直接内存映射，无需解析文本
+
+    Args:
+        lut_path: LUT文件路径
+
+    Returns:
+        bool: 是否成功
+    """
+    if not enable_lut_binary_cache():
+        return False
+    try:
+        from freeassetfilter.core.native.src import cpp_lut_preview
+        cpp_lut_preview.load_lut(lut_path)
+        return True
+    except (ImportError, AttributeError, RuntimeError) as e:
+        warning(f"生成LUT二进制缓存失败: {e}")
+        return False
+
+
+def _get_lut_binary_path(lut_path: str) -> str:
+    """获取LUT文件的二进制缓存路径，未启用或C++模块不可用时返回空字符串"""
+    if not enable_lut_binary_cache():
+        return ""
+    try:
+        from freeassetfilter.core.native.src import cpp_lut_preview
+        return cpp_lut_preview.get_lut_binary_path(lut_path)
+    except (ImportError, AttributeError, RuntimeError):
+        return ""
+
+
+# 播放副本的格点数：33³ 在画质与 mpv 加载耗时之间取平衡
+LUT_PLAYBACK_SIZE = 33
+
+
+def get_lut_playback_copy_path(lut_path: str) -> str:
+    """获取LUT播放副本的路径（与原文件同目录）"""
+    path = Path(lut_path)
+    return str(path.with_name(f"{path.stem}.playback.cube"))
+
+
+def get_lut_playback_path(lut_path: str) -> str:
+    """
+    获取播放时实际加载的LUT路径
+
+    存在不早于原文件的播放副本时返回副本路径，否则返回原路径
+
+    Args:
+        lut_path: LUT文件路径
+
+    Returns:
+        str: 播放时使用的LUT路径
+    """
+    copy_path = get_lut_playback_copy_path(lut_path)
+    try:
+        if os.path.getmtime(copy_path) >= os.path.getmtime(lut_path):
+            return copy_path
+    except OSError:
+        pass
+    return lut_path
+
+
+def create_lut_playback_copy(lut_path: str, playback_size: int = LUT_PLAYBACK_SIZE) -> Optional[str]:
+    """
+    为大尺寸3D LUT生成降采样的播放副本，减少播放时切换LUT的加载耗时
+
+    Args:
+        lut_path: LUT文件路径
+        playback_size: 播放副本的格点数
+
+    Returns:
+        Optional[str]: 副本路径，LUT无需降采样或C++模块不可用时返回None
+    """
+    try:
+        from freeassetfilter.core.native.src import cpp_lut_preview
+        if not (cpp_lut_preview.is_cpp_available() or cpp_lut_preview._try_import_cpp_module()):
+            return None
+        lut = cpp_lut_preview.load_lut(lut_path)
+        if not lut.is_3d or lut.size <= playback_size:
+            return None
+        copy_path = get_lut_playback_copy_path(lut_path)
+        cpp_lut_preview.resample_lut(lut, playback_size, output_path=copy_path)
+        debug(f"LUT播放副本已生成: {copy_path}")
+        return copy_path
+    except (ImportError, AttributeError, RuntimeError) as e:
+        warning(f"生成LUT播放副本失败: {e}")
+        return None
+
+
+def copy_lut_file(source_path: str, lut_id: Optional[str] = None,
+                  playback_size: Optional[int] = None) -> Tuple[bool, str]:
     """
     复制LUT文件到应用数据目录
 
     Args:
         source_path: 源文件路径
         lut_id: LUT唯一标识，如不提供则自动生成
+        playback_size: 指定时为大于该尺寸的3D LUT额外生成降采样的播放副本（失败不影响复制结果）
 
     Returns:
         Tuple[bool, str]: (是否成功, 目标路径或错误信息)
@@ -356,6 +546,10 @@ def copy_lut_file(source_path: str, lut_id: Optional[str] = None) -> Tuple[bool,
         shutil.copy2(source_path, target_path)
         debug(f"LUT文件复制成功: {target_path}")
 
+        cache_lut_binary(target_path)
+        if playback_size:
+            create_lut_playback_copy(target_path, playback_size)
+
         return True, target_path
 
     except (OSError, shutil.Error) as e:
@@ -363,27 +557,56 @@ def copy_lut_file(source_path: str, lut_id: Optional[str] = None) -> Tuple[bool,
         return False, f"复制文件失败: {str(e)}"
 
 
+def _evict_native_lut(lut_path: str):
+    """让C++ LUT缓存释放该文件的句柄及其.lutc映射，模块不可用或缺少接口时跳过"""
+    try:
+        from freeassetfilter.core.native.src import cpp_lut_preview
+        if cpp_lut_preview.has_cpp_api("evict_lut"):
+            cpp_lut_preview.evict_lut(lut_path)
+    except (ImportError, RuntimeError) as e:
+        debug(f"释放LUT缓存失败: {e}")
+
+
+def _remove_derived_file(path: str):
+    """删除由LUT派生的文件（.lutc缓存、播放副本），失败只记录：仍被映射或占用时留待下次覆盖"""
+    try:
+        if path and os.path.exists(path):
+            os.remove(path)
+    except OSError as e:
+        warning(f"删除LUT派生文件失败: {path}: {e}")
+
+
 def remove_lut_file(file_path: str) -> bool:
     """
     删除LUT文件
 
+    先释放C++缓存对该文件的映射并删除.cube本身，再尽力删除.lutc缓存和播放副本
+
     Args:
         file_path: LUT文件路径
 
     Returns:
-        bool: 是否成功
+        bool: .cube文件是否已删除
     """
     debug(f"删除LUT文件: {file_path}")
 
+    copy_path = get_lut_playback_copy_path(file_path)
+    binary_path = _get_lut_binary_path(file_path)
+    _evict_native_lut(file_path)
+    _evict_native_lut(copy_path)
+
     try:
         if os.path.exists(file_path):
             os.remove(file_path)
             debug(f"LUT文件删除成功: {file_path}")
-        return True
     except OSError as e:
         error(f"删除LUT文件失败: {e}")
         return False
 
+    _remove_derived_file(binary_path)
+    _remove_derived_file(copy_path)
+    return True
+
 
 def get_lut_display_name(file_path: str) -> str:
     """
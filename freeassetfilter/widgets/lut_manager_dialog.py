@@ -35,9 +35,11 @@ from freeassetfilter.widgets.smooth_scroller import SmoothScroller
 from freeassetfilter.utils.lut_utils import (
     LUTInfo, validate_lut_file, copy_lut_file, remove_lut_file,
     get_lut_display_name, load_lut_from_settings, save_lut_to_settings,
-    remove_lut_from_settings, get_lut_storage_dir, get_lut_preview_dir
+    remove_lut_from_settings, get_lut_preview_path, LUT_PLAYBACK_SIZE
+)
+from freeassetfilter.core.native.bridges.lut_preview_generator import (
+    generate_lut_preview, get_cached_lut_preview, create_default_reference_image
 )
-from freeassetfilter.core.native.bridges.lut_preview_generator import generate_lut_preview, create_default_reference_image
 from freeassetfilter.utils.app_logger import info, debug, warning
 
 
@@ -56,23 +58,22 @@ class LutImportWorker(QThread):
             lut_id = str(uuid.uuid4())
             self.progress_updated.emit(1)
 
-            success, result = copy_lut_file(self.file_path, lut_id)
+            success, result = copy_lut_file(self.file_path, lut_id, playback_size=LUT_PLAYBACK_SIZE)
             if not success:
                 self.import_error.emit(result)
                 return
 
             self.progress_updated.emit(2)
 
-            from freeassetfilter.utils.lut_utils import CubeLUTParser
-            parser = CubeLUTParser(result)
-            parser.parse()
-            info = parser.get_info()
+            from freeassetfilter.utils.lut_utils import read_lut_info
+            info, _ = read_lut_info(result)
+            info = info or {}
 
             self.progress_updated.emit(3)
 
             try:
                 from freeassetfilter.core.native.bridges.lut_preview_generator import generate_lut_preview
-                generate_lut_preview(result, lut_id)
+                generate_lut_preview(result)
             except Exception as e:
                 warning(f"生成LUT预览图失败: {e}")
 
@@ -93,6 +94,32 @@ class LutImportWorker(QThread):
             self.import_error.emit(str(e))
 
 
+class LutPreviewBatchWorker(QThread):
+    """LUT 预览批量生成工作线程，按小批调用原生批量接口补齐缺失的预览图，批与批之间响应中断"""
+    previews_ready = Signal(int)
+
+    # 每批的LUT数，决定请求中断后最长的等待时间
+    BATCH_SIZE = 16
+
+    def __init__(self, luts: List[str], parent=None):
+        super().__init__(parent)
+        self.luts = luts
+
+    def run(self):
+        count = 0
+        try:
+            from freeassetfilter.core.native.bridges.lut_preview_generator import generate_lut_previews
+            for start in range(0, len(self.luts), self.BATCH_SIZE):
+                if self.isInterruptionRequested():
+                    return
+                results = generate_lut_previews(self.luts[start:start + self.BATCH_SIZE])
+                count += sum(1 for ok in results if ok)
+        except Exception as e:
+            warning(f"批量生成LUT预览图失败: {e}")
+        if not self.isInterruptionRequested():
+            self.previews_ready.emit(count)
+
+
 class LutManagerDialog(CustomMessageBox):
     """
     LUT管理弹窗
@@ -121,6 +148,8 @@ class LutManagerDialog(CustomMessageBox):
             self.settings_manager = SettingsManager()
         self.lut_list: List[LUTInfo] = []
         self.lut_cards = []  # 存储卡片和对应的LUT信息
+        self._lut_previews = set()  # 已从预览缓存取到图标的LUT id
+        self._lut_preview_worker: Optional[LutPreviewBatchWorker] = None
         self.selected_lut_id: Optional[str] = None
         self.active_lut_id: Optional[str] = None
         self._clicked_button_index: int = -1
@@ -140,6 +169,9 @@ class LutManagerDialog(CustomMessageBox):
         
         # 加载LUT列表
         self._load_lut_list()
+        
+        # 对话框关闭时停止后台预览生成，避免线程对象随对话框销毁时仍在运行
+        self.finished.connect(self._stop_preview_worker)
     
     def _ensure_reference_image(self):
         """确保参考图像存在"""
@@ -225,6 +257,40 @@ class LutManagerDialog(CustomMessageBox):
             self.active_lut_id = self.settings_manager.get_setting("video.active_lut_id", None)
         
         self._refresh_lut_cards()
+        self._generate_missing_previews()
+    
+    def _generate_missing_previews(self):
+        """后台批量生成缺失的LUT预览图，完成后刷新卡片图标"""
+        missing = [
+            lut_info.path for lut_info in self.lut_list
+            if os.path.exists(lut_info.path) and lut_info.id not in self._lut_previews
+        ]
+        if not missing:
+            return
+        
+        debug(f"批量生成 {len(missing)} 个缺失的LUT预览图")
+        self._stop_preview_worker()
+        self._lut_preview_worker = LutPreviewBatchWorker(missing)
+        weak_self = weakref.ref(self)
+        self._lut_preview_worker.previews_ready.connect(
+            lambda count: count and (s := weak_self()) and s._refresh_lut_cards()
+        )
+        self._lut_preview_worker.finished.connect(self._lut_preview_worker.deleteLater)
+        self._lut_preview_worker.start()
+    
+    def _stop_preview_worker(self):
+        """请求后台预览线程退出并等待当前小批完成"""
+        worker = self._lut_preview_worker
+        self._lut_preview_worker = None
+        if worker is None:
+            return
+        try:
+            if worker.isRunning():
+                worker.requestInterruption()
+                worker.wait()
+        except RuntimeError:
+            # 线程结束后已由 deleteLater 销毁
+            pass
     
     def _refresh_lut_cards(self):
         """刷新LUT卡片显示"""
@@ -234,6 +300,7 @@ class LutManagerDialog(CustomMessageBox):
             if item.widget():
                 item.widget().deleteLater()
         self.lut_cards.clear()
+        self._lut_previews.clear()
         
         # 创建新卡片
         for lut_info in self.lut_list:
@@ -273,19 +340,12 @@ class LutManagerDialog(CustomMessageBox):
         # 设置自定义第二行文本显示UUID
         card.set_custom_info_text(f"UUID: {lut_info.id}")
         
-        # 使用LUT预览图作为图标
-        preview_dir = get_lut_preview_dir()
-        preview_path = os.path.join(preview_dir, f"{lut_info.id}_preview.png")
-        if os.path.exists(preview_path):
-            try:
-                from PySide6.QtGui import QPixmap, QImage
-                scaled_icon_size = int(40 * self.dpi_scale)
-                image = QImage(preview_path)
-                if not image.isNull():
-                    pixmap = QPixmap.fromImage(image)
-                    card._set_icon_pixmap(pixmap, scaled_icon_size)
-            except (OSError, IOError) as e:
-                warning(f"加载LUT预览图文件失败: {e}")
+        # 使用LUT预览图作为图标（预览缓存按LUT内容寻址，LUT文件变化后自动失效）
+        if os.path.exists(lut_info.path):
+            pixmap = get_cached_lut_preview(lut_info.path)
+            if pixmap is not None and not pixmap.isNull():
+                self._lut_previews.add(lut_info.id)
+                card._set_icon_pixmap(pixmap, int(40 * self.dpi_scale))
         
         # 连接卡片信号（参考收藏夹实现）
         weak_self = weakref.ref(self)
@@ -372,9 +432,10 @@ class LutManagerDialog(CustomMessageBox):
         """删除LUT"""
         # 删除文件
         remove_lut_file(file_path)
+        self._lut_previews.discard(lut_id)
         
-        # 删除预览图缓存
-        preview_path = Path(get_lut_storage_dir()).parent / "lut_previews" / f"{lut_id}_preview.png"
+        # 删除按LUT id保存的预览图（原生预览缓存不可用时使用）
+        preview_path = Path(get_lut_preview_path(file_path))
         if preview_path.exists():
             try:
                 preview_path.unlink()
@@ -9,6 +9,40 @@ import os
 from pathlib import Path
 
 
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
+# LUT 预览测试用到的原生接口；仓库中预编译的旧版模块能导入但缺少这些接口
+_CPP_LUT_API = (
+    "generate_preview_pixels", "generate_previews_batch", "apply_lut", "set_num_threads",
+    "get_scratch_info", "compose_luts", "resample_lut", "load_lut", "evict_lut",
+    "set_lut_binary_cache_dir", "PreviewSession", "generate_preview_mips", "submit_preview",
+    "generate_preview_cached", "lookup_preview", "image_content_key", "set_preview_cache_disk_limit",
+    "generate_preview_atlas", "generate_preview_scopes", "get_lut_cache_info",
+)
+
+
+@pytest.fixture(scope="module")
+def cpp_lut():
+    """已编译且提供当前接口的 cpp_lut_preview 包装模块，否则跳过"""
+    pytest.importorskip("numpy")
+    from freeassetfilter.core.native.src import cpp_lut_preview
+    if not cpp_lut_preview._try_import_cpp_module():
+        pytest.skip("C++ LUT 预览未编译")
+    if not cpp_lut_preview.has_cpp_api(*_CPP_LUT_API):
+        pytest.skip("C++ LUT 预览模块版本过旧，需要重新编译")
+    return cpp_lut_preview
+
+
+def identity_lut(invert_r: bool = False) -> str:
+    """2 格点的恒等 3D LUT 内容，invert_r 时反相红色通道"""
+    return "LUT_3D_SIZE 2\n" + "\n".join(
+        f"{1 - r if invert_r else r} {g} {b}" for b in (0, 1) for g in (0, 1) for r in (0, 1)
+    )
+
+
 class TestCppColorExtractor:
     """测试 C++ 颜色提取器扩展"""
     
@@ -63,6 +97,484 @@ class TestCppLutPreview:
             assert True
         except ImportError as e:
             pytest.skip(f"C++ LUT 预览未编译或无法导入: {e}")
+    
+    def test_cpp_lut_preview_png_is_compressed(self, cpp_lut):
+        """测试 C++ LUT 预览输出的 PNG 经过真实 DEFLATE 压缩且可无损解码"""
+        import struct
+        import zlib
+
+        lut = identity_lut()
+        image = np.tile(np.arange(64, dtype=np.uint8)[None, :, None] * 4, (64, 1, 3))
+        png = cpp_lut.generate_preview(lut, image, 64, 64, compress_level=9)
+        
+        assert png[:8] == b"\x89PNG\r\n\x1a\n"
+        pos, idat = 8, b""
+        while pos < len(png):
+            length, chunk_type = struct.unpack(">I4s", png[pos:pos + 8])
+            if chunk_type == b"IDAT":
+                idat += png[pos + 8:pos + 8 + length]
+            pos += 12 + length
+        raw = zlib.decompress(idat)
+        assert len(raw) == 64 * (1 + 64 * 3)
+        assert len(png) < len(raw) // 4
+
+    def test_cpp_lut_preview_tetrahedral_matches_identity(self, cpp_lut):
+        """测试四面体插值在恒等 LUT 下与三线性结果一致，且拒绝未知插值方式"""
+        lut = identity_lut()
+        rng = np.random.default_rng(0)
+        image = rng.integers(0, 256, size=(32, 32, 3), dtype=np.uint8)
+        tri = cpp_lut.generate_preview_pixels(lut, image, 32, 32)
+        tet = cpp_lut.generate_preview_pixels(lut, image, 32, 32, interpolation="tetrahedral")
+
+        assert np.abs(tri.astype(int) - tet.astype(int)).max() <= 1
+        with pytest.raises(RuntimeError):
+            cpp_lut.generate_preview_pixels(lut, image, 32, 32, interpolation="cubic")
+
+    def test_cpp_lut_preview_fixed_matches_float(self, cpp_lut):
+        """测试 8 位定点内核与浮点内核的量化一致：相差不超过 1 且没有系统性偏差"""
+        rng = np.random.default_rng(8)
+        lut_3d = "LUT_3D_SIZE 17\n" + "\n".join(
+            f"{r:.6f} {g:.6f} {b:.6f}" for r, g, b in rng.random((17 ** 3, 3))
+        )
+        lut_1d = "LUT_1D_SIZE 5\n0 0 0\n0.1 0.3 0.2\n0.4 0.5 0.6\n0.7 0.9 0.8\n1 1 1"
+        rgb = rng.integers(0, 256, size=(64, 64, 3), dtype=np.uint8)
+        unit = rgb.astype(np.float32) / 255.0
+        for lut in (lut_3d, lut_1d):
+            for interpolation in ("trilinear", "tetrahedral"):
+                fixed = cpp_lut.apply_lut(lut, rgb, interpolation).astype(int)
+                wide = cpp_lut.apply_lut(lut, unit, interpolation, output_dtype="uint8").astype(int)
+                assert np.abs(fixed - wide).max() <= 1
+                assert abs((fixed - wide).mean()) < 0.1
+
+    def test_cpp_lut_preview_batch_matches_single(self, cpp_lut):
+        """测试批量预览与逐个生成结果一致，无法解析的 LUT 返回 None"""
+        lut = identity_lut(invert_r=True)
+        image = np.tile(np.arange(48, dtype=np.uint8)[None, :, None] * 5, (40, 1, 3))
+        previews = cpp_lut.generate_previews_batch([lut, "LUT_3D_SIZE 2\n0 0"], image, 24, 20)
+
+        assert len(previews) == 2
+        assert previews[1] is None
+        single = cpp_lut.generate_preview_pixels(lut, image, 24, 20)
+        assert np.array_equal(previews[0], single)
+
+    def test_cpp_lut_preview_resample_filters(self, cpp_lut):
+        """测试各缩放滤波器保持纯色图像不变、高频图案缩小后不产生混叠，且拒绝未知滤波器"""
+        lut = identity_lut()
+        flat = np.full((90, 120, 3), 77, dtype=np.uint8)
+        checker = ((np.indices((96, 128)).sum(axis=0) % 2) * 255).astype(np.uint8)
+        checker = np.repeat(checker[:, :, None], 3, axis=2)
+        for resample in ("box", "bilinear", "lanczos3"):
+            pixels = cpp_lut.generate_preview_pixels(lut, flat, 37, 23, resample=resample)
+            assert np.all(pixels == 77)
+            pixels = cpp_lut.generate_preview_pixels(lut, checker, 16, 12, resample=resample)
+            assert np.abs(pixels.astype(int) - 128).max() <= 2
+        with pytest.raises(RuntimeError):
+            cpp_lut.generate_preview_pixels(lut, flat, 16, 16, resample="cubic")
+
+    def test_cpp_lut_preview_strided_bgra_input(self, cpp_lut):
+        """测试带行填充的 BGRA 视图与紧凑 RGB 输入结果一致，且 alpha 传递到输出"""
+        lut = identity_lut(invert_r=True)
+        rng = np.random.default_rng(1)
+        rgb = rng.integers(0, 256, size=(40, 50, 3), dtype=np.uint8)
+        padded = np.zeros((40, 53, 4), dtype=np.uint8)
+        padded[:, :50, :3] = rgb[:, :, ::-1]
+        padded[:, :50, 3] = 200
+        bgra = padded[:, :50]
+
+        expected = cpp_lut.generate_preview_pixels(lut, rgb, 25, 20)
+        pixels = cpp_lut.generate_preview_pixels(lut, bgra, 25, 20, pixel_format="rgba",
+                                                         input_format="bgra")
+        assert np.array_equal(pixels[:, :, :3], expected)
+        assert np.all(pixels[:, :, 3] == 200)
+        strided = cpp_lut.generate_preview_pixels(lut, rgb[:, ::2], 25, 20)
+        assert np.array_equal(strided, cpp_lut.generate_preview_pixels(
+            lut, np.ascontiguousarray(rgb[:, ::2]), 25, 20))
+
+    def test_cpp_lut_preview_apply_lut_wide_dtypes(self, cpp_lut):
+        """测试 uint16/float32/float16 输入与 8 位结果一致，且默认保持输入 dtype"""
+        lut = identity_lut(invert_r=True)
+        rng = np.random.default_rng(2)
+        rgb = rng.integers(0, 256, size=(16, 24, 3), dtype=np.uint8)
+        expected = cpp_lut.apply_lut(lut, rgb).astype(int)
+
+        wide = cpp_lut.apply_lut(lut, rgb.astype(np.uint16) * 257)
+        assert wide.dtype == np.uint16
+        assert np.abs(wide.astype(int) // 257 - expected).max() <= 1
+        for dtype in (np.float32, np.float16):
+            out = cpp_lut.apply_lut(lut, (rgb / 255.0).astype(dtype), output_dtype="uint8")
+            assert out.dtype == np.uint8
+            assert np.abs(out.astype(int) - expected).max() <= 1
+        assert cpp_lut.apply_lut(lut, rgb, output_dtype="float16").dtype == np.float16
+
+    def test_cpp_lut_preview_large_1d_lut(self, cpp_lut, tmp_path):
+        """测试 1024 项的 1D LUT 可以解析、加载和应用：256 的格点上限只适用于 3D LUT"""
+        size = 1024
+        lut_path = tmp_path / "curve.cube"
+        lut_path.write_text(f"LUT_1D_SIZE {size}\n" + "\n".join(
+            f"{1 - i / (size - 1):.6f} {i / (size - 1):.6f} {i / (size - 1):.6f}" for i in range(size)
+        ))
+        lut = cpp_lut.parse_lut_file(str(lut_path))
+        assert not lut.is_3d and lut.size == size
+        assert cpp_lut.load_lut(str(lut_path)).size == size
+
+        rgb = np.random.default_rng(9).integers(0, 256, size=(16, 24, 3), dtype=np.uint8)
+        expected = rgb.astype(int)
+        expected[..., 0] = 255 - expected[..., 0]
+        assert np.abs(cpp_lut.apply_lut(lut, rgb).astype(int) - expected).max() <= 1
+        assert cpp_lut.resample_lut(lut, 4096).size == 4096
+
+        too_large = tmp_path / "too_large.cube"
+        too_large.write_text("LUT_3D_SIZE 257\n")
+        with pytest.raises(RuntimeError, match="LUT_3D_SIZE"):
+            cpp_lut.parse_lut_file(str(too_large))
+
+    def test_cpp_lut_preview_thread_count_independent(self, cpp_lut):
+        """测试线程池线程数不影响结果，且多个 Python 线程可同时调用"""
+        from concurrent.futures import ThreadPoolExecutor
+
+        lut = identity_lut(invert_r=True)
+        image = np.random.default_rng(4).integers(0, 256, size=(300, 400, 3), dtype=np.uint8)
+        cpp_lut.set_num_threads(1)
+        try:
+            expected = cpp_lut.generate_preview_pixels(lut, image, 160, 120)
+        finally:
+            cpp_lut.set_num_threads(0)
+        assert cpp_lut.get_num_threads() >= 1
+
+        with ThreadPoolExecutor(max_workers=4) as executor:
+            results = list(executor.map(
+                lambda _: cpp_lut.generate_preview_pixels(lut, image, 160, 120), range(8)
+            ))
+        for result in results:
+            assert np.array_equal(result, expected)
+
+    def test_cpp_lut_preview_scratch_reused(self, cpp_lut, tmp_path):
+        """测试稳态下重复生成同尺寸预览不再分配堆内存：暂存区不申请新块，传入 out 时也不新建输出数组"""
+        lut_path = tmp_path / "identity.cube"
+        lut_path.write_text(identity_lut())
+        lut = cpp_lut.load_lut(str(lut_path))
+        image = np.random.default_rng(3).integers(0, 256, size=(480, 640, 4), dtype=np.uint8)
+        out = np.empty((240, 320, 4), dtype=np.uint8)
+
+        def render():
+            result = cpp_lut.generate_preview_pixels(lut, image, 320, 240, "rgba", resample="lanczos3", out=out)
+            assert np.shares_memory(result, out)
+
+        # 任务由哪个工作线程领取并不固定：按线程数放大预热轮数，让每个工作线程都领到过各类任务
+        for _ in range(8 * cpp_lut.get_num_threads()):
+            render()
+        before = cpp_lut.get_scratch_info()
+        for _ in range(10):
+            render()
+        info = cpp_lut.get_scratch_info()
+        assert info["allocations"] == before["allocations"]
+        assert info["heap_allocations"] == before["heap_allocations"]
+
+        # 预览缓存内存层命中时同样不分配
+        cpp_lut.generate_preview_cached(lut, image, 320, 240, "rgba", out=out)
+        expected = out.copy()
+        assert cpp_lut.lookup_preview(lut, image, 320, 240, "rgba", out=out) is not None
+        before = cpp_lut.get_scratch_info()
+        for _ in range(10):
+            cpp_lut.generate_preview_cached(lut, image, 320, 240, "rgba", out=out)
+            assert cpp_lut.lookup_preview(lut, image, 320, 240, "rgba", out=out) is not None
+        after = cpp_lut.get_scratch_info()
+        assert after["allocations"] == before["allocations"]
+        assert after["heap_allocations"] == before["heap_allocations"]
+        assert np.array_equal(out, expected)
+
+        # 不传 out 时每次新建一个输出数组，计入 heap_allocations
+        cpp_lut.generate_preview_pixels(lut, image, 320, 240, "rgba", resample="lanczos3")
+        assert cpp_lut.get_scratch_info()["heap_allocations"] == after["heap_allocations"] + 1
+        with pytest.raises(RuntimeError):
+            cpp_lut.generate_preview_pixels(lut, image, 320, 240, "rgb", out=out)
+
+        cpp_lut.trim_scratch()
+        assert cpp_lut.get_scratch_info()["reserved_bytes"] < info["reserved_bytes"]
+
+    def test_cpp_lut_preview_compose_luts(self, cpp_lut, tmp_path):
+        """测试合成后的 LUT 与依次应用各 LUT 的结果一致，并可写出 .cube 文件"""
+        invert = identity_lut(invert_r=True)
+        curve = "LUT_1D_SIZE 3\n0 0 0\n0.25 0.5 0.5\n1 1 1"
+        image = np.random.default_rng(4).random((16, 16, 3), dtype=np.float32)
+        expected = cpp_lut.apply_lut(curve, cpp_lut.apply_lut(invert, image))
+
+        output_path = tmp_path / "composed.cube"
+        composed = cpp_lut.compose_luts([invert, curve], 17, output_path=str(output_path))
+        assert composed.is_3d and composed.size == 17
+        assert np.abs(cpp_lut.apply_lut(composed, image) - expected).max() < 1e-4
+        reloaded = cpp_lut.apply_lut(str(output_path), image)
+        assert np.abs(reloaded - expected).max() < 1e-4
+
+        with pytest.raises(RuntimeError):
+            cpp_lut.compose_luts([])
+
+    def test_cpp_lut_preview_resample_lut(self, cpp_lut, tmp_path):
+        """测试 LUT 重采样：升采样再降回原尺寸时格点不变，并可写出 .cube 文件"""
+        lut = "LUT_3D_SIZE 3\n" + "\n".join(
+            f"{(r / 2) ** 2} {g / 2} {1 - b / 2}" for b in range(3) for g in range(3) for r in range(3)
+        )
+        image = np.random.default_rng(5).random((16, 16, 3), dtype=np.float32)
+        expected = cpp_lut.apply_lut(lut, image)
+
+        output_path = tmp_path / "resampled.cube"
+        upsampled = cpp_lut.resample_lut(lut, 5, "trilinear")
+        restored = cpp_lut.resample_lut(upsampled, 3, "trilinear", output_path=str(output_path))
+        assert upsampled.size == 5 and restored.size == 3
+        assert np.abs(cpp_lut.apply_lut(restored, image) - expected).max() < 1e-5
+        assert np.abs(cpp_lut.apply_lut(str(output_path), image) - expected).max() < 1e-5
+
+    def test_cpp_lut_preview_binary_cache(self, cpp_lut, tmp_path):
+        """测试二进制 LUT 缓存：源文件内容未变时直接映射，内容变化后重新解析"""
+        lut_path = tmp_path / "grade.cube"
+        lut_path.write_text("LUT_3D_SIZE 2\n" + "\n".join(
+            f"{r} {g * 0.5} {b}" for b in (0, 1) for g in (0, 1) for r in (0, 1)
+        ))
+        image = np.random.default_rng(6).integers(0, 256, size=(8, 8, 3), dtype=np.uint8)
+
+        cpp_lut.set_lut_binary_cache_dir(str(tmp_path / "cache"))
+        try:
+            parsed = cpp_lut.load_lut(str(lut_path))
+            assert not parsed.mapped
+            assert os.path.exists(cpp_lut.get_lut_binary_path(str(lut_path)))
+
+            # 只改修改时间：按内容哈希确认后仍使用映射的缓存
+            stat = os.stat(lut_path)
+            os.utime(lut_path, ns=(stat.st_atime_ns, stat.st_mtime_ns + 10 ** 9))
+            mapped = cpp_lut.load_lut(str(lut_path))
+            assert mapped.mapped
+            assert np.array_equal(cpp_lut.apply_lut(mapped, image),
+                                  cpp_lut.apply_lut(parsed, image))
+
+            # 时间戳已写回 .lutc：再次加载直接映射，不再读取和哈希源文件
+            before = cpp_lut.get_lut_cache_info()
+            assert cpp_lut.evict_lut(str(lut_path))
+            assert cpp_lut.load_lut(str(lut_path)).mapped
+            after = cpp_lut.get_lut_cache_info()
+            assert after["binary_hits"] == before["binary_hits"] + 1
+            assert after["source_hashes"] == before["source_hashes"]
+
+            lut_path.write_text(identity_lut(invert_r=True))
+            changed = cpp_lut.load_lut(str(lut_path))
+            assert not changed.mapped
+            assert not np.array_equal(cpp_lut.apply_lut(changed, image),
+                                      cpp_lut.apply_lut(parsed, image))
+
+            # 移出缓存后已取得的 Lut 对象仍可使用，再次加载重新进入缓存
+            assert cpp_lut.evict_lut(str(lut_path))
+            assert not cpp_lut.evict_lut(str(lut_path))
+            assert np.array_equal(cpp_lut.apply_lut(changed, image),
+                                  cpp_lut.apply_lut(cpp_lut.load_lut(str(lut_path)), image))
+            assert cpp_lut.evict_lut(str(lut_path))
+        finally:
+            cpp_lut.set_lut_binary_cache_dir("")
+
+    def test_cpp_lut_preview_session_strength(self, cpp_lut):
+        """测试预览会话：强度 1 与完整预览一致，强度 0 为缩放后的原图，可复用输出缓冲"""
+        lut = identity_lut(invert_r=True)
+        identity = identity_lut()
+        image = np.random.default_rng(7).integers(0, 256, size=(60, 80, 3), dtype=np.uint8)
+        session = cpp_lut.create_preview_session(lut, image, 40, 30)
+
+        graded = cpp_lut.generate_preview_pixels(lut, image, 40, 30)
+        original = cpp_lut.generate_preview_pixels(identity, image, 40, 30)
+        assert np.array_equal(session.render(1.0), graded)
+        assert np.array_equal(session.render(0.0), original)
+
+        out = np.empty((30, 40, 3), dtype=np.uint8)
+        half = session.render(0.5, out=out)
+        assert half is out or np.shares_memory(half, out)
+        expected = (original.astype(int) * 128 + graded.astype(int) * 128 + 128) >> 8
+        assert np.array_equal(out, expected)
+
+        session.set_lut(identity)
+        assert np.array_equal(session.render(1.0, "rgba")[..., :3], original)
+        with pytest.raises(RuntimeError):
+            session.render(1.0, out=np.empty((30, 40, 4), dtype=np.uint8))
+
+    def test_cpp_lut_preview_mips(self, cpp_lut):
+        """测试多尺寸预览：最大尺寸与单独生成一致，较小尺寸由其缩小得到"""
+        lut = identity_lut(invert_r=True)
+        image = np.tile(np.arange(96, dtype=np.uint8)[None, :, None] * 2, (96, 1, 3))
+        levels = cpp_lut.generate_preview_mips(lut, image, [(16, 16), (48, 48), (32, 32)])
+
+        assert [level.shape for level in levels] == [(16, 16, 3), (48, 48, 3), (32, 32, 3)]
+        assert np.array_equal(levels[1], cpp_lut.generate_preview_pixels(lut, image, 48, 48))
+        direct = cpp_lut.generate_preview_pixels(lut, image, 16, 16)
+        assert np.abs(levels[0].astype(int) - direct.astype(int)).max() <= 8
+        with pytest.raises(RuntimeError):
+            cpp_lut.generate_preview_mips(lut, image, [])
+
+    def test_cpp_lut_preview_submit_preview(self, cpp_lut):
+        """测试异步预览：结果与同步生成一致，取消后的任务抛出异常"""
+        lut = identity_lut(invert_r=True)
+        image = np.tile(np.arange(96, dtype=np.uint8)[None, :, None] * 2, (96, 1, 3))
+        # 排在大量可见任务之后的预取任务在开始前即被取消
+        tasks = [
+            cpp_lut.submit_preview(lut, image, 512, 512, priority=cpp_lut.PRIORITY_VISIBLE)
+            for _ in range(8)
+        ]
+        cancelled = cpp_lut.submit_preview(lut, image, 512, 512)
+        cancelled.cancel()
+
+        expected = cpp_lut.generate_preview_pixels(lut, image, 512, 512)
+        for task in tasks:
+            assert np.array_equal(task.result(), expected)
+            assert task.done() and task.state == "done"
+        with pytest.raises(RuntimeError):
+            cancelled.result()
+        assert cancelled.state == "cancelled"
+
+    def test_cpp_lut_preview_preview_cache(self, cpp_lut, tmp_path):
+        """测试预览缓存：内存与磁盘命中结果一致，任一输入变化即失效"""
+        lut = identity_lut(invert_r=True)
+        image = np.tile(np.arange(96, dtype=np.uint8)[None, :, None] * 2, (96, 1, 3))
+        expected = cpp_lut.generate_preview_pixels(lut, image, 40, 30)
+
+        cpp_lut.set_preview_cache_dir(str(tmp_path))
+        try:
+            cpp_lut.clear_preview_cache(disk=True)
+            assert cpp_lut.lookup_preview(lut, image, 40, 30) is None
+            assert np.array_equal(cpp_lut.generate_preview_cached(lut, image, 40, 30), expected)
+            assert np.array_equal(cpp_lut.lookup_preview(lut, image, 40, 30), expected)
+            assert len(list(tmp_path.glob("*.fafp"))) == 1
+
+            # 内存层清空后由磁盘层命中
+            cpp_lut.clear_preview_cache()
+            disk_hits = cpp_lut.get_preview_cache_info()["disk_hits"]
+            assert np.array_equal(cpp_lut.lookup_preview(lut, image, 40, 30), expected)
+            assert cpp_lut.get_preview_cache_info()["disk_hits"] == disk_hits + 1
+
+            # 尺寸、插值方式或参考图像变化都不会命中旧条目
+            assert cpp_lut.lookup_preview(lut, image, 30, 40) is None
+            assert cpp_lut.lookup_preview(lut, image, 40, 30, interpolation="tetrahedral") is None
+            changed = image.copy()
+            changed[0, 0, 0] ^= 1
+            assert cpp_lut.lookup_preview(lut, changed, 40, 30) is None
+
+            batch = cpp_lut.generate_previews_batch([lut, lut], changed, 40, 30, use_cache=True)
+            assert np.array_equal(batch[0], cpp_lut.lookup_preview(lut, changed, 40, 30))
+
+            # 预先算好的参考图像键与现算的键命中同一条目；解析与加载得到的同一 LUT 键相同
+            key = cpp_lut.image_content_key(image)
+            assert key == cpp_lut.image_content_key(image.copy())
+            assert key != cpp_lut.image_content_key(changed)
+            assert np.array_equal(cpp_lut.lookup_preview(lut, image, 40, 30, image_key=key), expected)
+            lut_path = tmp_path / "invert.cube"
+            lut_path.write_text(lut)
+            assert np.array_equal(cpp_lut.lookup_preview(cpp_lut.load_lut(str(lut_path)), image, 40, 30,
+                                                         image_key=key), expected)
+
+            cpp_lut.clear_preview_cache(disk=True)
+            assert not list(tmp_path.glob("*.fafp"))
+            assert cpp_lut.lookup_preview(lut, image, 40, 30) is None
+
+            # 磁盘层超出上限后删到上限的 3/4 以内
+            for width in range(40, 44):
+                cpp_lut.generate_preview_cached(lut, image, width, 30)
+            sizes = [path.stat().st_size for path in tmp_path.glob("*.fafp")]
+            assert len(sizes) == 4
+            limit = sum(sizes) - 1
+            cpp_lut.set_preview_cache_disk_limit(limit)
+            info = cpp_lut.get_preview_cache_info()
+            assert info["disk_bytes"] <= limit * 3 // 4
+            assert len(list(tmp_path.glob("*.fafp"))) < 4
+        finally:
+            cpp_lut.set_preview_cache_disk_limit(256 * 1024 * 1024)
+            cpp_lut.set_preview_cache_dir("")
+
+    def test_cpp_lut_preview_cache_disk_footprint(self, cpp_lut, tmp_path):
+        """测试磁盘层条目经过压缩：默认上限容纳一千张 256×256 的预览卡片，且从磁盘读回的像素无损"""
+        rng = np.random.default_rng(11)
+        y, x = np.mgrid[0:256, 0:256]
+        cpp_lut.set_preview_cache_dir(str(tmp_path))
+        try:
+            cpp_lut.clear_preview_cache(disk=True)
+            disk_limit = cpp_lut.get_preview_cache_info()["disk_limit"]
+            for index in range(4):
+                # 平滑渐变叠加少量噪声，近似照片类参考图像
+                base = 128 + 90 * np.sin(x * (index + 1) / 60.0) * np.cos(y / 45.0)
+                noise = rng.integers(-3, 4, size=(256, 256, 3))
+                image = np.clip(base[..., None] + noise, 0, 255).astype(np.uint8)
+                expected = cpp_lut.generate_preview_cached(identity_lut(invert_r=True), image, 256, 256)
+
+                cpp_lut.clear_preview_cache()
+                assert np.array_equal(cpp_lut.lookup_preview(identity_lut(invert_r=True), image, 256, 256),
+                                      expected)
+
+            sizes = [path.stat().st_size for path in tmp_path.glob("*.fafp")]
+            assert len(sizes) == 4
+            assert max(sizes) < 256 * 256 * 3 * 3 // 4
+            assert 1000 * max(sizes) <= disk_limit
+            # 不可压缩时的最坏情况（RGBA 原始像素）也放得下一千张
+            assert 1000 * 256 * 256 * 4 <= disk_limit
+        finally:
+            cpp_lut.set_preview_cache_dir("")
+
+    def test_cpp_lut_preview_atlas(self, cpp_lut):
+        """测试预览图集：各格子与单独生成一致，失败条目的格子留空"""
+        lut = identity_lut(invert_r=True)
+        image = np.tile(np.arange(96, dtype=np.uint8)[None, :, None] * 2, (96, 1, 3))
+        atlas, rects = cpp_lut.generate_preview_atlas(
+            [lut, "not a lut", lut], image, 20, 10, columns=2, spacing=2, pixel_format="rgba"
+        )
+
+        assert atlas.shape == (22, 42, 4)
+        assert rects == [(0, 0, 20, 10), None, (0, 12, 20, 10)]
+        expected = cpp_lut.generate_preview_pixels(lut, image, 20, 10, pixel_format="rgba")
+        for x, y, w, h in (rect for rect in rects if rect):
+            assert np.array_equal(atlas[y:y + h, x:x + w], expected)
+        assert not atlas[0:10, 22:42].any()
+        with pytest.raises(RuntimeError):
+            cpp_lut.generate_preview_atlas([], image, 20, 10)
+
+    def test_cpp_lut_preview_progressive(self, cpp_lut):
+        """测试渐进式预览：先得到 1/4 分辨率草稿，正式结果与同步生成一致"""
+        lut = identity_lut(invert_r=True)
+        image = np.tile(np.arange(96, dtype=np.uint8)[None, :, None] * 2, (96, 1, 3))
+        task = cpp_lut.submit_preview(lut, image, 256, 128, progressive=True)
+
+        first = task.result(draft=True)
+        assert task.draft_ready()
+        if not task.done():
+            assert first.shape == (32, 64, 3)
+        final = task.result()
+        assert np.array_equal(final, cpp_lut.generate_preview_pixels(lut, image, 256, 128))
+        assert np.array_equal(task.result(draft=True), final)
+
+    def test_cpp_lut_preview_scopes(self, cpp_lut):
+        """测试示波器：统计总数与像素数一致，反相 LUT 翻转红色直方图，重复调用不会累加上一次的计数"""
+        lut = identity_lut(invert_r=True)
+        rng = np.random.default_rng(0)
+        image = rng.integers(0, 256, size=(90, 120, 3), dtype=np.uint8)
+        pixels, scopes = cpp_lut.generate_preview_scopes(lut, image, 60, 45, scope_width=30,
+                                                         vectorscope_size=33)
+        assert np.array_equal(pixels, cpp_lut.generate_preview_pixels(lut, image, 60, 45))
+
+        graded = scopes["graded"]
+        assert graded["histogram"].shape == (4, 256)
+        assert graded["waveform"].shape == (256, 30)
+        assert graded["parade"].shape == (3, 256, 30)
+        assert graded["vectorscope"].shape == (33, 33)
+        assert (graded["histogram"].sum(axis=1) == 60 * 45).all()
+        assert graded["waveform"].sum() == graded["vectorscope"].sum() == 60 * 45
+        assert np.array_equal(graded["histogram"][0], np.bincount(pixels[..., 0].ravel(), minlength=256))
+        # 反相 LUT 把红色直方图左右翻转
+        assert np.array_equal(graded["histogram"][0], scopes["source"]["histogram"][0][::-1])
+
+        # 各线程的局部计数在调用间复用暂存区，每次都从零开始
+        _, again = cpp_lut.generate_preview_scopes(lut, image, 60, 45, scope_width=30, vectorscope_size=33)
+        for name in ("source", "graded"):
+            for key, counts in scopes[name].items():
+                assert np.array_equal(again[name][key], counts)
+
+        # 中灰经过反相 LUT 仍接近中灰：矢量图只落在中心，波形第 0 行对应最高电平
+        gray = np.full((16, 16, 3), 128, dtype=np.uint8)
+        _, scopes = cpp_lut.generate_preview_scopes(lut, gray, 16, 16, scope_width=16,
+                                                    vectorscope_size=33)
+        for name in ("source", "graded"):
+            assert scopes[name]["vectorscope"][16, 16] == 16 * 16
+            assert (scopes[name]["waveform"][255 - 128] == 16).all()
 
 
 class TestCppExtensionIntegration: